@@ -5,9 +5,12 @@
  * 1. LRU (Least Recently Used) 缓存
  * 2. LFU (Least Frequently Used) 缓存
  * 3. 带过期的缓存
- * 4. 多级缓存
+ * 4. 多级缓存（并发未命中合并加载，写穿 / 写回）
+ * 5. 缓存统计
  *
- * 编译：g++ -std=c++11 09_practical_cache_implementation.cpp -o cache_impl
+ * 缓存类的实现位于 cache/ 目录下的头文件中，本文件是演示程序。
+ *
+ * 编译：g++ -std=c++11 -pthread 09_practical_cache_implementation.cpp -o cache_impl
  */
 
 #include <iostream>
@@ -20,6 +23,16 @@
 #include <algorithm>
 #include <functional>
 #include <iomanip>
+#include <cstdio>
+#include <vector>
+#include <future>
+#include <random>
+
+#include "cache/lru_cache.h"
+#include "cache/lfu_cache.h"
+#include "cache/mmap_cache.h"
+#include "cache/multi_level_cache.h"
+#include "cache/ttl_cache.h"
 
 using namespace std;
 using namespace std::chrono;
@@ -33,85 +46,15 @@ using namespace std::chrono;
  * - 使用 list 维护访问顺序 + unordered_map 快速查找
  */
 
-template<typename Key, typename Value>
-class LRUCache {
-private:
-    size_t capacity;
-    list<pair<Key, Value>> itemList;  // 维护访问顺序
-    unordered_map<Key, typename list<pair<Key, Value>>::iterator> itemMap;  // Key -> 迭代器
-
-public:
-    LRUCache(size_t cap) : capacity(cap) {}
-
-    // 获取值，不存在返回默认值
-    Value get(const Key& key, const Value& defaultValue = Value()) {
-        auto it = itemMap.find(key);
-        if (it == itemMap.end()) {
-            return defaultValue;  // 未找到
-        }
-
-        // 找到了，移到链表头部（表示最近使用）
-        itemList.splice(itemList.begin(), itemList, it->second);
-        return it->second->second;
-    }
-
-    // 设置值
-    void put(const Key& key, const Value& value) {
-        auto it = itemMap.find(key);
-        if (it != itemMap.end()) {
-            // 键已存在，更新值并移到头部
-            it->second->second = value;
-            itemList.splice(itemList.begin(), itemList, it->second);
-            return;
-        }
-
-        // 检查容量
-        if (itemList.size() >= capacity) {
-            // 淘汰最久未使用的（链表尾部）
-            auto last = itemList.back();
-            itemMap.erase(last.first);
-            itemList.pop_back();
-        }
-
-        // 添加新项到头部
-        itemList.emplace_front(key, value);
-        itemMap[key] = itemList.begin();
-    }
-
-    // 检查键是否存在
-    bool contains(const Key& key) const {
-        return itemMap.find(key) != itemMap.end();
-    }
-
-    // 删除键
-    void remove(const Key& key) {
-        auto it = itemMap.find(key);
-        if (it != itemMap.end()) {
-            itemList.erase(it->second);
-            itemMap.erase(it);
-        }
-    }
-
-    // 清空缓存
-    void clear() {
-        itemList.clear();
-        itemMap.clear();
-    }
+// 实现见 cache/lru_cache.h（多线程版本见 cache/sharded_lru_cache.h，
+// 连续数组 + 开放寻址的版本见 cache/flat_lru_cache.h）
 
-    // 获取当前大小
-    size_t size() const {
-        return itemList.size();
-    }
-
-    // 打印缓存内容
-    void print() const {
-        cout << "LRU Cache (容量: " << capacity << ", 大小: " << size() << ")" << endl;
-        cout << "  [头部 -> 尾部]:" << endl;
-        for (const auto& item : itemList) {
-            cout << "    " << item.first << " => " << item.second << endl;
-        }
-    }
-};
+/*
+ * 按字节限制容量：
+ * - 值的大小差别很大时，按项数限制容量要么远超内存预算，要么浪费大部分预算
+ * - LRU / LFU / TTL 缓存都可以传入权重函数（cache/weigher.h），容量变为总权重上限
+ * - 插入时计算一次权重，总权重增量维护，放不下就继续淘汰
+ */
 
 // ==================== 2. LFU (Least Frequently Used) 缓存 ====================
 
@@ -119,233 +62,50 @@ public:
  * LFU 原理：
  * - 跟踪每个项的访问频率
  * - 容量满时，淘汰访问频率最低的项
- * - 频率相同时，淘汰最早的
+ * - 频率相同时，淘汰最久未访问的
+ * - 频率桶链表实现，get / put 都是 O(1)，可选频率老化
  */
 
-template<typename Key, typename Value>
-class LFUCache {
-private:
-    struct CacheItem {
-        Value value;
-        size_t frequency;
-        time_point<steady_clock> lastAccess;
-
-        bool operator<(const CacheItem& other) const {
-            if (frequency != other.frequency) {
-                return frequency < other.frequency;  // 频率低的优先
-            }
-            return lastAccess < other.lastAccess;  // 频率相同时，时间早的优先
-        }
-    };
-
-    size_t capacity;
-    unordered_map<Key, CacheItem> cache;
-
-public:
-    LFUCache(size_t cap) : capacity(cap) {}
-
-    Value get(const Key& key, const Value& defaultValue = Value()) {
-        auto it = cache.find(key);
-        if (it == cache.end()) {
-            return defaultValue;
-        }
-
-        // 更新频率和访问时间
-        it->second.frequency++;
-        it->second.lastAccess = steady_clock::now();
-        return it->second.value;
-    }
-
-    void put(const Key& key, const Value& value) {
-        auto it = cache.find(key);
-        if (it != cache.end()) {
-            it->second.value = value;
-            it->second.frequency++;
-            it->second.lastAccess = steady_clock::now();
-            return;
-        }
-
-        if (cache.size() >= capacity) {
-            // 找到频率最低的项
-            auto minIt = min_element(cache.begin(), cache.end(),
-                [](const pair<Key, CacheItem>& a, const pair<Key, CacheItem>& b) {
-                    if (a.second.frequency != b.second.frequency) {
-                        return a.second.frequency < b.second.frequency;
-                    }
-                    return a.second.lastAccess < b.second.lastAccess;
-                });
-            cache.erase(minIt);
-        }
-
-        cache[key] = {value, 1, steady_clock::now()};
-    }
-
-    bool contains(const Key& key) const {
-        return cache.find(key) != cache.end();
-    }
-
-    size_t size() const {
-        return cache.size();
-    }
-
-    void print() const {
-        cout << "LFU Cache (容量: " << capacity << ", 大小: " << size() << ")" << endl;
-        multimap<size_t, pair<Key, Value>> sorted;
-        for (const auto& p : cache) {
-            sorted.insert({p.second.frequency, {p.first, p.second.value}});
-        }
-
-        cout << "  [频率低 -> 高]:" << endl;
-        for (const auto& p : sorted) {
-            cout << "    " << p.second.first << " => " << p.second.second
-                 << " (频率: " << p.first << ")" << endl;
-        }
-    }
-};
+// 实现见 cache/lfu_cache.h
 
 // ==================== 3. 带过期的缓存 ====================
 
-template<typename Key, typename Value>
-class TTLCache {
-private:
-    struct CacheItem {
-        Value value;
-        time_point<steady_clock> expireTime;
-
-        bool isExpired() const {
-            return steady_clock::now() > expireTime;
-        }
-    };
-
-    unordered_map<Key, CacheItem> cache;
-    milliseconds defaultTTL;
-
-    void cleanExpired() {
-        for (auto it = cache.begin(); it != cache.end();) {
-            if (it->second.isExpired()) {
-                it = cache.erase(it);
-            } else {
-                ++it;
-            }
-        }
-    }
-
-public:
-    TTLCache(milliseconds ttl = milliseconds(5000))
-        : defaultTTL(ttl) {}
-
-    void put(const Key& key, const Value& value, milliseconds ttl = milliseconds(0)) {
-        if (ttl == milliseconds(0)) {
-            ttl = defaultTTL;
-        }
-        cache[key] = {value, steady_clock::now() + ttl};
-    }
-
-    Value get(const Key& key, const Value& defaultValue = Value()) {
-        cleanExpired();  // 清理过期项
-
-        auto it = cache.find(key);
-        if (it == cache.end() || it->second.isExpired()) {
-            return defaultValue;
-        }
-        return it->second.value;
-    }
-
-    bool contains(const Key& key) {
-        cleanExpired();
-        auto it = cache.find(key);
-        return it != cache.end() && !it->second.isExpired();
-    }
-
-    void remove(const Key& key) {
-        cache.erase(key);
-    }
-
-    void clear() {
-        cache.clear();
-    }
+/*
+ * TTL 原理：
+ * - 每个项记录过期时间，过期后视为不存在
+ * - 最小堆按过期时间索引，每次操作从堆顶增量清理少量过期项，查找时惰性检查
+ * - 可选的后台线程定期清理
+ */
 
-    size_t size() const {
-        return cache.size();
-    }
-
-    void print() const {
-        cout << "TTL Cache (大小: " << size() << ")" << endl;
-        auto now = steady_clock::now();
-        for (const auto& p : cache) {
-            auto remaining = duration_cast<milliseconds>(
-                p.second.expireTime - now).count();
-            cout << "    " << p.first << " => " << p.second.value
-                 << " (剩余: " << remaining << "ms)" << endl;
-        }
-    }
-};
+// 实现见 cache/ttl_cache.h
 
 // ==================== 4. 多级缓存 ====================
 
-template<typename Key, typename Value>
-class MultiLevelCache {
-private:
-    LRUCache<Key, Value> l1Cache;  // 一级缓存（小而快）
-    LRUCache<Key, Value> l2Cache;  // 二级缓存（大而慢）
-    function<Value(const Key&)> loader;  // 数据加载函数
-
-    size_t l1Hits = 0;
-    size_t l2Hits = 0;
-    size_t misses = 0;
-
-public:
-    MultiLevelCache(size_t l1Size, size_t l2Size,
-                   function<Value(const Key&)> loadFunc)
-        : l1Cache(l1Size), l2Cache(l2Size), loader(loadFunc) {}
-
-    Value get(const Key& key) {
-        // 先查 L1
-        if (l1Cache.contains(key)) {
-            l1Hits++;
-            return l1Cache.get(key);
-        }
-
-        // 再查 L2
-        if (l2Cache.contains(key)) {
-            l2Hits++;
-            Value value = l2Cache.get(key);
-            l1Cache.put(key, value);  // 提升到 L1
-            return value;
-        }
+/*
+ * 多级缓存原理：
+ * - L1 小而快，L2 大而慢，都未命中才调用 loader 访问数据源
+ * - L2 命中的项提升到 L1
+ * - 同一个键的并发未命中只触发一次加载（single-flight），其余线程等待同一个结果
+ * - 加载在固定数量的加载线程中执行，限制对数据源的并发请求数；getAsync 返回 future
+ * - L2 可以换成内存映射文件上的 MmapCache，重启后 L2 中的数据仍在
+ * - getPinned 返回固定住 L1 项的 Handle，读取大值时不拷贝，持有期间该项不会被淘汰
+ * - 写穿：put 先同步写数据源再更新缓存；写回：put 只记入写缓冲，同一个键的多次写入合并，
+ *   后台按批量大小或时间间隔成批写出，数据源的写入次数远少于 put 次数
+ */
 
-        // 都没有，加载
-        misses++;
-        Value value = loader(key);
-        l2Cache.put(key, value);
-        l1Cache.put(key, value);
-        return value;
-    }
+// 实现见 cache/multi_level_cache.h
 
-    void put(const Key& key, const Value& value) {
-        l1Cache.put(key, value);
-        l2Cache.put(key, value);
-    }
+// ==================== 5. 缓存统计 ====================
 
-    void printStats() const {
-        size_t total = l1Hits + l2Hits + misses;
-        if (total == 0) {
-            cout << "没有访问记录" << endl;
-            return;
-        }
+/*
+ * 所有缓存都有 stats()，返回一份快照：
+ * - 命中、未命中、插入、淘汰、过期的次数，以及项数、总权重和估计的内存
+ * - setLatencySampling(n) 后每 n 次操作计时一次，得到读写延迟的分布（p50 / p99）
+ * - 计数器按线程分条，多线程同时更新时互不争用，读取时汇总
+ * 调容量时看命中率和淘汰次数：容量翻倍后命中率明显上升，说明原来的容量偏小
+ */
 
-        cout << "\n=== 缓存统计 ===" << endl;
-        cout << "总访问: " << total << endl;
-        cout << "L1 命中: " << l1Hits << " ("
-             << fixed << setprecision(1) << (100.0 * l1Hits / total) << "%)" << endl;
-        cout << "L2 命中: " << l2Hits << " ("
-             << (100.0 * l2Hits / total) << "%)" << endl;
-        cout << "未命中: " << misses << " ("
-             << (100.0 * misses / total) << "%)" << endl;
-        cout << "命中率: "
-             << (100.0 * (l1Hits + l2Hits) / total) << "%" << endl;
-    }
-};
+// 实现见 cache/cache_metrics.h
 
 // ==================== 主函数和测试 ====================
 
@@ -386,6 +146,24 @@ void demoLRU() {
     cout << "\nkey=2 是否存在: " << (cache.contains(2) ? "是" : "否") << endl;
 }
 
+void demoWeightedLRU() {
+    cout << "\n### 按字节限制容量的 LRU 测试 ###" << endl;
+
+    // 每项按值的长度计权重，总共 100 字节
+    LRUCache<int, string> cache(100, [](const int&, const string& v) { return v.size(); });
+
+    cache.put(1, string(40, 'a'));
+    cache.put(2, string(40, 'b'));
+    cout << "放入两个 40 字节的值，项数: " << cache.size() << "，权重: " << cache.weight() << endl;
+
+    cache.put(3, string(60, 'c'));
+    cout << "放入 60 字节的值 (淘汰 key=1)，项数: " << cache.size() << "，权重: " << cache.weight() << endl;
+
+    cache.put(4, string(150, 'd'));
+    cout << "放入 150 字节的值 (超过容量，不缓存)，key=4 是否存在: "
+         << (cache.contains(4) ? "是" : "否") << endl;
+}
+
 void demoLFU() {
     cout << "\n### LFU 缓存测试 ###" << endl;
 
@@ -430,6 +208,30 @@ void demoTTL() {
     cout << "cache.get('b'): " << cache.get("b", -1) << " (应该返回 -1)" << endl;
 }
 
+void demoStats() {
+    cout << "\n### 缓存统计测试 ###" << endl;
+
+    // 100 个键，小的键访问得多；比较两种容量下的命中率
+    mt19937 rng(7);
+    vector<int> keys(10000);
+    for (auto& k : keys) {
+        k = (int)min(rng() % 100, rng() % 100);
+    }
+
+    for (size_t cap : {10, 40}) {
+        LRUCache<int, int> cache(cap);
+        cache.setLatencySampling(16);
+        for (int k : keys) {
+            int v;
+            if (!cache.tryGet(k, v)) {
+                cache.put(k, k * k);
+            }
+        }
+        string name = "LRU 容量 " + to_string(cap);
+        cache.stats().print(name.c_str());
+    }
+}
+
 void demoMultiLevel() {
     cout << "\n### 多级缓存测试 ###" << endl;
 
@@ -449,6 +251,96 @@ void demoMultiLevel() {
     mlCache.printStats();
 }
 
+void demoSingleFlight() {
+    cout << "\n### 并发未命中合并测试 ###" << endl;
+
+    // 慢查询：每次 50ms
+    auto slowQuery = [](int key) {
+        this_thread::sleep_for(milliseconds(50));
+        return databaseQuery(key);
+    };
+    MultiLevelCache<int, string> mlCache(2, 4, slowQuery, 2);
+
+    cout << "\n8 个线程同时读取冷数据 key=5:" << endl;
+    vector<thread> threads;
+    for (int i = 0; i < 8; ++i) {
+        threads.emplace_back([&mlCache] { mlCache.get(5); });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    cout << "loader 调用次数: " << mlCache.loaderCalls() << " (应该是 1)" << endl;
+
+    cout << "\n异步读取 key=6、7、8 (加载线程数为 2):" << endl;
+    auto start = steady_clock::now();
+    vector<shared_future<string>> futures;
+    for (int key = 6; key <= 8; ++key) {
+        futures.push_back(mlCache.getAsync(key));
+    }
+    vector<string> values;
+    for (auto& f : futures) {
+        values.push_back(f.get());
+    }
+    auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    for (const auto& v : values) {
+        cout << v << " ";
+    }
+    cout << "\n耗时: " << ms << "ms (两批加载，约 100ms)" << endl;
+
+    mlCache.printStats();
+}
+
+void demoPersistentL2() {
+    cout << "\n### 持久化 L2 测试 ###" << endl;
+    const char* path = "multi_level_l2.dat";
+    typedef MultiLevelCache<int, string, MmapCache<int, string>> PersistentCache;
+
+    {
+        PersistentCache mlCache(2, MmapCache<int, string>(path, 100, 1 << 16), databaseQuery);
+        cout << "\n第一次运行，读取 key=1、2、3:" << endl;
+        for (int key = 1; key <= 3; ++key) {
+            cout << "key=" << key << ": " << mlCache.get(key) << endl;
+        }
+    }
+
+    {
+        PersistentCache mlCache(2, MmapCache<int, string>(path, 100, 1 << 16), databaseQuery);
+        cout << "\n重启后再次读取 (L2 命中，不查数据库):" << endl;
+        for (int key = 1; key <= 3; ++key) {
+            cout << "key=" << key << ": " << mlCache.get(key) << endl;
+        }
+        mlCache.printStats();
+    }
+    remove(path);
+}
+
+void demoWriteBehind() {
+    cout << "\n### 写回测试 ###" << endl;
+
+    MultiLevelCache<int, string> mlCache(2, 4, databaseQuery);
+    mlCache.enableWriteBehind([](const vector<pair<int, string>>& batch) {
+        cout << "写入数据库 " << batch.size() << " 项:";
+        for (const auto& kv : batch) {
+            cout << " " << kv.first << "=" << kv.second;
+        }
+        cout << endl;
+    }, 4, milliseconds(50));
+
+    cout << "\nkey=1 连续写 100 次，key=2、3 各写一次:" << endl;
+    for (int i = 0; i < 100; ++i) {
+        mlCache.put(1, "v" + to_string(i));
+    }
+    mlCache.put(2, "a");
+    mlCache.put(3, "b");
+    cout << "待写回: " << mlCache.pendingWrites() << " 项 (同一个键的写入已合并)" << endl;
+    cout << "key=1: " << mlCache.get(1) << endl;
+
+    mlCache.flush();
+    cout << "flush 后待写回: " << mlCache.pendingWrites() << " 项" << endl;
+
+    mlCache.printStats();
+}
+
 // ==================== 实际应用：斐波那契缓存 ====================
 
 int fibonacci(int n) {
@@ -503,9 +395,14 @@ int main() {
     cout << "=== STL 缓存实现示例 ===" << endl;
 
     demoLRU();
+    demoWeightedLRU();
     demoLFU();
     demoTTL();
+    demoStats();
     demoMultiLevel();
+    demoSingleFlight();
+    demoPersistentL2();
+    demoWriteBehind();
     demoFibonacciCache();
 
     cout << "\n=== 缓存策略总结 ===" << endl;
@@ -518,23 +415,40 @@ int main() {
 2. LFU (Least Frequently Used):
    - 淘汰访问频率最低的项
    - 适合有明显热点数据的场景
-   - 实现：unordered_map + 频率计数
+   - 实现：unordered_map + 按频率分桶的链表，O(1) 淘汰
 
 3. TTL (Time To Live):
    - 基于时间的淘汰策略
    - 适合需要定期刷新的数据
-   - 实现：记录过期时间，定期清理
+   - 实现：记录过期时间 + 按过期时间排序的最小堆，增量清理
 
 4. 多级缓存:
    - L1: 小而快（内存）
    - L2: 大而慢（磁盘/网络）
    - 适合读多写少的场景
+   - 并发未命中合并为一次加载，防止冷启动击穿数据源
+   - L2 放在内存映射文件中，重启后不必全部重新加载
+   - 写穿保证数据源与缓存一致；写回合并同一个键的写入，成批写出，降低数据源的写压力
+
+5. 策略化缓存 (cache/policy_cache.h):
+   - 存储核心 + 编译期选择的淘汰策略
+   - CLOCK / SIEVE：命中只置访问位，不调整链表
+   - S3-FIFO / ARC：抗扫描，混有顺序扫描时命中率高于 LRU
+
+6. W-TinyLFU 准入 (cache/tinylfu_cache.h):
+   - 频率草图估计访问次数，新键频率不高于淘汰对象就不进入主缓存
+   - 可以套在任意主缓存策略外面
+
+容量可以按项数，也可以传入权重函数按字节数计 (cache/weigher.h)
+每个缓存都可以用 stats() 查看命中率、淘汰次数和估计内存 (cache/cache_metrics.h)
 
 选择建议：
 - 一般场景：LRU
 - 热点数据明显：LFU
 - 需要定时刷新：TTL
 - 大规模数据：多级缓存
+- 读多、有扫描：SIEVE / S3-FIFO / ARC
+- 一次性访问多、怕污染：W-TinyLFU
 )" << endl;
 
     return 0;
@@ -0,0 +1,379 @@
+/**
+ * 序列容器性能实测
+ *
+ * 01_sequence_containers.cpp 中的容器选择建议来自复杂度分析，本程序在本机上实际测量：
+ * 1. 头部插入 / 尾部插入构建
+ * 2. 随机下标访问
+ * 3. 中间位置插入 + 删除
+ * 4. 全量遍历
+ * 5. 拷贝
+ *
+ * 参测容器：vector、deque、list、forward_list 以及 data_structure/linked_list.h 中的 link_list。
+ * 规模从 1e3 到 1e7，每项输出 ns/op；Linux 上可用 perf_event 时同时输出每次操作的缓存未命中数。
+ * O(n) 的操作（链表按下标访问、vector 中间插入等）在大规模下只执行少量次数，结果仍按单次操作折算。
+ *
+ * 编译：g++ -std=c++11 -O2 11_sequence_benchmark.cpp -o sequence_benchmark
+ * 运行：./sequence_benchmark [最大规模，默认 10000000]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <forward_list>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "../data_structure/linked_list.h"
+
+using namespace std;
+
+// ==================== 1. 计时与缓存未命中计数 ====================
+
+/*
+ * 通过 perf_event_open 读取硬件事件 PERF_COUNT_HW_CACHE_MISSES（最后一级缓存未命中）。
+ * 虚拟机、容器或 perf_event_paranoid 限制下可能打不开，此时只输出耗时。
+ */
+class CacheMissCounter {
+public:
+    CacheMissCounter() : fd(-1) {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool available() const { return fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    long long stop() {
+        long long count = 0;
+#ifdef __linux__
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != (ssize_t)sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+
+private:
+    int fd;
+};
+
+CacheMissCounter g_counter;
+
+struct Measurement {
+    bool valid;
+    double nsPerOp;
+    double missesPerOp;
+};
+
+Measurement skipped() {
+    Measurement m = {false, 0, 0};
+    return m;
+}
+
+// 执行 f，按 ops 次操作折算
+template <typename Func>
+Measurement measure(long long ops, Func f) {
+    typedef chrono::steady_clock Clock;
+    g_counter.start();
+    Clock::time_point t0 = Clock::now();
+    f();
+    Clock::time_point t1 = Clock::now();
+    long long misses = g_counter.stop();
+
+    Measurement m;
+    m.valid = true;
+    m.nsPerOp = chrono::duration<double, nano>(t1 - t0).count() / ops;
+    m.missesPerOp = (double)misses / ops;
+    return m;
+}
+
+// 防止编译器把只读的遍历优化掉
+volatile long long g_sink = 0;
+
+// ==================== 2. 各容器的操作 ====================
+
+/*
+ * 每个容器一个操作集，接口统一：
+ *   buildBack / buildFront   从空容器构建 n 个元素
+ *   at(c, i)                 第 i 个元素（0 起）
+ *   insertEraseMiddle(c)     在中间插入一个元素再删除一个元素
+ *   sum(c)                   遍历求和
+ *   linearIndex              按下标访问是否 O(n)
+ *   cheapFront               头部插入是否 O(1)
+ */
+
+struct VectorOps {
+    typedef vector<int> Container;
+    static const char* name() { return "vector"; }
+    static const bool linearIndex = false;
+    static const bool cheapFront = false;
+
+    static void buildBack(Container& c, int n) { for (int i = 0; i < n; ++i) c.push_back(i); }
+    static void buildFront(Container& c, int n) { for (int i = 0; i < n; ++i) c.insert(c.begin(), i); }
+    static int at(const Container& c, int i) { return c[i]; }
+    static void insertEraseMiddle(Container& c) {
+        c.insert(c.begin() + c.size() / 2, -1);
+        c.erase(c.begin() + c.size() / 2);
+    }
+    static long long sum(const Container& c) {
+        long long s = 0;
+        for (int x : c) s += x;
+        return s;
+    }
+};
+
+struct DequeOps {
+    typedef deque<int> Container;
+    static const char* name() { return "deque"; }
+    static const bool linearIndex = false;
+    static const bool cheapFront = true;
+
+    static void buildBack(Container& c, int n) { for (int i = 0; i < n; ++i) c.push_back(i); }
+    static void buildFront(Container& c, int n) { for (int i = 0; i < n; ++i) c.push_front(i); }
+    static int at(const Container& c, int i) { return c[i]; }
+    static void insertEraseMiddle(Container& c) {
+        c.insert(c.begin() + c.size() / 2, -1);
+        c.erase(c.begin() + c.size() / 2);
+    }
+    static long long sum(const Container& c) {
+        long long s = 0;
+        for (int x : c) s += x;
+        return s;
+    }
+};
+
+struct ListOps {
+    typedef list<int> Container;
+    static const char* name() { return "list"; }
+    static const bool linearIndex = true;
+    static const bool cheapFront = true;
+
+    static void buildBack(Container& c, int n) { for (int i = 0; i < n; ++i) c.push_back(i); }
+    static void buildFront(Container& c, int n) { for (int i = 0; i < n; ++i) c.push_front(i); }
+    static int at(const Container& c, int i) { return *next(c.begin(), i); }
+    // 按下标定位中间位置需要从头走 n/2 步，插入删除本身 O(1)
+    static void insertEraseMiddle(Container& c) {
+        Container::iterator it = next(c.begin(), c.size() / 2);
+        it = c.insert(it, -1);
+        c.erase(it);
+    }
+    static long long sum(const Container& c) {
+        long long s = 0;
+        for (int x : c) s += x;
+        return s;
+    }
+};
+
+struct ForwardListOps {
+    typedef forward_list<int> Container;
+    static const char* name() { return "forward_list"; }
+    static const bool linearIndex = true;
+    static const bool cheapFront = true;
+
+    // forward_list 没有 push_back，记住最后一个位置用 insert_after 追加
+    static void buildBack(Container& c, int n) {
+        Container::iterator last = c.before_begin();
+        for (int i = 0; i < n; ++i) last = c.insert_after(last, i);
+    }
+    static void buildFront(Container& c, int n) { for (int i = 0; i < n; ++i) c.push_front(i); }
+    static int at(const Container& c, int i) { return *next(c.begin(), i); }
+    // forward_list 不记录长度，中间位置由调用方传入的规模决定
+    static void insertEraseMiddle(Container& c, int n) {
+        Container::iterator it = next(c.before_begin(), n / 2);
+        c.insert_after(it, -1);
+        c.erase_after(it);
+    }
+    static long long sum(const Container& c) {
+        long long s = 0;
+        for (int x : c) s += x;
+        return s;
+    }
+};
+
+struct LinkListOps {
+    typedef link_list<int> Container;
+    static const char* name() { return "link_list"; }
+    static const bool linearIndex = true;
+    static const bool cheapFront = true;
+
+    static void buildBack(Container& c, int n) { for (int i = 0; i < n; ++i) c.add_at_tail(i); }
+    static void buildFront(Container& c, int n) { for (int i = 0; i < n; ++i) c.add_at_head(i); }
+    static int at(const Container& c, int i) { return c.get_value(i + 1); }
+    static void insertEraseMiddle(Container& c) {
+        int mid = c.size() / 2 + 1;
+        c.add_at_index(mid, -1);
+        c.delete_at_index(mid);
+    }
+    static long long sum(const Container& c) {
+        long long s = 0;
+        for (int x : c) s += x;
+        return s;
+    }
+};
+
+// forward_list 的中间插入需要额外的规模参数，其余容器忽略
+template <typename Ops>
+void insertEraseMiddle(typename Ops::Container& c, int) { Ops::insertEraseMiddle(c); }
+template <>
+void insertEraseMiddle<ForwardListOps>(forward_list<int>& c, int n) { ForwardListOps::insertEraseMiddle(c, n); }
+
+// ==================== 3. 测试项 ====================
+
+enum Workload { PUSH_BACK, PUSH_FRONT, RANDOM_ACCESS, MIDDLE_INSERT_ERASE, TRAVERSE, COPY, WORKLOAD_COUNT };
+
+const char* workloadName(int w) {
+    static const char* names[] = {"push_back", "push_front", "random access",
+                                  "middle insert+erase", "traverse", "copy"};
+    return names[w];
+}
+
+// O(n) 操作的执行次数：总工作量约 5e7 次元素访问
+int linearOpCount(int n) {
+    long long ops = 50000000LL / n;
+    if (ops > 100000) ops = 100000;
+    if (ops < 5) ops = 5;
+    return (int)ops;
+}
+
+const int kRandomOps = 1000000;   // O(1) 随机访问的次数
+const int kVectorFrontLimit = 100000;  // vector 头部插入构建是 O(n^2)，超过此规模跳过
+
+template <typename Ops>
+void benchContainer(int n, const vector<int>& randomIdx, Measurement results[WORKLOAD_COUNT]) {
+    typedef typename Ops::Container Container;
+
+    // 预热：先构建一次再释放，让分配器提前向系统要到内存，首次缺页不计入 push_back
+    {
+        Container warm;
+        Ops::buildBack(warm, n);
+    }
+
+    {
+        Container c;
+        results[PUSH_BACK] = measure(n, [&]() { Ops::buildBack(c, n); });
+    }
+
+    if (Ops::cheapFront || n <= kVectorFrontLimit) {
+        Container c;
+        results[PUSH_FRONT] = measure(n, [&]() { Ops::buildFront(c, n); });
+    } else {
+        results[PUSH_FRONT] = skipped();
+    }
+
+    Container c;
+    Ops::buildBack(c, n);
+
+    int accessOps = Ops::linearIndex ? min((int)randomIdx.size(), linearOpCount(n)) : (int)randomIdx.size();
+    results[RANDOM_ACCESS] = measure(accessOps, [&]() {
+        long long s = 0;
+        for (int i = 0; i < accessOps; ++i) s += Ops::at(c, randomIdx[i]);
+        g_sink = g_sink + s;
+    });
+
+    int middleOps = linearOpCount(n);
+    results[MIDDLE_INSERT_ERASE] = measure(middleOps, [&]() {
+        for (int i = 0; i < middleOps; ++i) insertEraseMiddle<Ops>(c, n);
+    });
+
+    results[TRAVERSE] = measure(n, [&]() { g_sink = g_sink + Ops::sum(c); });
+
+    results[COPY] = measure(n, [&]() {
+        Container copy(c);
+        g_sink = g_sink + (copy.empty() ? 0 : 1);
+    });
+}
+
+// ==================== 4. 输出 ====================
+
+string formatCell(const Measurement& m) {
+    if (!m.valid) return "-";
+    ostringstream os;
+    os << fixed << setprecision(m.nsPerOp < 100 ? 1 : 0) << m.nsPerOp;
+    if (g_counter.available()) {
+        os << " (" << setprecision(2) << m.missesPerOp << ")";
+    }
+    return os.str();
+}
+
+void runSize(int n) {
+    mt19937 rng(42);
+    uniform_int_distribution<int> dist(0, n - 1);
+    vector<int> randomIdx(kRandomOps);
+    for (int& idx : randomIdx) idx = dist(rng);
+
+    const int kContainers = 5;
+    const char* names[kContainers] = {VectorOps::name(), DequeOps::name(), ListOps::name(),
+                                      ForwardListOps::name(), LinkListOps::name()};
+    Measurement results[kContainers][WORKLOAD_COUNT];
+    benchContainer<VectorOps>(n, randomIdx, results[0]);
+    benchContainer<DequeOps>(n, randomIdx, results[1]);
+    benchContainer<ListOps>(n, randomIdx, results[2]);
+    benchContainer<ForwardListOps>(n, randomIdx, results[3]);
+    benchContainer<LinkListOps>(n, randomIdx, results[4]);
+
+    cout << "\n--- n = " << n << " ---" << endl;
+    cout << left << setw(22) << "ns/op" << right;
+    for (int i = 0; i < kContainers; ++i) cout << setw(18) << names[i];
+    cout << endl;
+    for (int w = 0; w < WORKLOAD_COUNT; ++w) {
+        cout << left << setw(22) << workloadName(w) << right;
+        for (int i = 0; i < kContainers; ++i) cout << setw(18) << formatCell(results[i][w]);
+        cout << endl;
+    }
+}
+
+// ==================== 主函数 ====================
+
+int main(int argc, char* argv[]) {
+    int maxSize = argc > 1 ? atoi(argv[1]) : 10000000;
+
+    cout << "=== 序列容器性能实测 ===" << endl;
+    if (g_counter.available()) {
+        cout << "括号内为每次操作的缓存未命中数（perf_event: PERF_COUNT_HW_CACHE_MISSES）" << endl;
+    } else {
+        cout << "perf_event 不可用，只输出耗时" << endl;
+    }
+    cout << "'-' 表示跳过（vector 头部插入构建在 n > " << kVectorFrontLimit << " 时为 O(n^2)）" << endl;
+
+    for (int n = 1000; n <= maxSize; n *= 10) {
+        runSize(n);
+    }
+    return 0;
+}
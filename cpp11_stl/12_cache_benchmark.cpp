@@ -0,0 +1,1037 @@
+/**
+ * 缓存性能实测
+ *
+ * 对 cache/ 目录下的缓存实现做吞吐量测量，按模式运行：
+ * 1. sharded：多线程读写同一个缓存，对比"一把互斥锁 + LRUCache"与不同分片数的 ShardedLRUCache，
+ *    线程数从 1 到 64，输出 Mops/s 与命中率
+ * 2. lfu：容量从 1e3 到 1e6 的 LFUCache，满容量时 put 新键（每次都要淘汰）与 get 的 ns/op，
+ *    对比旧版"遍历整个哈希表找最小频率"的实现
+ * 3. ttl：TTLCache 在 1e3 到 1e6 个未过期项时 get 的 ns/op，对比旧版"每次查找都扫描整个表"的实现；
+ *    再让一半的项同时过期，测随后每次 get 的平均与最大耗时（增量清理 / 后台线程清理）
+ * 4. flat：容量 1e4 到 4e6 的 LRUCache 与 FlatLRUCache，对比每项占用的堆内存、
+ *    全部命中时随机 get 的 ns/op，以及 Zipf 访问 + 未命中回填的 ns/op
+ * 5. policy：PolicyCache 搭配 LRU / LFU / CLOCK / SIEVE / S3-FIFO / ARC 策略，
+ *    在纯 Zipf 与混入顺序扫描的两种访问序列上的命中率和 ns/op
+ * 6. tinylfu：同样两种序列上，W-TinyLFU 准入（主缓存分别为 LRU、SIEVE、S3-FIFO）与不带准入的对比
+ * 7. stampede：冷启动时多个线程同时读取同一批键，loader 每次耗时 2ms，
+ *    对比"未命中各自加载"与 MultiLevelCache 单飞加载的 loader 调用次数和总耗时
+ * 8. mmap：LRUCache 与内存映射文件上的 MmapCache 存放 100 字节的值，对比 put / get 的 ns/op、
+ *    每项堆内存，以及 MmapCache 关闭后重新打开的耗时和保留下来的项数
+ * 9. pinned：值大小从 64 字节到 16KB，全部命中时 LRUCache::tryGet（拷贝）与 find（指针），
+ *    MultiLevelCache::get（拷贝）与 getPinned（固定，不拷贝）的 ns/op
+ * 10. weight：值大小在 50B ~ 5MB 之间（对数均匀）时，按项数限制容量与按字节预算限制容量的
+ *     峰值占用、最终占用与命中率；以及权重函数给 put 带来的额外开销
+ * 11. metrics：多个线程同时计数时，所有线程共用一个原子计数器与 CacheMetrics 按线程分条的 ns/op；
+ *     以及 LRUCache 全部命中时，延迟采样关闭、每 64 次采样一次、每次都采样的 ns/op 和采到的延迟分布
+ * 12. writeback：只写不读的 Zipf 序列，数据源每批写入耗时 100us + 每项 1us，
+ *     对比 MultiLevelCache 写穿与不同写回间隔时 put 的 ns/op、数据源收到的项数和批数
+ *
+ * sharded 的访问序列为 Zipf 分布（s = 0.99）的键，未命中时按 cache-aside 方式 put 回缓存。
+ * 单核机器上看不出多线程扩展性，只能看出加锁与分片本身的开销。
+ *
+ * 编译：g++ -std=c++11 -O2 -pthread 12_cache_benchmark.cpp -o cache_benchmark
+ * 运行：./cache_benchmark sharded [线程数...]    默认 1 2 4 8 16 32 64
+ *       ./cache_benchmark lfu [容量...]         默认 1000 10000 100000 1000000
+ *       ./cache_benchmark ttl [项数...]         默认 1000 10000 100000 1000000
+ *       ./cache_benchmark flat [容量...]        默认 10000 100000 1000000 4000000
+ *       ./cache_benchmark policy [容量...]      默认 1000 10000 100000
+ *       ./cache_benchmark tinylfu [容量...]     默认 1000 10000 100000
+ *       ./cache_benchmark stampede [线程数...]  默认 1 8 64
+ *       ./cache_benchmark mmap [项数...]        默认 10000 100000 1000000，数据文件写在当前目录
+ *       ./cache_benchmark pinned [值字节数...]  默认 64 1024 4096 16384
+ *       ./cache_benchmark weight [预算MB...]    默认 64 256
+ *       ./cache_benchmark metrics [线程数...]   默认 1 4 16
+ *       ./cache_benchmark writeback [间隔ms...] 默认 1 10 100
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "cache/cache_metrics.h"
+#include "cache/flat_lru_cache.h"
+#include "cache/lfu_cache.h"
+#include "cache/lru_cache.h"
+#include "cache/mmap_cache.h"
+#include "cache/multi_level_cache.h"
+#include "cache/policy_cache.h"
+#include "cache/sharded_lru_cache.h"
+#include "cache/tinylfu_cache.h"
+#include "cache/ttl_cache.h"
+#include "cache/workload.h"  // 访问序列：makeZipfTrace / makeScanMixedTrace
+
+using namespace std;
+using namespace std::chrono;
+
+// ==================== 1. 多线程吞吐量 ====================
+
+// 基线：一把互斥锁保护整个 LRUCache
+class LockedLRUCache {
+private:
+    mutex mtx;
+    LRUCache<int, int> cache;
+
+public:
+    LockedLRUCache(size_t cap) : cache(cap) {}
+
+    bool tryGet(int key, int& value) {
+        lock_guard<mutex> lock(mtx);
+        return cache.tryGet(key, value);
+    }
+
+    void put(int key, int value) {
+        lock_guard<mutex> lock(mtx);
+        cache.put(key, value);
+    }
+};
+
+struct RunResult {
+    double mops;
+    double hitRatio;
+};
+
+// 每个线程从访问序列的不同位置开始，总操作数固定，按墙钟时间计算吞吐量
+template<typename Cache>
+RunResult runThreads(Cache& cache, int threads, const vector<int>& trace, size_t totalOps) {
+    atomic<int> ready(0);
+    atomic<bool> go(false);
+    atomic<size_t> hits(0);
+    size_t opsPerThread = totalOps / threads;
+
+    vector<thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            size_t pos = (trace.size() / threads) * t;
+            size_t localHits = 0;
+            ready.fetch_add(1);
+            while (!go.load()) this_thread::yield();
+
+            for (size_t i = 0; i < opsPerThread; ++i) {
+                int key = trace[pos];
+                if (++pos == trace.size()) pos = 0;
+                int value;
+                if (cache.tryGet(key, value)) {
+                    localHits += (value == key);
+                } else {
+                    cache.put(key, key);  // 模拟从后端加载后回填
+                }
+            }
+            hits.fetch_add(localHits);
+        });
+    }
+
+    while (ready.load() < threads) this_thread::yield();
+    auto start = steady_clock::now();
+    go.store(true);
+    for (auto& w : workers) w.join();
+    double secs = duration<double>(steady_clock::now() - start).count();
+
+    size_t ops = opsPerThread * threads;
+    return RunResult{ops / secs / 1e6, (double)hits.load() / ops};
+}
+
+void benchSharded(const vector<int>& threadCounts) {
+    const size_t CAPACITY = 100000;
+    const int KEY_SPACE = 1000000;
+    const size_t TOTAL_OPS = 4000000;
+    const size_t shardCounts[] = {1, 8, 64};
+
+    vector<int> trace = makeZipfTrace(KEY_SPACE, 0.99, 1 << 22, 42);
+    cout << "容量 " << CAPACITY << "，键空间 " << KEY_SPACE << "，Zipf s=0.99，每轮 "
+         << TOTAL_OPS << " 次操作（Mops/s / 命中率）" << endl;
+    cout << "硬件线程数: " << thread::hardware_concurrency() << endl << endl;
+
+    cout << left << setw(8) << "threads" << right << setw(20) << "LRUCache+mutex";
+    for (size_t s : shardCounts) {
+        cout << setw(20) << ("sharded x" + to_string(s));
+    }
+    cout << endl;
+
+    for (int threads : threadCounts) {
+        cout << left << setw(8) << threads << right << fixed;
+        {
+            LockedLRUCache cache(CAPACITY);
+            runThreads(cache, 1, trace, CAPACITY);  // 预热
+            RunResult r = runThreads(cache, threads, trace, TOTAL_OPS);
+            cout << setw(12) << setprecision(2) << r.mops << " / "
+                 << setprecision(1) << setw(4) << r.hitRatio * 100 << "%";
+        }
+        for (size_t s : shardCounts) {
+            ShardedLRUCache<int, int> cache(CAPACITY, s);
+            runThreads(cache, 1, trace, CAPACITY);
+            RunResult r = runThreads(cache, threads, trace, TOTAL_OPS);
+            cout << setw(12) << setprecision(2) << r.mops << " / "
+                 << setprecision(1) << setw(4) << r.hitRatio * 100 << "%";
+        }
+        cout << endl;
+    }
+}
+
+// ==================== 2. LFU 淘汰开销 ====================
+
+// 旧版 LFU：每次淘汰用 min_element 扫描整个哈希表，每次访问读一次时钟用来打破平局
+class ScanLFUCache {
+private:
+    struct CacheItem {
+        int value;
+        size_t frequency;
+        steady_clock::time_point lastAccess;
+    };
+
+    size_t capacity;
+    unordered_map<int, CacheItem> cache;
+
+public:
+    ScanLFUCache(size_t cap) : capacity(cap) {}
+
+    bool tryGet(int key, int& value) {
+        auto it = cache.find(key);
+        if (it == cache.end()) return false;
+        it->second.frequency++;
+        it->second.lastAccess = steady_clock::now();
+        value = it->second.value;
+        return true;
+    }
+
+    void put(int key, int value) {
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            it->second.value = value;
+            it->second.frequency++;
+            it->second.lastAccess = steady_clock::now();
+            return;
+        }
+        if (cache.size() >= capacity) {
+            auto minIt = min_element(cache.begin(), cache.end(),
+                [](const pair<const int, CacheItem>& a, const pair<const int, CacheItem>& b) {
+                    if (a.second.frequency != b.second.frequency) {
+                        return a.second.frequency < b.second.frequency;
+                    }
+                    return a.second.lastAccess < b.second.lastAccess;
+                });
+            cache.erase(minIt);
+        }
+        cache[key] = {value, 1, steady_clock::now()};
+    }
+};
+
+// 先填满容量并让一半的键频率为 2，再测 put 新键（必然淘汰）与 get 已有键
+template<typename Cache>
+void benchLFUOne(const char* name, size_t cap, size_t ops) {
+    Cache cache(cap);
+    for (size_t i = 0; i < cap; ++i) {
+        cache.put((int)i, (int)i);
+    }
+    int value;
+    for (size_t i = 0; i < cap; i += 2) {
+        cache.tryGet((int)i, value);
+    }
+
+    mt19937 rng(7);
+    vector<int> getKeys(ops);
+    for (size_t i = 0; i < ops; ++i) {
+        getKeys[i] = (int)(rng() % cap);
+    }
+
+    long long sink = 0;
+    auto t0 = steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        cache.put((int)(cap + i), (int)i);
+    }
+    auto t1 = steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        if (cache.tryGet(getKeys[i], value)) sink += value;
+    }
+    auto t2 = steady_clock::now();
+
+    cout << left << setw(12) << name << right << setw(10) << cap << setw(10) << ops << fixed << setprecision(1)
+         << setw(16) << duration<double, nano>(t1 - t0).count() / ops
+         << setw(16) << duration<double, nano>(t2 - t1).count() / ops
+         << "   " << sink << endl;
+}
+
+void benchLFU(const vector<int>& capacities) {
+    cout << left << setw(12) << "cache" << right << setw(10) << "capacity" << setw(10) << "ops"
+         << setw(16) << "put+evict ns" << setw(16) << "get ns" << "   checksum" << endl;
+    for (int cap : capacities) {
+        benchLFUOne<LFUCache<int, int>>("LFUCache", cap, 1000000);
+        // 扫描版每次 put O(n)，按容量缩减操作次数
+        size_t scanOps = max((size_t)20, min((size_t)1000000, (size_t)200000000 / cap));
+        benchLFUOne<ScanLFUCache>("scan LFU", cap, scanOps);
+    }
+}
+
+// ==================== 3. TTL 查找与过期清理 ====================
+
+// 旧版 TTL：每次查找先遍历整个表删除过期项，每项读一次时钟
+class ScanTTLCache {
+private:
+    struct CacheItem {
+        int value;
+        steady_clock::time_point expireTime;
+    };
+
+    unordered_map<int, CacheItem> cache;
+
+    void cleanExpired() {
+        for (auto it = cache.begin(); it != cache.end();) {
+            if (steady_clock::now() > it->second.expireTime) {
+                it = cache.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+public:
+    void put(int key, int value, milliseconds ttl) {
+        cache[key] = {value, steady_clock::now() + ttl};
+    }
+
+    bool tryGet(int key, int& value) {
+        cleanExpired();
+        auto it = cache.find(key);
+        if (it == cache.end() || steady_clock::now() > it->second.expireTime) {
+            return false;
+        }
+        value = it->second.value;
+        return true;
+    }
+};
+
+template<typename Cache>
+void benchTTLGet(const char* name, Cache& cache, size_t n, size_t ops) {
+    for (size_t i = 0; i < n; ++i) {
+        cache.put((int)i, (int)i, hours(1));
+    }
+    mt19937 rng(11);
+    long long sink = 0;
+    int value;
+    auto t0 = steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        if (cache.tryGet((int)(rng() % n), value)) sink += value;
+    }
+    double ns = duration<double, nano>(steady_clock::now() - t0).count() / ops;
+    cout << left << setw(22) << name << right << setw(10) << n << setw(10) << ops
+         << fixed << setprecision(1) << setw(14) << ns << "   " << sink << endl;
+}
+
+// n 个长期项 + n 个 50ms 后同时过期的项，过期后测 get 的平均与最大单次耗时
+void benchTTLExpiry(const char* name, size_t n, bool useReaper) {
+    TTLCache<int, int> cache(milliseconds(50));
+    if (useReaper) {
+        cache.startReaper(milliseconds(10));
+    }
+    for (size_t i = 0; i < n; ++i) {
+        cache.put((int)i, (int)i, hours(1));
+        cache.put((int)(n + i), (int)i);
+    }
+    this_thread::sleep_for(milliseconds(60));
+
+    size_t ops = 200000;
+    mt19937 rng(13);
+    double maxNs = 0;
+    long long sink = 0;
+    int value;
+    auto t0 = steady_clock::now();
+    for (size_t i = 0; i < ops; ++i) {
+        auto s = steady_clock::now();
+        if (cache.tryGet((int)(rng() % (2 * n)), value)) sink += value;
+        maxNs = max(maxNs, duration<double, nano>(steady_clock::now() - s).count());
+    }
+    double avgNs = duration<double, nano>(steady_clock::now() - t0).count() / ops;
+    cout << left << setw(22) << name << right << setw(10) << 2 * n << fixed << setprecision(1)
+         << setw(14) << avgNs << setw(14) << maxNs / 1000 << setw(12) << cache.size()
+         << "   " << sink << endl;
+}
+
+void benchTTL(const vector<int>& sizes) {
+    cout << "未过期项的 get（ns/op）" << endl;
+    cout << left << setw(22) << "cache" << right << setw(10) << "entries" << setw(10) << "ops"
+         << setw(14) << "get ns" << "   checksum" << endl;
+    for (int n : sizes) {
+        {
+            TTLCache<int, int> cache;
+            benchTTLGet("TTLCache", cache, n, 1000000);
+        }
+        ScanTTLCache scan;
+        benchTTLGet("scan TTL", scan, n, max((size_t)20, min((size_t)1000000, (size_t)100000000 / n)));
+    }
+
+    cout << "\n一半的项同时过期之后的 get" << endl;
+    cout << left << setw(22) << "cache" << right << setw(10) << "entries" << setw(14) << "avg ns"
+         << setw(14) << "max us" << setw(12) << "left" << "   checksum" << endl;
+    for (int n : sizes) {
+        benchTTLExpiry("TTLCache budget=8", n, false);
+        benchTTLExpiry("TTLCache + reaper", n, true);
+    }
+}
+
+// ==================== 4. 扁平 LRU ====================
+
+// 当前堆上已分配的字节数，用于估算每项内存；glibc 2.33 以下没有 mallinfo2，返回 0
+size_t heapInUse() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+template<typename Cache>
+void benchFlatOne(const char* name, size_t cap, const vector<int>& hitKeys, const vector<int>& zipfKeys) {
+    size_t before = heapInUse();
+    Cache cache(cap);
+    for (size_t i = 0; i < cap; ++i) {
+        cache.put((int)i, (int)i);
+    }
+    size_t used = heapInUse() - before;
+
+    long long sink = 0;
+    int value;
+    auto t0 = steady_clock::now();
+    for (int k : hitKeys) {
+        if (cache.tryGet(k, value)) sink += value;
+    }
+    auto t1 = steady_clock::now();
+    size_t hits = 0;
+    for (int k : zipfKeys) {
+        if (cache.tryGet(k, value)) {
+            ++hits;
+        } else {
+            cache.put(k, k);
+        }
+    }
+    auto t2 = steady_clock::now();
+
+    cout << left << setw(14) << name << right << setw(10) << cap << fixed << setprecision(1);
+    if (used > 0) {
+        cout << setw(14) << (double)used / cap;
+    } else {
+        cout << setw(14) << "n/a";
+    }
+    cout << setw(14) << duration<double, nano>(t1 - t0).count() / hitKeys.size()
+         << setw(14) << duration<double, nano>(t2 - t1).count() / zipfKeys.size()
+         << setw(10) << 100.0 * hits / zipfKeys.size() << "%   " << sink << endl;
+}
+
+void benchFlat(const vector<int>& capacities) {
+    const size_t OPS = 2000000;
+    cout << left << setw(14) << "cache" << right << setw(10) << "capacity" << setw(14) << "bytes/entry"
+         << setw(14) << "hit get ns" << setw(14) << "zipf ns" << setw(11) << "zipf hit" << "   checksum" << endl;
+    for (int cap : capacities) {
+        mt19937 rng(17);
+        vector<int> hitKeys(OPS);
+        for (auto& k : hitKeys) {
+            k = (int)(rng() % cap);
+        }
+        vector<int> zipfKeys = makeZipfTrace(cap * 4, 0.9, OPS, 19);
+        benchFlatOne<LRUCache<int, int>>("LRUCache", cap, hitKeys, zipfKeys);
+        benchFlatOne<FlatLRUCache<int, int>>("FlatLRUCache", cap, hitKeys, zipfKeys);
+    }
+}
+
+// ==================== 5. 淘汰策略对比 ====================
+
+// 按 cache-aside 方式回放两条访问序列，输出各自的命中率与 ns/op
+template<typename Cache>
+void benchTraceHits(const char* name, size_t cap, const vector<int>& zipf, const vector<int>& mixed) {
+    cout << left << setw(16) << name << right << fixed;
+    for (const vector<int>* trace : {&zipf, &mixed}) {
+        Cache cache(cap);
+        size_t hits = 0;
+        int value;
+        auto t0 = steady_clock::now();
+        for (int k : *trace) {
+            if (cache.tryGet(k, value)) {
+                ++hits;
+            } else {
+                cache.put(k, k);
+            }
+        }
+        double ns = duration<double, nano>(steady_clock::now() - t0).count() / trace->size();
+        cout << setw(12) << setprecision(2) << 100.0 * hits / trace->size() << "%"
+             << setw(10) << setprecision(1) << ns;
+    }
+    cout << endl;
+}
+
+// 对每个容量生成两条序列，交给 run(cap, zipf, mixed) 回放
+template<typename Run>
+void forEachTracePair(const vector<int>& capacities, Run run) {
+    const size_t OPS = 4000000;
+    for (int cap : capacities) {
+        int keySpace = cap * 10;
+        vector<int> zipf = makeZipfTrace(keySpace, 0.9, OPS, 23);
+        vector<int> mixed = makeScanMixedTrace(keySpace, 0.9, OPS, 0.3, cap * 20, 23);
+        cout << "\n容量 " << cap << "，Zipf 键空间 " << keySpace << "（s=0.9），混合序列 30% 为顺序扫描" << endl;
+        cout << left << setw(16) << "cache" << right << setw(13) << "zipf hit" << setw(10) << "ns/op"
+             << setw(13) << "mixed hit" << setw(10) << "ns/op" << endl;
+        run(cap, zipf, mixed);
+    }
+}
+
+void benchPolicy(const vector<int>& capacities) {
+    forEachTracePair(capacities, [](size_t cap, const vector<int>& zipf, const vector<int>& mixed) {
+        benchTraceHits<PolicyCache<int, int, LRUPolicy>>("LRU", cap, zipf, mixed);
+        benchTraceHits<PolicyCache<int, int, LFUPolicy>>("LFU", cap, zipf, mixed);
+        benchTraceHits<PolicyCache<int, int, ClockPolicy>>("CLOCK", cap, zipf, mixed);
+        benchTraceHits<PolicyCache<int, int, SievePolicy>>("SIEVE", cap, zipf, mixed);
+        benchTraceHits<PolicyCache<int, int, S3FifoPolicy>>("S3-FIFO", cap, zipf, mixed);
+        benchTraceHits<PolicyCache<int, int, ARCPolicy>>("ARC", cap, zipf, mixed);
+    });
+}
+
+// ==================== 6. W-TinyLFU 准入 ====================
+
+void benchTinyLFU(const vector<int>& capacities) {
+    forEachTracePair(capacities, [](size_t cap, const vector<int>& zipf, const vector<int>& mixed) {
+        benchTraceHits<LRUCache<int, int>>("LRUCache", cap, zipf, mixed);
+        benchTraceHits<TinyLFUCache<int, int, LRUCache<int, int>>>("W-TinyLFU+LRU", cap, zipf, mixed);
+        benchTraceHits<PolicyCache<int, int, SievePolicy>>("SIEVE", cap, zipf, mixed);
+        benchTraceHits<TinyLFUCache<int, int, PolicyCache<int, int, SievePolicy>>>("W-TinyLFU+SIEVE", cap, zipf, mixed);
+        benchTraceHits<PolicyCache<int, int, S3FifoPolicy>>("S3-FIFO", cap, zipf, mixed);
+        benchTraceHits<TinyLFUCache<int, int, PolicyCache<int, int, S3FifoPolicy>>>("W-TinyLFU+S3", cap, zipf, mixed);
+        cout << "草图 + 门卫: " << TinyLFUCache<int, int>(cap).sketchBytes() / (double)cap << " 字节/项" << endl;
+    });
+}
+
+// ==================== 7. 冷启动击穿 ====================
+
+// 基线：未命中时各自调用 loader（锁外加载），并发未命中同一个键会重复加载
+class NaiveLoadingCache {
+private:
+    mutex mtx;
+    LRUCache<int, int> cache;
+    function<int(const int&)> loader;
+
+public:
+    NaiveLoadingCache(size_t cap, function<int(const int&)> loadFunc) : cache(cap), loader(loadFunc) {}
+
+    int get(int key) {
+        {
+            lock_guard<mutex> lock(mtx);
+            int value;
+            if (cache.tryGet(key, value)) {
+                return value;
+            }
+        }
+        int value = loader(key);
+        lock_guard<mutex> lock(mtx);
+        cache.put(key, value);
+        return value;
+    }
+};
+
+// 每个线程按相同顺序读取 keys 个冷键，返回耗时（毫秒）
+template<typename Cache>
+double runStampede(Cache& cache, int threads, int keys) {
+    vector<thread> workers;
+    auto start = steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&]() {
+            for (int k = 0; k < keys; ++k) {
+                cache.get(k);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    return duration<double, milli>(steady_clock::now() - start).count();
+}
+
+void benchStampede(const vector<int>& threadCounts) {
+    const int KEYS = 100;
+    const size_t LOADERS = 4;
+    atomic<size_t> calls(0);
+    auto slowLoad = [&calls](const int& key) {
+        calls.fetch_add(1);
+        this_thread::sleep_for(milliseconds(2));
+        return key;
+    };
+
+    cout << KEYS << " 个冷键，loader 每次 2ms，单飞加载线程数 " << LOADERS << "（loader 调用次数 / 总耗时 ms）" << endl;
+    cout << left << setw(8) << "threads" << right << setw(24) << "各自加载" << setw(24) << "单飞加载" << endl;
+    for (int threads : threadCounts) {
+        cout << left << setw(8) << threads << right << fixed << setprecision(1);
+        {
+            calls.store(0);
+            NaiveLoadingCache cache(KEYS * 2, slowLoad);
+            double ms = runStampede(cache, threads, KEYS);
+            cout << setw(12) << calls.load() << " / " << setw(8) << ms;
+        }
+        {
+            calls.store(0);
+            MultiLevelCache<int, int> cache(KEYS, KEYS * 2, slowLoad, LOADERS);
+            double ms = runStampede(cache, threads, KEYS);
+            cout << setw(12) << calls.load() << " / " << setw(8) << ms;
+        }
+        cout << endl;
+    }
+}
+
+// ==================== 8. 内存映射 L2 ====================
+
+template<typename Cache>
+void benchMmapOps(Cache& cache, size_t n, const vector<int>& getKeys, double& putNs, double& getNs) {
+    string value(100, 'v');
+    auto t0 = steady_clock::now();
+    for (size_t i = 0; i < n; ++i) {
+        cache.put((int)i, value);
+    }
+    auto t1 = steady_clock::now();
+    size_t found = 0;
+    for (int k : getKeys) {
+        found += cache.tryGet(k, value);
+    }
+    auto t2 = steady_clock::now();
+    putNs = duration<double, nano>(t1 - t0).count() / n;
+    getNs = duration<double, nano>(t2 - t1).count() / getKeys.size();
+    if (found != getKeys.size()) {
+        cout << "  （" << getKeys.size() - found << " 次未命中）" << endl;
+    }
+}
+
+void benchMmap(const vector<int>& sizes) {
+    const char* PATH = "cache_benchmark_l2.dat";
+    const size_t OPS = 1000000;
+    cout << "值为 100 字节的 string，get 全部命中" << endl;
+    cout << left << setw(12) << "cache" << right << setw(10) << "items" << setw(12) << "put ns"
+         << setw(12) << "get ns" << setw(14) << "heap B/item" << setw(14) << "reopen ms" << setw(12) << "kept" << endl;
+    for (int n : sizes) {
+        mt19937 rng(29);
+        vector<int> getKeys(OPS);
+        for (auto& k : getKeys) {
+            k = (int)(rng() % n);
+        }
+        double putNs, getNs;
+        cout << fixed << setprecision(1);
+        {
+            size_t before = heapInUse();
+            LRUCache<int, string> cache(n);
+            benchMmapOps(cache, n, getKeys, putNs, getNs);
+            size_t used = heapInUse() - before;
+            cout << left << setw(12) << "LRUCache" << right << setw(10) << n << setw(12) << putNs
+                 << setw(12) << getNs << setw(14) << (double)used / n << setw(14) << "-" << setw(12) << 0 << endl;
+        }
+        {
+            ::unlink(PATH);
+            size_t dataBytes = (size_t)n * 176;  // 每条记录 144 字节，留出死记录的余量
+            size_t before = heapInUse();
+            size_t fileBytes;
+            {
+                MmapCache<int, string> cache(PATH, n, dataBytes);
+                benchMmapOps(cache, n, getKeys, putNs, getNs);
+                fileBytes = cache.fileBytes();
+            }
+            size_t used = heapInUse() - before;
+            auto t0 = steady_clock::now();
+            MmapCache<int, string> reopened(PATH, n, dataBytes);
+            double reopenMs = duration<double, milli>(steady_clock::now() - t0).count();
+            cout << left << setw(12) << "MmapCache" << right << setw(10) << n << setw(12) << putNs
+                 << setw(12) << getNs << setw(14) << (double)used / n << setw(14) << reopenMs
+                 << setw(12) << reopened.size() << "   文件 " << fileBytes / (1 << 20) << " MB" << endl;
+        }
+        ::unlink(PATH);
+    }
+}
+
+// ==================== 9. 免拷贝读取 ====================
+
+void benchPinned(const vector<int>& valueSizes) {
+    const int KEYS = 1000;
+    const size_t OPS = 1000000;
+    mt19937 rng(31);
+    vector<int> keys(OPS);
+    for (auto& k : keys) {
+        k = (int)(rng() % KEYS);
+    }
+
+    cout << KEYS << " 个键全部在 L1 中，随机读取，每次读取累加值的长度（ns/op）" << endl;
+    cout << left << setw(10) << "bytes" << right << setw(16) << "LRU tryGet" << setw(16) << "LRU find"
+         << setw(16) << "ML get" << setw(16) << "ML getPinned" << endl;
+    for (int bytes : valueSizes) {
+        string payload(bytes, 'p');
+        size_t sink = 0;
+        cout << left << setw(10) << bytes << right << fixed << setprecision(1);
+
+        LRUCache<int, string> lru(KEYS);
+        for (int k = 0; k < KEYS; ++k) {
+            lru.put(k, payload);
+        }
+        auto t0 = steady_clock::now();
+        string value;
+        for (int k : keys) {
+            if (lru.tryGet(k, value)) sink += value.size();
+        }
+        auto t1 = steady_clock::now();
+        for (int k : keys) {
+            if (const string* v = lru.find(k)) sink += v->size();
+        }
+        auto t2 = steady_clock::now();
+        cout << setw(16) << duration<double, nano>(t1 - t0).count() / OPS
+             << setw(16) << duration<double, nano>(t2 - t1).count() / OPS;
+
+        MultiLevelCache<int, string> ml(KEYS, KEYS, [&payload](const int&) { return payload; }, 1);
+        for (int k = 0; k < KEYS; ++k) {
+            ml.put(k, payload);
+        }
+        t0 = steady_clock::now();
+        for (int k : keys) {
+            sink += ml.get(k).size();
+        }
+        t1 = steady_clock::now();
+        for (int k : keys) {
+            sink += ml.getPinned(k)->size();
+        }
+        t2 = steady_clock::now();
+        cout << setw(16) << duration<double, nano>(t1 - t0).count() / OPS
+             << setw(16) << duration<double, nano>(t2 - t1).count() / OPS
+             << "   " << sink << endl;
+    }
+}
+
+// ==================== 10. 按字节预算限制容量 ====================
+
+// 按项数限制容量的 LRUCache，另外用 victim() 跟踪缓存中值的字节数之和
+class CountLimitedLRU {
+private:
+    LRUCache<int, size_t> cache;
+    const vector<size_t>& sizeOf;
+    size_t bytes = 0;
+
+public:
+    CountLimitedLRU(size_t cap, const vector<size_t>& sizes) : cache(cap), sizeOf(sizes) {}
+
+    bool tryGet(int key, size_t& value) {
+        return cache.tryGet(key, value);
+    }
+
+    void put(int key, size_t value) {
+        if (!cache.contains(key)) {
+            int victimKey;
+            if (cache.victim(key, victimKey)) {
+                bytes -= sizeOf[victimKey];
+            }
+            bytes += value;
+        }
+        cache.put(key, value);
+    }
+
+    size_t size() const { return cache.size(); }
+    size_t weight() const { return bytes; }
+};
+
+// 值只记录大小（模拟 50B ~ 5MB 的对象），权重函数返回这个大小
+template<typename Cache>
+void benchWeightOne(const char* name, Cache& cache, const vector<int>& trace,
+                    const vector<size_t>& sizeOf, size_t budget) {
+    size_t hits = 0, peak = 0;
+    for (int k : trace) {
+        size_t bytes;
+        if (cache.tryGet(k, bytes)) {
+            ++hits;
+        } else {
+            cache.put(k, sizeOf[k]);
+        }
+        peak = max(peak, cache.weight());
+    }
+    cout << left << setw(26) << name << right << fixed << setprecision(1)
+         << setw(10) << cache.size() << setw(14) << peak / 1048576.0 << setw(14) << cache.weight() / 1048576.0
+         << setw(12) << 100.0 * peak / budget << "%" << setw(10) << 100.0 * hits / trace.size() << "%" << endl;
+}
+
+void benchWeight(const vector<int>& budgetsMB) {
+    const int KEYS = 20000;
+    mt19937 rng(37);
+    vector<size_t> sizeOf(KEYS);
+    double meanBytes = 0;
+    for (auto& sz : sizeOf) {
+        sz = (size_t)(50 * pow(1e5, uniform_real_distribution<double>(0, 1)(rng)));  // 50B ~ 5MB
+        meanBytes += sz;
+    }
+    meanBytes /= KEYS;
+    vector<int> trace = makeZipfTrace(KEYS, 0.9, 2000000, 37);
+    Weigher<int, size_t> bySize = [](const int&, const size_t& bytes) { return bytes; };
+
+    // 权重函数的额外开销：整数值全部未命中时 put 的 ns/op
+    {
+        const size_t OPS = 2000000;
+        LRUCache<int, size_t> plain(10000);
+        LRUCache<int, size_t> weighed(10000, bySize);
+        auto t0 = steady_clock::now();
+        for (size_t i = 0; i < OPS; ++i) plain.put((int)i, 1);
+        auto t1 = steady_clock::now();
+        for (size_t i = 0; i < OPS; ++i) weighed.put((int)i, 1);
+        auto t2 = steady_clock::now();
+        cout << "put（每次淘汰）: 按项数 " << fixed << setprecision(1)
+             << duration<double, nano>(t1 - t0).count() / OPS << " ns/op，带权重函数 "
+             << duration<double, nano>(t2 - t1).count() / OPS << " ns/op" << endl << endl;
+    }
+
+    cout << KEYS << " 个键，值大小 50B ~ 5MB 对数均匀，平均 " << fixed << setprecision(1)
+         << meanBytes / 1024 << " KB，Zipf s=0.9 访问（占用为值的字节数之和，百分比相对预算）" << endl;
+    for (int mb : budgetsMB) {
+        size_t budget = (size_t)mb << 20;
+        cout << "\n预算 " << mb << " MB" << endl;
+        cout << left << setw(26) << "cache" << right << setw(10) << "items" << setw(14) << "peak MB"
+             << setw(14) << "final MB" << setw(13) << "peak/budget" << setw(11) << "hit" << endl;
+        // 按项数：容量 = 预算 / 平均值大小，大值集中时超出预算；容量 = 预算 / 最大值大小，浪费大部分预算
+        CountLimitedLRU byMean(budget / meanBytes, sizeOf);
+        benchWeightOne("LRU 项数=预算/平均大小", byMean, trace, sizeOf, budget);
+        CountLimitedLRU byMax(budget / (5 << 20), sizeOf);
+        benchWeightOne("LRU 项数=预算/最大大小", byMax, trace, sizeOf, budget);
+        LRUCache<int, size_t> byBytes(budget, bySize);
+        benchWeightOne("LRU 字节预算", byBytes, trace, sizeOf, budget);
+        LFUCache<int, size_t> lfuBytes(budget, bySize);
+        benchWeightOne("LFU 字节预算", lfuBytes, trace, sizeOf, budget);
+    }
+}
+
+// ==================== 11. 统计的开销 ====================
+
+template<typename Count>
+double timeCounting(int threads, size_t opsPerThread, Count count) {
+    vector<thread> pool;
+    auto t0 = steady_clock::now();
+    for (int t = 0; t < threads; ++t) {
+        pool.emplace_back([&count, opsPerThread] {
+            for (size_t i = 0; i < opsPerThread; ++i) count();
+        });
+    }
+    for (auto& th : pool) th.join();
+    return duration<double, nano>(steady_clock::now() - t0).count() / (opsPerThread * threads);
+}
+
+void benchMetrics(const vector<int>& threadCounts) {
+    const size_t OPS = 4000000;
+    cout << "每个线程计数 " << OPS << " 次（ns/op，按总次数平均）" << endl;
+    cout << left << setw(10) << "threads" << right << setw(16) << "shared atomic" << setw(16) << "CacheMetrics" << endl;
+    for (int threads : threadCounts) {
+        atomic<uint64_t> shared(0);
+        CacheMetrics metrics;
+        double sharedNs = timeCounting(threads, OPS, [&shared] { shared.fetch_add(1, memory_order_relaxed); });
+        double stripedNs = timeCounting(threads, OPS, [&metrics] { metrics.add(CacheMetrics::HITS); });
+        if (shared.load() != metrics.snapshot().hits) {
+            cout << "计数不一致" << endl;
+        }
+        cout << left << setw(10) << threads << right << fixed << setprecision(2)
+             << setw(16) << sharedNs << setw(16) << stripedNs << endl;
+    }
+
+    // 延迟采样的开销：1000 个键全部命中
+    const int KEYS = 1000;
+    mt19937 rng(41);
+    vector<int> keys(OPS);
+    for (auto& k : keys) {
+        k = (int)(rng() % KEYS);
+    }
+    cout << "\nLRUCache " << KEYS << " 个键全部命中，随机 tryGet" << endl;
+    const size_t sampling[] = {0, 64, 1};
+    for (size_t every : sampling) {
+        LRUCache<int, int> cache(KEYS);
+        for (int k = 0; k < KEYS; ++k) {
+            cache.put(k, k);
+        }
+        cache.setLatencySampling(every);
+        long sum = 0;
+        auto t0 = steady_clock::now();
+        for (int k : keys) {
+            int v;
+            if (cache.tryGet(k, v)) sum += v;
+        }
+        double ns = duration<double, nano>(steady_clock::now() - t0).count() / OPS;
+        CacheStats st = cache.stats();
+        cout << "采样 " << (every == 0 ? string("关闭") : "1/" + to_string(every)) << ": "
+             << fixed << setprecision(1) << ns << " ns/op";
+        if (st.getLatency.count() > 0) {
+            cout << "，p50 <" << st.getLatency.percentile(50) << "ns，p99 <" << st.getLatency.percentile(99)
+                 << "ns，p99.9 <" << st.getLatency.percentile(99.9) << "ns";
+        }
+        cout << "   " << sum << endl;
+    }
+}
+
+// ==================== 12. 写穿与写回 ====================
+
+// 模拟的数据源：每批写入固定耗时 100us，加上每项 1us
+class SlowBackend {
+private:
+    mutex mtx;
+    unordered_map<int, int> data;
+    size_t items = 0;
+    size_t batches = 0;
+
+public:
+    void write(const vector<pair<int, int>>& batch) {
+        this_thread::sleep_for(microseconds(100 + batch.size()));
+        lock_guard<mutex> lock(mtx);
+        for (const auto& kv : batch) {
+            data[kv.first] = kv.second;
+        }
+        items += batch.size();
+        ++batches;
+    }
+
+    size_t itemCount() { lock_guard<mutex> lock(mtx); return items; }
+    size_t batchCount() { lock_guard<mutex> lock(mtx); return batches; }
+
+    // 数据源中每个键的值是否都是最后一次写入的值
+    bool matches(const unordered_map<int, int>& expected) {
+        lock_guard<mutex> lock(mtx);
+        return data == expected;
+    }
+};
+
+void benchWriteBackOne(const string& name, const vector<int>& trace, int delayMs) {
+    const size_t L1 = 1000, L2 = 10000;
+    SlowBackend backend;
+    auto writer = [&backend](const vector<pair<int, int>>& batch) { backend.write(batch); };
+    unordered_map<int, int> expected;
+
+    double putNs, totalMs;
+    {
+        MultiLevelCache<int, int> cache(L1, L2, [](const int& key) { return key; });
+        if (delayMs < 0) {
+            cache.enableWriteThrough(writer);
+        } else {
+            cache.enableWriteBehind(writer, 256, milliseconds(delayMs));
+        }
+        auto t0 = steady_clock::now();
+        for (size_t i = 0; i < trace.size(); ++i) {
+            cache.put(trace[i], (int)i);
+            expected[trace[i]] = (int)i;
+        }
+        auto t1 = steady_clock::now();
+        cache.flush();
+        putNs = duration<double, nano>(t1 - t0).count() / trace.size();
+        totalMs = duration<double, milli>(steady_clock::now() - t0).count();
+    }
+
+    cout << left << setw(14) << name << right << fixed << setprecision(1)
+         << setw(12) << putNs << setw(12) << totalMs
+         << setw(10) << backend.itemCount() << setw(10) << backend.batchCount();
+    if (!backend.matches(expected)) {
+        cout << "   数据源与最后写入的值不一致";
+    }
+    cout << endl;
+}
+
+void benchWriteBack(const vector<int>& delaysMs) {
+    const int KEYS = 10000;
+    const size_t OPS = 20000;
+    vector<int> trace = makeZipfTrace(KEYS, 0.99, OPS, 47);
+
+    cout << OPS << " 次 put，Zipf 分布（s = 0.99）的 " << KEYS << " 个键；写回每批最多 256 项" << endl;
+    cout << left << setw(14) << "mode" << right << setw(12) << "put ns/op" << setw(12) << "total ms"
+         << setw(10) << "items" << setw(10) << "batches" << endl;
+    benchWriteBackOne("write-through", trace, -1);
+    for (int ms : delaysMs) {
+        benchWriteBackOne("behind " + to_string(ms) + "ms", trace, ms);
+    }
+}
+
+// ==================== 主函数 ====================
+
+void usage(const char* prog) {
+    cout << "用法: " << prog << " sharded [线程数...] | lfu [容量...] | ttl [项数...] | flat [容量...] | policy [容量...] | tinylfu [容量...] | stampede [线程数...] | mmap [项数...] | pinned [值字节数...] | weight [预算MB...] | metrics [线程数...] | writeback [间隔ms...]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // 参数都必须是正数；写回间隔可以为 0（立即写回）
+    int minArg = strcmp(argv[1], "writeback") == 0 ? 0 : 1;
+    vector<int> args;
+    for (int i = 2; i < argc; ++i) {
+        args.push_back(atoi(argv[i]));
+        if (args.back() < minArg) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (strcmp(argv[1], "sharded") == 0) {
+        if (args.empty()) {
+            args = {1, 2, 4, 8, 16, 32, 64};
+        }
+        benchSharded(args);
+    } else if (strcmp(argv[1], "lfu") == 0) {
+        if (args.empty()) {
+            args = {1000, 10000, 100000, 1000000};
+        }
+        benchLFU(args);
+    } else if (strcmp(argv[1], "ttl") == 0) {
+        if (args.empty()) {
+            args = {1000, 10000, 100000, 1000000};
+        }
+        benchTTL(args);
+    } else if (strcmp(argv[1], "flat") == 0) {
+        if (args.empty()) {
+            args = {10000, 100000, 1000000, 4000000};
+        }
+        benchFlat(args);
+    } else if (strcmp(argv[1], "policy") == 0) {
+        if (args.empty()) {
+            args = {1000, 10000, 100000};
+        }
+        benchPolicy(args);
+    } else if (strcmp(argv[1], "tinylfu") == 0) {
+        if (args.empty()) {
+            args = {1000, 10000, 100000};
+        }
+        benchTinyLFU(args);
+    } else if (strcmp(argv[1], "stampede") == 0) {
+        if (args.empty()) {
+            args = {1, 8, 64};
+        }
+        benchStampede(args);
+    } else if (strcmp(argv[1], "mmap") == 0) {
+        if (args.empty()) {
+            args = {10000, 100000, 1000000};
+        }
+        benchMmap(args);
+    } else if (strcmp(argv[1], "pinned") == 0) {
+        if (args.empty()) {
+            args = {64, 1024, 4096, 16384};
+        }
+        benchPinned(args);
+    } else if (strcmp(argv[1], "weight") == 0) {
+        if (args.empty()) {
+            args = {64, 256};
+        }
+        benchWeight(args);
+    } else if (strcmp(argv[1], "metrics") == 0) {
+        if (args.empty()) {
+            args = {1, 4, 16};
+        }
+        benchMetrics(args);
+    } else if (strcmp(argv[1], "writeback") == 0) {
+        if (args.empty()) {
+            args = {1, 10, 100};
+        }
+        benchWriteBack(args);
+    } else {
+        usage(argv[0]);
+        return 1;
+    }
+    return 0;
+}
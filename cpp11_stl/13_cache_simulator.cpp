@@ -0,0 +1,334 @@
+/**
+ * 缓存模拟器：按访问序列回放，比较各个缓存的命中率与吞吐量
+ *
+ * 访问序列（生成与读取见 cache/workload.h）：
+ * 1. zipf：Zipf 分布（s = 0.9），键空间为容量的 10 倍
+ * 2. scan：同样的 Zipf 访问，30% 的段是对冷键的顺序扫描
+ * 3. ttl：Zipf 访问，键空间为容量的 2 倍，每个键的 TTL 为 1 / 10 / 100ms 之一，按真实时间回放
+ * 4. file：读取轨迹文件，每行一次访问，第一列为键，可选的第二列为 TTL（毫秒）
+ *
+ * 回放方式为 cache-aside：读未命中（或读到的值已过期）就写入一个带过期时刻的值。
+ * - 不支持过期的缓存把过期时刻存在值里，读到过期的值按未命中处理；TTLCache 用自己的过期机制
+ * - MultiLevelCache 未命中时由 loader 生成值，命中数取自它的 stats()
+ * - 多线程时各线程交错地分担同一条序列（线程 t 回放第 t, t+n, t+2n, ... 次访问）；
+ *   非线程安全的缓存外面加一把互斥锁，TTLCache、ShardedLRUCache、MultiLevelCache 直接共用
+ * 每个容量、每个线程数都用新建的缓存从冷启动开始回放，命中率包含预热阶段。
+ * 单核机器上多线程的吞吐量只反映加锁与线程切换的开销。
+ *
+ * 编译：g++ -std=c++11 -O2 -pthread 13_cache_simulator.cpp -o cache_simulator
+ * 运行：./cache_simulator zipf [容量...]          默认 1000 10000 100000
+ *       ./cache_simulator scan [容量...]          默认 1000 10000 100000
+ *       ./cache_simulator ttl [容量...]           默认 1000 10000 100000
+ *       ./cache_simulator file <路径> [容量...]   默认 1000 10000 100000
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "cache/flat_lru_cache.h"
+#include "cache/lfu_cache.h"
+#include "cache/lru_cache.h"
+#include "cache/multi_level_cache.h"
+#include "cache/policy_cache.h"
+#include "cache/sharded_lru_cache.h"
+#include "cache/tinylfu_cache.h"
+#include "cache/ttl_cache.h"
+#include "cache/workload.h"
+
+using namespace std;
+using namespace std::chrono;
+
+// ==================== 1. 值与过期 ====================
+
+// 缓存的值是过期时刻（steady_clock 的纳秒数），不过期为 NEVER
+typedef int64_t Stamp;
+const Stamp NEVER = INT64_MAX;
+const int MULTI_THREADS = 4;
+
+Stamp nowStamp() {
+    return duration_cast<nanoseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+int ttlOf(const Workload& w, int key) {
+    return w.ttlMs.empty() ? 0 : w.ttlMs[key];
+}
+
+Stamp expiryOf(const Workload& w, int key, Stamp now) {
+    int ttl = ttlOf(w, key);
+    return ttl == 0 ? NEVER : now + (Stamp)ttl * 1000000;
+}
+
+typedef TTLCache<int, Stamp> SimTTLCache;
+typedef MultiLevelCache<int, Stamp> SimMultiLevelCache;
+typedef ShardedLRUCache<int, Stamp> SimShardedCache;
+
+// 可以直接被多个线程共用的缓存
+template<typename Cache> struct IsConcurrent : false_type {};
+template<> struct IsConcurrent<SimTTLCache> : true_type {};
+template<> struct IsConcurrent<SimMultiLevelCache> : true_type {};
+template<> struct IsConcurrent<SimShardedCache> : true_type {};
+
+// ==================== 2. 统一的读写接口 ====================
+
+template<typename Cache>
+bool lookup(Cache& cache, int key, Stamp& value) {
+    return cache.tryGet(key, value);
+}
+
+// 未命中时 get() 会等待 loader 生成值，总是返回 true
+bool lookup(SimMultiLevelCache& cache, int key, Stamp& value) {
+    value = cache.get(key);
+    return true;
+}
+
+template<typename Cache>
+void store(Cache& cache, int key, Stamp value, int) {
+    cache.put(key, value);
+}
+
+// TTL 为 0 时用构造时的默认 TTL（不过期）
+void store(SimTTLCache& cache, int key, Stamp value, int ttlMs) {
+    cache.put(key, value, milliseconds(ttlMs));
+}
+
+// 缓存层面的命中数：一般就是 lookup 返回 true 的次数
+template<typename Cache>
+uint64_t cacheHits(Cache&, uint64_t found) {
+    return found;
+}
+
+uint64_t cacheHits(SimMultiLevelCache& cache, uint64_t) {
+    return cache.stats().hits;
+}
+
+// 非线程安全的缓存在多线程回放时加一把锁
+template<typename Cache>
+class LockedCache {
+private:
+    Cache& cache;
+    mutex mtx;
+
+public:
+    explicit LockedCache(Cache& c) : cache(c) {}
+
+    bool tryGet(int key, Stamp& value) {
+        lock_guard<mutex> lock(mtx);
+        return cache.tryGet(key, value);
+    }
+
+    void put(int key, Stamp value) {
+        lock_guard<mutex> lock(mtx);
+        cache.put(key, value);
+    }
+};
+
+// 按容量新建缓存；构造参数不同的缓存单独特化
+template<typename Cache>
+Cache* newCache(size_t cap, const Workload&) {
+    return new Cache(cap);
+}
+
+template<>
+SimTTLCache* newCache<SimTTLCache>(size_t cap, const Workload&) {
+    return new SimTTLCache(hours(24), 8, cap);
+}
+
+// L1 为容量的 1/10，L2 为容量
+template<>
+SimMultiLevelCache* newCache<SimMultiLevelCache>(size_t cap, const Workload& w) {
+    return new SimMultiLevelCache(max((size_t)1, cap / 10), cap,
+                                  [&w](const int& key) { return expiryOf(w, key, nowStamp()); });
+}
+
+// ==================== 3. 回放 ====================
+
+struct SimResult {
+    double hitRatio;
+    double mops;
+};
+
+template<typename Cache>
+SimResult replay(Cache& cache, const Workload& w, int threads) {
+    bool expires = !w.ttlMs.empty();
+    vector<uint64_t> found(threads), stale(threads);
+    auto worker = [&](int t) {
+        uint64_t localFound = 0, localStale = 0;
+        for (size_t i = t; i < w.keys.size(); i += threads) {
+            int key = w.keys[i];
+            Stamp now = expires ? nowStamp() : 0;
+            Stamp value;
+            if (lookup(cache, key, value)) {
+                ++localFound;
+                if (value > now) {
+                    continue;
+                }
+                ++localStale;  // 读到的值已过期，按未命中重新写入
+            }
+            store(cache, key, expiryOf(w, key, now), ttlOf(w, key));
+        }
+        found[t] = localFound;
+        stale[t] = localStale;
+    };
+
+    auto t0 = steady_clock::now();
+    if (threads == 1) {
+        worker(0);
+    } else {
+        vector<thread> pool;
+        for (int t = 0; t < threads; ++t) {
+            pool.emplace_back(worker, t);
+        }
+        for (auto& th : pool) th.join();
+    }
+    double secs = duration<double>(steady_clock::now() - t0).count();
+
+    uint64_t totalFound = 0, totalStale = 0;
+    for (int t = 0; t < threads; ++t) {
+        totalFound += found[t];
+        totalStale += stale[t];
+    }
+    uint64_t hits = cacheHits(cache, totalFound) - totalStale;
+    return SimResult{(double)hits / w.keys.size(), w.keys.size() / secs / 1e6};
+}
+
+template<typename Cache>
+SimResult runShared(Cache& cache, const Workload& w, int threads, true_type) {
+    return replay(cache, w, threads);
+}
+
+template<typename Cache>
+SimResult runShared(Cache& cache, const Workload& w, int threads, false_type) {
+    if (threads == 1) {
+        return replay(cache, w, 1);
+    }
+    LockedCache<Cache> locked(cache);
+    return replay(locked, w, threads);
+}
+
+// 一行结果：单线程与多线程各自的命中率和吞吐量
+template<typename Cache>
+void simulate(const char* name, const Workload& w, size_t cap) {
+    cout << left << setw(18) << name << right << fixed;
+    for (int threads : {1, MULTI_THREADS}) {
+        unique_ptr<Cache> cache(newCache<Cache>(cap, w));
+        SimResult r = runShared(*cache, w, threads, IsConcurrent<Cache>());
+        cout << setw(12) << setprecision(2) << r.hitRatio * 100 << "%"
+             << setw(10) << setprecision(2) << r.mops;
+    }
+    cout << endl;
+}
+
+void simulateAll(const Workload& w, size_t cap) {
+    cout << "\n容量 " << cap << endl;
+    cout << left << setw(18) << "cache" << right << setw(13) << "1T hit" << setw(10) << "Mops/s"
+         << setw(13) << (to_string(MULTI_THREADS) + "T hit") << setw(10) << "Mops/s" << endl;
+    simulate<LRUCache<int, Stamp>>("LRUCache", w, cap);
+    simulate<LFUCache<int, Stamp>>("LFUCache", w, cap);
+    simulate<SimTTLCache>("TTLCache", w, cap);
+    simulate<SimShardedCache>("ShardedLRUCache", w, cap);
+    simulate<SimMultiLevelCache>("MultiLevelCache", w, cap);
+    simulate<FlatLRUCache<int, Stamp>>("FlatLRUCache", w, cap);
+    simulate<PolicyCache<int, Stamp, ClockPolicy>>("CLOCK", w, cap);
+    simulate<PolicyCache<int, Stamp, SievePolicy>>("SIEVE", w, cap);
+    simulate<PolicyCache<int, Stamp, S3FifoPolicy>>("S3-FIFO", w, cap);
+    simulate<PolicyCache<int, Stamp, ARCPolicy>>("ARC", w, cap);
+    simulate<TinyLFUCache<int, Stamp, LRUCache<int, Stamp>>>("W-TinyLFU+LRU", w, cap);
+}
+
+// ==================== 4. 访问序列 ====================
+
+const size_t TRACE_LENGTH = 2000000;
+
+Workload makeWorkload(const string& kind, size_t cap) {
+    int keySpace = (int)cap * 10;
+    Workload w;
+    if (kind == "zipf") {
+        w.name = "zipf";
+        w.keys = makeZipfTrace(keySpace, 0.9, TRACE_LENGTH, 53);
+        w.keySpace = keySpace;
+    } else if (kind == "scan") {
+        w.name = "scan";
+        w.keys = makeScanMixedTrace(keySpace, 0.9, TRACE_LENGTH, 0.3, keySpace * 2, 53);
+        w.keySpace = keySpace * 3;
+    } else {
+        w = makeTTLWorkload((int)cap * 2, 0.9, TRACE_LENGTH, {1, 10, 100}, 53);
+    }
+    return w;
+}
+
+void describe(const Workload& w) {
+    cout << "序列 " << w.name << "：" << w.keys.size() << " 次访问，" << w.keySpace << " 个键";
+    if (!w.ttlMs.empty()) {
+        cout << "，带 TTL";
+    }
+    cout << endl;
+}
+
+// ==================== 主函数 ====================
+
+void usage(const char* prog) {
+    cout << "用法: " << prog << " zipf [容量...] | scan [容量...] | ttl [容量...] | file <路径> [容量...]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    string kind = argv[1];
+    int firstArg = 2;
+    Workload fileTrace;
+    if (kind == "file") {
+        if (argc < 3) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (!loadTraceFile(argv[2], fileTrace) || fileTrace.keys.empty()) {
+            cout << "无法读取轨迹文件: " << argv[2] << endl;
+            return 1;
+        }
+        firstArg = 3;
+    } else if (kind != "zipf" && kind != "scan" && kind != "ttl") {
+        usage(argv[0]);
+        return 1;
+    }
+
+    vector<int> args;
+    for (int i = firstArg; i < argc; ++i) {
+        args.push_back(atoi(argv[i]));
+        if (args.back() <= 0) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (args.empty()) {
+        args = {1000, 10000, 100000};
+    }
+
+    cout << "硬件线程数: " << thread::hardware_concurrency() << endl;
+    if (kind == "file") {
+        describe(fileTrace);
+    }
+    for (int cap : args) {
+        if (kind == "file") {
+            simulateAll(fileTrace, cap);
+        } else {
+            Workload w = makeWorkload(kind, cap);
+            cout << endl;
+            describe(w);
+            simulateAll(w, cap);
+        }
+    }
+    return 0;
+}
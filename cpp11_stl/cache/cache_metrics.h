@@ -0,0 +1,302 @@
+#ifndef CACHE_CACHE_METRICS_H
+#define CACHE_CACHE_METRICS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <utility>
+
+// ==================== 缓存统计 ====================
+
+/*
+ * 各个缓存共用的统计，stats() 返回某一时刻的快照 CacheStats：
+ * - 计数：命中、未命中、插入（新增的项，覆盖写不算）、淘汰（因容量被挤出）、过期（到期后被删除）
+ * - 延迟直方图（可选）：setLatencySampling(n) 后每个线程每 n 次操作计时一次，按 2 的幂分桶；
+ *   默认关闭，关闭时每次操作只多读一个原子变量
+ * - 内存估计：数据结构本身的字节数（节点 + 哈希桶数组），按 libstdc++ 的节点布局估算，
+ *   不含键、值自己在堆上的内容（如 std::string 的字符），需要时用 ByteWeigher 计权重，看 weight
+ *
+ * 计数器按线程分条（stripe）：每个线程固定使用一个条带，条带各占一个缓存行，
+ * 不同线程用 relaxed 原子加更新各自的条带，互不争用；读取时把所有条带加起来。
+ * 线程数超过条带数时几个线程共用一个条带，结果仍然正确，只是多一些争用。
+ * 并发更新时快照中各个计数之间不保证严格一致。
+ */
+
+// 延迟直方图的快照：counts[0] 为 0ns，counts[i] 为 [2^(i-1), 2^i) ns
+struct LatencyHistogram {
+    static const size_t BUCKETS = 40;  // 最后一个桶收纳 2^38 ns（约 4.6 分钟）以上的
+    uint64_t counts[BUCKETS];
+
+    LatencyHistogram() {
+        std::fill(counts, counts + BUCKETS, (uint64_t)0);
+    }
+
+    uint64_t count() const {
+        uint64_t n = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            n += counts[i];
+        }
+        return n;
+    }
+
+    // 第 p 百分位（0~100）所在桶的上界，单位 ns；没有样本时返回 0
+    uint64_t percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+        uint64_t rank = (uint64_t)(p / 100.0 * n + 0.5);
+        if (rank == 0) rank = 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                return (uint64_t)1 << i;
+            }
+        }
+        return (uint64_t)1 << (BUCKETS - 1);
+    }
+
+    LatencyHistogram& operator+=(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            counts[i] += other.counts[i];
+        }
+        return *this;
+    }
+};
+
+struct CacheStats {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t evictions = 0;
+    uint64_t expirations = 0;
+    size_t entries = 0;
+    size_t weight = 0;          // 总权重，未传权重函数时等于 entries
+    size_t estimatedBytes = 0;
+    LatencyHistogram getLatency;  // 读操作的采样延迟
+    LatencyHistogram putLatency;  // 写操作的采样延迟
+
+    double hitRatio() const {
+        uint64_t total = hits + misses;
+        return total == 0 ? 0.0 : (double)hits / total;
+    }
+
+    // 合并另一份快照，例如各个分片的统计
+    CacheStats& operator+=(const CacheStats& other) {
+        hits += other.hits;
+        misses += other.misses;
+        inserts += other.inserts;
+        evictions += other.evictions;
+        expirations += other.expirations;
+        entries += other.entries;
+        weight += other.weight;
+        estimatedBytes += other.estimatedBytes;
+        getLatency += other.getLatency;
+        putLatency += other.putLatency;
+        return *this;
+    }
+
+    void print(const char* name) const {
+        std::cout << name << ": 命中 " << hits << " / 未命中 " << misses
+                  << " (命中率 " << std::fixed << std::setprecision(1) << hitRatio() * 100 << "%)"
+                  << ", 插入 " << inserts << ", 淘汰 " << evictions << ", 过期 " << expirations
+                  << std::endl;
+        std::cout << "  项数 " << entries << ", 权重 " << weight
+                  << ", 估计内存 " << estimatedBytes / 1024.0 << " KB" << std::endl;
+        if (getLatency.count() > 0) {
+            std::cout << "  读延迟 p50 <" << getLatency.percentile(50) << "ns, p99 <"
+                      << getLatency.percentile(99) << "ns (" << getLatency.count() << " 个样本)" << std::endl;
+        }
+        if (putLatency.count() > 0) {
+            std::cout << "  写延迟 p50 <" << putLatency.percentile(50) << "ns, p99 <"
+                      << putLatency.percentile(99) << "ns (" << putLatency.count() << " 个样本)" << std::endl;
+        }
+    }
+};
+
+// 标准库节点容器中单个节点的近似字节数（libstdc++）
+template<typename T>
+size_t listNodeBytes() {
+    return sizeof(T) + 2 * sizeof(void*);  // 前后指针
+}
+
+template<typename Key, typename Mapped>
+size_t hashNodeBytes() {
+    return sizeof(std::pair<const Key, Mapped>) + 2 * sizeof(void*);  // next 指针 + 缓存的哈希值
+}
+
+template<typename Map>
+size_t hashTableBytes(const Map& m) {
+    return m.size() * hashNodeBytes<typename Map::key_type, typename Map::mapped_type>()
+         + m.bucket_count() * sizeof(void*);
+}
+
+// 缓存内部持有的计数器，由各个缓存在操作中更新，stats() 时生成快照
+class CacheMetrics {
+public:
+    enum Counter { HITS, MISSES, INSERTS, EVICTIONS, EXPIRATIONS, COUNTER_COUNT };
+    enum Op { OP_GET, OP_PUT, OP_COUNT };
+
+    static const size_t STRIPES = 16;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    static const size_t CACHE_LINE = 64;
+
+    // 一个条带占一个缓存行：按缓存行对齐，大小补齐到 64 字节
+    struct alignas(CACHE_LINE) Stripe {
+        std::atomic<uint64_t> counters[COUNTER_COUNT];
+    };
+    static_assert(sizeof(Stripe) == CACHE_LINE, "Stripe 应当正好占一个缓存行");
+
+    // C++11 的 new 不保证超过 alignof(max_align_t) 的对齐，多分配一个缓存行，把起始地址对齐后再构造条带
+    std::unique_ptr<char[]> stripeStorage;
+    Stripe* stripes;
+    std::atomic<uint64_t> latency[OP_COUNT][LatencyHistogram::BUCKETS];
+    std::atomic<size_t> sampleEvery;
+
+    // 线程第一次使用时分配条带，之后固定不变
+    static size_t threadStripe() {
+        static std::atomic<size_t> nextThread(0);
+        thread_local size_t stripe = nextThread.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+        return stripe;
+    }
+
+    static size_t& threadOpCount() {
+        thread_local size_t ops = 0;
+        return ops;
+    }
+
+    void recordLatency(Op op, Clock::duration d) {
+        uint64_t ns = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+        size_t bucket = 0;
+        while (ns != 0 && bucket < LatencyHistogram::BUCKETS - 1) {
+            ns >>= 1;
+            ++bucket;
+        }
+        latency[op][bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void allocateStripes() {
+        stripeStorage.reset(new char[STRIPES * sizeof(Stripe) + CACHE_LINE - 1]);
+        uintptr_t p = reinterpret_cast<uintptr_t>(stripeStorage.get());
+        p = (p + CACHE_LINE - 1) & ~(uintptr_t)(CACHE_LINE - 1);
+        stripes = reinterpret_cast<Stripe*>(p);
+        for (size_t s = 0; s < STRIPES; ++s) {
+            new (&stripes[s]) Stripe();
+        }
+    }
+
+    void assign(const CacheMetrics& other) {
+        for (size_t s = 0; s < STRIPES; ++s) {
+            for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+                stripes[s].counters[c].store(
+                    other.stripes[s].counters[c].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            }
+        }
+        for (size_t op = 0; op < OP_COUNT; ++op) {
+            for (size_t b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+                latency[op][b].store(other.latency[op][b].load(std::memory_order_relaxed),
+                                     std::memory_order_relaxed);
+            }
+        }
+        sampleEvery.store(other.sampleEvery.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+public:
+    // 采样计时：构造时决定本次操作是否计时，析构时记录耗时
+    class Timer {
+    private:
+        CacheMetrics* metrics;
+        Op op;
+        Clock::time_point start;
+
+    public:
+        Timer(CacheMetrics& m, Op o) : metrics(nullptr), op(o) {
+            size_t every = m.sampleEvery.load(std::memory_order_relaxed);
+            if (every != 0 && ++threadOpCount() % every == 0) {
+                metrics = &m;
+                start = Clock::now();
+            }
+        }
+        ~Timer() {
+            if (metrics) {
+                metrics->recordLatency(op, Clock::now() - start);
+            }
+        }
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+    };
+
+    CacheMetrics() : sampleEvery(0) {
+        allocateStripes();
+        reset();
+    }
+
+    // 复制时复制当前的计数，缓存本身可以复制或移动
+    CacheMetrics(const CacheMetrics& other) : sampleEvery(0) {
+        allocateStripes();
+        assign(other);
+    }
+
+    CacheMetrics& operator=(const CacheMetrics& other) {
+        if (this != &other) {
+            assign(other);
+        }
+        return *this;
+    }
+
+    void add(Counter c, uint64_t n = 1) {
+        stripes[threadStripe()].counters[c].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭
+    void setLatencySampling(size_t n) {
+        sampleEvery.store(n, std::memory_order_relaxed);
+    }
+
+    // 计数和直方图的快照；entries、weight、estimatedBytes 由缓存自己填
+    CacheStats snapshot() const {
+        uint64_t sum[COUNTER_COUNT] = {};
+        for (size_t s = 0; s < STRIPES; ++s) {
+            for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+                sum[c] += stripes[s].counters[c].load(std::memory_order_relaxed);
+            }
+        }
+        CacheStats st;
+        st.hits = sum[HITS];
+        st.misses = sum[MISSES];
+        st.inserts = sum[INSERTS];
+        st.evictions = sum[EVICTIONS];
+        st.expirations = sum[EXPIRATIONS];
+        for (size_t b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+            st.getLatency.counts[b] = latency[OP_GET][b].load(std::memory_order_relaxed);
+            st.putLatency.counts[b] = latency[OP_PUT][b].load(std::memory_order_relaxed);
+        }
+        return st;
+    }
+
+    // 计数和直方图清零，采样设置不变
+    void reset() {
+        for (size_t s = 0; s < STRIPES; ++s) {
+            for (size_t c = 0; c < COUNTER_COUNT; ++c) {
+                stripes[s].counters[c].store(0, std::memory_order_relaxed);
+            }
+        }
+        for (size_t op = 0; op < OP_COUNT; ++op) {
+            for (size_t b = 0; b < LatencyHistogram::BUCKETS; ++b) {
+                latency[op][b].store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+};
+
+#endif // CACHE_CACHE_METRICS_H
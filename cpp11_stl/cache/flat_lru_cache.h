@@ -0,0 +1,255 @@
+#ifndef CACHE_FLAT_LRU_CACHE_H
+#define CACHE_FLAT_LRU_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "cache_metrics.h"
+
+// ==================== 扁平 LRU 缓存 ====================
+
+/*
+ * LRUCache 每个项要分配一个 list 节点和一个 unordered_map 节点，一次查找要经过
+ * 桶数组 -> 哈希节点 -> 链表节点 几次指针跳转。FlatLRUCache 在构造时一次分配好所有空间：
+ * - 所有项存放在一个连续数组中，最近使用链表用 32 位下标（prev / next）串起来
+ * - 键索引是线性探测的开放寻址表，每个槽 8 字节：32 位哈希标签 + 32 位项下标，
+ *   标签不等就不必读取项本身；负载因子不超过 0.5
+ * - 删除用向后移位（backward shift），不留墓碑
+ * - 未使用的项通过 next 串成空闲链表，运行期间不再分配内存
+ * 每项额外开销为 8 字节链接 + 16~32 字节索引槽（槽数为容量两倍向上取 2 的幂）。
+ * 要求 Key、Value 可默认构造；容量上限 2^31 - 1；非线程安全。
+ * stats() 返回命中、插入、淘汰等计数（见 cache_metrics.h），估计内存就是 memoryBytes()。
+ */
+
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatLRUCache {
+private:
+    static const uint32_t NIL = 0xFFFFFFFFu;
+
+    struct Entry {
+        Key key;
+        Value value;
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    struct Slot {
+        uint32_t tag;    // 混合后哈希值的高 32 位，同时决定起始槽位
+        uint32_t index;  // 项下标，NIL 表示空槽
+    };
+
+    size_t capacity;
+    size_t count = 0;
+    std::vector<Entry> entries;
+    std::vector<Slot> slots;
+    size_t slotMask;
+    uint32_t head = NIL;      // 最近使用
+    uint32_t tail = NIL;      // 最久未使用
+    uint32_t freeList = NIL;
+    Hash hasher;
+    CacheMetrics metrics;
+
+    uint32_t tagOf(const Key& key) const {
+        uint64_t h = (uint64_t)hasher(key) * 0x9E3779B97F4A7C15ULL;
+        return (uint32_t)(h >> 32);
+    }
+
+    // 返回键所在的槽位，不存在时返回应插入的空槽位
+    size_t findSlot(const Key& key, uint32_t tag) const {
+        size_t i = tag & slotMask;
+        while (slots[i].index != NIL) {
+            if (slots[i].tag == tag && entries[slots[i].index].key == key) {
+                break;
+            }
+            i = (i + 1) & slotMask;
+        }
+        return i;
+    }
+
+    // 删除槽位 i，把后面探测链上的槽前移填补空洞
+    void eraseSlot(size_t i) {
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & slotMask;
+            if (slots[j].index == NIL) {
+                break;
+            }
+            size_t home = slots[j].tag & slotMask;
+            // home 不在 (i, j] 区间内（按环形计算）时，j 可以移到 i
+            if (((j - home) & slotMask) >= ((j - i) & slotMask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i].index = NIL;
+    }
+
+    void unlink(uint32_t e) {
+        Entry& x = entries[e];
+        if (x.prev != NIL) entries[x.prev].next = x.next; else head = x.next;
+        if (x.next != NIL) entries[x.next].prev = x.prev; else tail = x.prev;
+    }
+
+    void pushFront(uint32_t e) {
+        Entry& x = entries[e];
+        x.prev = NIL;
+        x.next = head;
+        if (head != NIL) entries[head].prev = e; else tail = e;
+        head = e;
+    }
+
+    void moveToFront(uint32_t e) {
+        if (head != e) {
+            unlink(e);
+            pushFront(e);
+        }
+    }
+
+    void releaseEntry(uint32_t e) {
+        unlink(e);
+        entries[e].key = Key();
+        entries[e].value = Value();
+        entries[e].next = freeList;
+        freeList = e;
+        --count;
+    }
+
+    void initStorage() {
+        for (size_t i = 0; i < capacity; ++i) {
+            entries[i].next = (i + 1 < capacity) ? (uint32_t)(i + 1) : NIL;
+        }
+        freeList = capacity > 0 ? 0 : NIL;
+        for (auto& s : slots) {
+            s.index = NIL;
+        }
+        head = tail = NIL;
+        count = 0;
+    }
+
+public:
+    FlatLRUCache(size_t cap) : capacity(cap), entries(cap) {
+        size_t n = 2;
+        while (n < cap * 2) n <<= 1;
+        slots.resize(n);
+        slotMask = n - 1;
+        initStorage();
+    }
+
+    Value get(const Key& key, const Value& defaultValue = Value()) {
+        Value value;
+        return tryGet(key, value) ? value : defaultValue;
+    }
+
+    bool tryGet(const Key& key, Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        size_t i = findSlot(key, tagOf(key));
+        if (slots[i].index == NIL) {
+            metrics.add(CacheMetrics::MISSES);
+            return false;
+        }
+        metrics.add(CacheMetrics::HITS);
+        uint32_t e = slots[i].index;
+        moveToFront(e);
+        value = entries[e].value;
+        return true;
+    }
+
+    void put(const Key& key, const Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_PUT);
+        if (capacity == 0) {
+            return;
+        }
+        uint32_t tag = tagOf(key);
+        size_t i = findSlot(key, tag);
+        if (slots[i].index != NIL) {
+            uint32_t e = slots[i].index;
+            entries[e].value = value;
+            moveToFront(e);
+            return;
+        }
+
+        if (count >= capacity) {
+            // 淘汰链表尾部；删除它的槽位可能移动其他槽，之后重新找插入位置
+            uint32_t victim = tail;
+            eraseSlot(findSlot(entries[victim].key, tagOf(entries[victim].key)));
+            releaseEntry(victim);
+            metrics.add(CacheMetrics::EVICTIONS);
+            i = findSlot(key, tag);
+        }
+
+        uint32_t e = freeList;
+        freeList = entries[e].next;
+        entries[e].key = key;
+        entries[e].value = value;
+        pushFront(e);
+        ++count;
+        slots[i].tag = tag;
+        slots[i].index = e;
+        metrics.add(CacheMetrics::INSERTS);
+    }
+
+    bool contains(const Key& key) const {
+        return slots[findSlot(key, tagOf(key))].index != NIL;
+    }
+
+    void remove(const Key& key) {
+        size_t i = findSlot(key, tagOf(key));
+        if (slots[i].index == NIL) {
+            return;
+        }
+        uint32_t e = slots[i].index;
+        eraseSlot(i);
+        releaseEntry(e);
+    }
+
+    void clear() {
+        for (uint32_t e = head; e != NIL; e = entries[e].next) {
+            entries[e].key = Key();
+            entries[e].value = Value();
+        }
+        initStorage();
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    // 项数组与索引表占用的字节数（不含 Key / Value 自身的堆内存）
+    size_t memoryBytes() const {
+        return entries.capacity() * sizeof(Entry) + slots.capacity() * sizeof(Slot);
+    }
+
+    CacheStats stats() const {
+        CacheStats st = metrics.snapshot();
+        st.entries = count;
+        st.weight = count;
+        st.estimatedBytes = memoryBytes();
+        return st;
+    }
+
+    void resetStats() {
+        metrics.reset();
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭（默认）
+    void setLatencySampling(size_t n) {
+        metrics.setLatencySampling(n);
+    }
+
+    void print() const {
+        std::cout << "Flat LRU Cache (容量: " << capacity << ", 大小: " << size() << ")" << std::endl;
+        std::cout << "  [头部 -> 尾部]:" << std::endl;
+        for (uint32_t e = head; e != NIL; e = entries[e].next) {
+            std::cout << "    " << entries[e].key << " => " << entries[e].value << std::endl;
+        }
+    }
+};
+
+#endif // CACHE_FLAT_LRU_CACHE_H
@@ -0,0 +1,265 @@
+#ifndef CACHE_LFU_CACHE_H
+#define CACHE_LFU_CACHE_H
+
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+
+#include "cache_metrics.h"
+#include "weigher.h"
+
+// ==================== LFU (Least Frequently Used) 缓存 ====================
+
+/*
+ * LFU 原理：
+ * - 跟踪每个项的访问频率
+ * - 容量满时，淘汰访问频率最低的项
+ * - 频率相同时，淘汰最久未访问的（LRU）
+ *
+ * O(1) 实现（频率桶）：
+ * - 频率桶按频率升序串成链表，每个桶内的键按访问先后排列（头部最新）
+ * - 访问一个键时把它从频率 f 的桶 splice 到频率 f+1 的桶头部，桶为空就删掉
+ * - 淘汰时取第一个桶（最低频率）的尾部，不需要遍历，也不需要读时钟
+ *
+ * 老化（可选）：长期运行时早期的热点会因为累积的高频率一直占着缓存。
+ * agingInterval 不为 0 时，每 agingInterval 次访问把所有频率减半（最小为 1），
+ * 减半是 O(n) 的，间隔不小于容量时均摊到每次访问仍是 O(1)。
+ *
+ * 容量默认按项数计；传入权重函数（见 weigher.h）后按总权重计，放不下时按上面的顺序连续淘汰。
+ * stats() 返回命中、插入、淘汰等计数和内存估计（见 cache_metrics.h）。
+ */
+
+template<typename Key, typename Value>
+class LFUCache {
+private:
+    struct Bucket {
+        size_t frequency;
+        std::list<Key> keys;  // 头部最近访问
+
+        Bucket(size_t f) : frequency(f) {}
+    };
+    typedef typename std::list<Bucket>::iterator BucketIter;
+
+    struct CacheItem {
+        Value value;
+        size_t weight;
+        BucketIter bucket;
+        typename std::list<Key>::iterator pos;  // 在 bucket->keys 中的位置
+    };
+
+    size_t capacity;        // 总权重上限，默认每项权重为 1
+    size_t totalWeight = 0;
+    Weigher<Key, Value> weigher;
+    size_t agingInterval;
+    size_t accessCount = 0;
+    std::list<Bucket> buckets;  // 按频率升序
+    std::unordered_map<Key, CacheItem> cache;
+    CacheMetrics metrics;
+
+    // 把一个项移动到频率加一的桶
+    void touch(CacheItem& item) {
+        BucketIter cur = item.bucket;
+        BucketIter next = std::next(cur);
+        if (next == buckets.end() || next->frequency != cur->frequency + 1) {
+            next = buckets.insert(next, Bucket(cur->frequency + 1));
+        }
+        next->keys.splice(next->keys.begin(), cur->keys, item.pos);
+        item.bucket = next;
+        if (cur->keys.empty()) {
+            buckets.erase(cur);
+        }
+        countAccess();
+    }
+
+    void countAccess() {
+        if (agingInterval != 0 && ++accessCount >= agingInterval) {
+            accessCount = 0;
+            age();
+        }
+    }
+
+    size_t weigh(const Key& key, const Value& value) const {
+        return weigher ? weigher(key, value) : 1;
+    }
+
+    void evict() {
+        BucketIter lowest = buckets.begin();
+        auto it = cache.find(lowest->keys.back());
+        totalWeight -= it->second.weight;
+        cache.erase(it);
+        lowest->keys.pop_back();
+        if (lowest->keys.empty()) {
+            buckets.erase(lowest);
+        }
+        metrics.add(CacheMetrics::EVICTIONS);
+    }
+
+public:
+    LFUCache(size_t cap, size_t aging = 0)
+        : capacity(cap), agingInterval(aging) {}
+
+    // 按权重计容量：cap 为总权重上限
+    LFUCache(size_t cap, Weigher<Key, Value> w, size_t aging = 0)
+        : capacity(cap), weigher(w), agingInterval(aging) {}
+
+    Value get(const Key& key, const Value& defaultValue = Value()) {
+        Value value;
+        return tryGet(key, value) ? value : defaultValue;
+    }
+
+    bool tryGet(const Key& key, Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            metrics.add(CacheMetrics::MISSES);
+            return false;
+        }
+        metrics.add(CacheMetrics::HITS);
+
+        touch(it->second);
+        value = it->second.value;
+        return true;
+    }
+
+    // 权重超过容量的项不缓存（已有的旧值也删除）
+    void put(const Key& key, const Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_PUT);
+        size_t weight = weigh(key, value);
+        bool fits = capacity > 0 && weight <= capacity;
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            if (!fits) {
+                remove(key);
+                return;
+            }
+            totalWeight = totalWeight - it->second.weight + weight;
+            it->second.value = value;
+            it->second.weight = weight;
+            touch(it->second);
+            // 变重了就继续淘汰，可能淘汰到这个键自己
+            while (totalWeight > capacity) {
+                evict();
+            }
+            return;
+        }
+
+        if (!fits) {
+            return;
+        }
+        while (totalWeight + weight > capacity) {
+            evict();
+        }
+
+        // 新项频率为 1
+        if (buckets.empty() || buckets.front().frequency != 1) {
+            buckets.emplace_front(1);
+        }
+        BucketIter first = buckets.begin();
+        first->keys.push_front(key);
+        cache[key] = CacheItem{value, weight, first, first->keys.begin()};
+        totalWeight += weight;
+        metrics.add(CacheMetrics::INSERTS);
+        countAccess();
+    }
+
+    bool contains(const Key& key) const {
+        return cache.find(key) != cache.end();
+    }
+
+    void remove(const Key& key) {
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            return;
+        }
+        BucketIter b = it->second.bucket;
+        b->keys.erase(it->second.pos);
+        if (b->keys.empty()) {
+            buckets.erase(b);
+        }
+        totalWeight -= it->second.weight;
+        cache.erase(it);
+    }
+
+    void clear() {
+        cache.clear();
+        buckets.clear();
+        accessCount = 0;
+        totalWeight = 0;
+    }
+
+    // 不存在返回 0
+    size_t frequency(const Key& key) const {
+        auto it = cache.find(key);
+        return it == cache.end() ? 0 : it->second.bucket->frequency;
+    }
+
+    // 所有频率减半（最小为 1），减半后频率相同的桶合并，原频率较高的键排在较新的一侧
+    void age() {
+        for (BucketIter b = buckets.begin(); b != buckets.end();) {
+            b->frequency = b->frequency / 2 == 0 ? 1 : b->frequency / 2;
+            if (b != buckets.begin()) {
+                BucketIter prev = std::prev(b);
+                if (prev->frequency == b->frequency) {
+                    for (auto k = b->keys.begin(); k != b->keys.end(); ++k) {
+                        cache.find(*k)->second.bucket = prev;
+                    }
+                    prev->keys.splice(prev->keys.begin(), b->keys);
+                    b = buckets.erase(b);
+                    continue;
+                }
+            }
+            ++b;
+        }
+    }
+
+    size_t size() const {
+        return cache.size();
+    }
+
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    // 当前总权重（未传权重函数时等于 size()）
+    size_t weight() const {
+        return totalWeight;
+    }
+
+    CacheStats stats() const {
+        CacheStats st = metrics.snapshot();
+        st.entries = cache.size();
+        st.weight = totalWeight;
+        st.estimatedBytes = hashTableBytes(cache) + cache.size() * listNodeBytes<Key>()
+                          + buckets.size() * listNodeBytes<Bucket>();
+        return st;
+    }
+
+    void resetStats() {
+        metrics.reset();
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭（默认）
+    void setLatencySampling(size_t n) {
+        metrics.setLatencySampling(n);
+    }
+
+    void print() const {
+        std::cout << "LFU Cache (容量: " << capacity << ", 大小: " << size();
+        if (weigher) {
+            std::cout << ", 权重: " << totalWeight;
+        }
+        std::cout << ")" << std::endl;
+        std::cout << "  [频率低 -> 高]:" << std::endl;
+        for (const auto& b : buckets) {
+            // 桶内从最久未访问的开始，与淘汰顺序一致
+            for (auto k = b.keys.rbegin(); k != b.keys.rend(); ++k) {
+                std::cout << "    " << *k << " => " << cache.find(*k)->second.value
+                          << " (频率: " << b.frequency << ")" << std::endl;
+            }
+        }
+    }
+};
+
+#endif // CACHE_LFU_CACHE_H
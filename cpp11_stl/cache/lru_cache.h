@@ -0,0 +1,406 @@
+#ifndef CACHE_LRU_CACHE_H
+#define CACHE_LRU_CACHE_H
+
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "cache_metrics.h"
+#include "weigher.h"
+
+// ==================== LRU (Least Recently Used) 缓存 ====================
+
+/*
+ * LRU 原理：
+ * - 最近使用的项放在前面
+ * - 容量满时，淘汰最久未使用的项
+ * - 使用 list 维护访问顺序 + unordered_map 快速查找
+ * - 容量默认按项数计；传入权重函数（见 weigher.h）后按总权重计，例如字节数
+ *
+ * 非线程安全：get() 也会调整链表顺序，并发访问见 sharded_lru_cache.h
+ *
+ * 免拷贝读取：
+ * - find() 只查一次哈希表，返回指向缓存内值的指针，下一次修改缓存前有效
+ * - acquire() 返回固定（pin）住的 Handle，释放前值的引用一直有效：
+ *   固定的项不会被淘汰（淘汰时跳过，全部固定时暂时超出容量，释放后补淘汰）；
+ *   被 remove / put 覆盖 / clear 的固定项从索引中摘下，不计入容量，最后一个 Handle 释放时回收
+ * Handle 必须在缓存销毁或移动之前释放。
+ *
+ * stats() 返回命中、插入、淘汰等计数和内存估计（见 cache_metrics.h），与其他方法一样不能并发调用。
+ * setEvictionListener() 设置淘汰回调，只在因容量淘汰时调用（remove / 覆盖 / clear 不调用），
+ * 调用时项还在缓存中，回调里不要再修改这个缓存。
+ */
+
+template<typename Key, typename Value>
+class LRUCache {
+public:
+    typedef std::function<void(const Key&, const Value&)> EvictionListener;
+
+private:
+    struct Item {
+        Key key;
+        Value value;
+        size_t weight;
+        size_t pins;     // 未释放的 Handle 数
+        bool retired;    // 已从索引中摘下，等待 Handle 释放
+
+        Item(const Key& k, const Value& v, size_t w)
+            : key(k), value(v), weight(w), pins(0), retired(false) {}
+    };
+    typedef typename std::list<Item>::iterator ItemIter;
+
+    size_t capacity;           // 总权重上限，默认每项权重为 1
+    size_t totalWeight = 0;
+    Weigher<Key, Value> weigher;
+    std::list<Item> itemList;  // 维护访问顺序
+    std::unordered_map<Key, ItemIter> itemMap;  // Key -> 迭代器
+    std::list<Item> retiredList;  // 被删除或覆盖但仍被固定的项
+    Value uncached;               // 放不进缓存时 getOrInsert 返回的值
+    CacheMetrics metrics;
+    EvictionListener onEvict;
+
+    size_t weigh(const Key& key, const Value& value) const {
+        return weigher ? weigher(key, value) : 1;
+    }
+
+    bool fits(size_t weight) const {
+        return capacity > 0 && weight <= capacity;
+    }
+
+    // 插入权重为 weight 的新项时第一个被淘汰的键，见 victim()
+    bool victimFor(size_t weight, Key& victimKey) const {
+        if (!fits(weight) || totalWeight + weight <= capacity) {
+            return false;
+        }
+        for (auto it = itemList.rbegin(); it != itemList.rend(); ++it) {
+            if (it->pins == 0) {
+                victimKey = it->key;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 从尾部淘汰一个未固定的项，全部固定时返回 false
+    bool evictOne() {
+        for (auto it = itemList.end(); it != itemList.begin(); ) {
+            --it;
+            if (it->pins == 0) {
+                if (onEvict) {
+                    onEvict(it->key, it->value);
+                }
+                totalWeight -= it->weight;
+                itemMap.erase(it->key);
+                itemList.erase(it);
+                metrics.add(CacheMetrics::EVICTIONS);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // 把项从索引中摘下：固定的项移到 retiredList，否则直接删除
+    void detach(ItemIter it) {
+        totalWeight -= it->weight;
+        if (it->pins > 0) {
+            it->retired = true;
+            retiredList.splice(retiredList.end(), itemList, it);
+        } else {
+            itemList.erase(it);
+        }
+    }
+
+    void unpin(ItemIter it) {
+        if (--it->pins > 0) {
+            return;
+        }
+        if (it->retired) {
+            retiredList.erase(it);
+        }
+        // 固定期间可能超出了容量（淘汰时跳过了固定的项），补上淘汰
+        while (totalWeight > capacity && evictOne()) {}
+    }
+
+    // 插入新键（调用者保证不存在、权重放得下），返回新项
+    ItemIter insertNew(const Key& key, const Value& value, size_t weight) {
+        // 从尾部淘汰，直到放得下
+        while (totalWeight + weight > capacity && evictOne()) {}
+        itemList.emplace_front(key, value, weight);
+        totalWeight += weight;
+        itemMap[key] = itemList.begin();
+        metrics.add(CacheMetrics::INSERTS);
+        return itemList.begin();
+    }
+
+    // 放不进缓存的项：只挂在 retiredList 上，供 Handle 使用
+    ItemIter insertUncached(const Key& key, const Value& value) {
+        retiredList.emplace_back(key, value, 0);
+        ItemIter item = std::prev(retiredList.end());
+        item->retired = true;
+        return item;
+    }
+
+public:
+    // 固定住的缓存项，析构或 release() 时释放；只能移动不能复制
+    class Handle {
+    private:
+        friend class LRUCache;
+        LRUCache* owner = nullptr;
+        ItemIter it;
+
+        Handle(LRUCache* cache, ItemIter item) : owner(cache), it(item) {
+            ++it->pins;
+        }
+
+    public:
+        Handle() {}
+        Handle(Handle&& other) : owner(other.owner), it(other.it) {
+            other.owner = nullptr;
+        }
+        Handle& operator=(Handle&& other) {
+            if (this != &other) {
+                release();
+                owner = other.owner;
+                it = other.it;
+                other.owner = nullptr;
+            }
+            return *this;
+        }
+        Handle(const Handle&) = delete;
+        Handle& operator=(const Handle&) = delete;
+        ~Handle() {
+            release();
+        }
+
+        explicit operator bool() const { return owner != nullptr; }
+        const Key& key() const { return it->key; }
+        const Value& value() const { return it->value; }
+        const Value& operator*() const { return it->value; }
+        const Value* operator->() const { return &it->value; }
+
+        void release() {
+            if (owner) {
+                owner->unpin(it);
+                owner = nullptr;
+            }
+        }
+    };
+
+    LRUCache(size_t cap) : capacity(cap) {}
+
+    // 按权重计容量：cap 为总权重上限
+    LRUCache(size_t cap, Weigher<Key, Value> w) : capacity(cap), weigher(w) {}
+
+    // 获取值，不存在返回默认值
+    Value get(const Key& key, const Value& defaultValue = Value()) {
+        Value value;
+        return tryGet(key, value) ? value : defaultValue;
+    }
+
+    // 获取值，返回是否命中（可以区分"不存在"与"值等于默认值"）
+    bool tryGet(const Key& key, Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        auto it = itemMap.find(key);
+        if (it == itemMap.end()) {
+            metrics.add(CacheMetrics::MISSES);
+            return false;  // 未找到
+        }
+        metrics.add(CacheMetrics::HITS);
+
+        // 找到了，移到链表头部（表示最近使用）
+        itemList.splice(itemList.begin(), itemList, it->second);
+        value = it->second->value;
+        return true;
+    }
+
+    // 命中时返回指向缓存内值的指针（不拷贝），未命中返回 nullptr
+    const Value* find(const Key& key) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        auto it = itemMap.find(key);
+        if (it == itemMap.end()) {
+            metrics.add(CacheMetrics::MISSES);
+            return nullptr;
+        }
+        metrics.add(CacheMetrics::HITS);
+        itemList.splice(itemList.begin(), itemList, it->second);
+        return &it->second->value;
+    }
+
+    // 命中时返回缓存内的值，未命中时用 make() 生成、插入并返回；命中只查一次哈希表。
+    // 返回的引用在下一次修改缓存前有效
+    template<typename Factory>
+    const Value& getOrInsert(const Key& key, Factory make) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        auto it = itemMap.find(key);
+        if (it != itemMap.end()) {
+            metrics.add(CacheMetrics::HITS);
+            itemList.splice(itemList.begin(), itemList, it->second);
+            return it->second->value;
+        }
+        metrics.add(CacheMetrics::MISSES);
+        Value value = make();
+        size_t weight = weigh(key, value);
+        if (!fits(weight)) {
+            uncached = value;  // 不缓存，引用在下一次调用前有效
+            return uncached;
+        }
+        return insertNew(key, value, weight)->value;
+    }
+
+    // 固定住键对应的项，未命中返回空 Handle
+    Handle acquire(const Key& key) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        auto it = itemMap.find(key);
+        if (it == itemMap.end()) {
+            metrics.add(CacheMetrics::MISSES);
+            return Handle();
+        }
+        metrics.add(CacheMetrics::HITS);
+        itemList.splice(itemList.begin(), itemList, it->second);
+        return Handle(this, it->second);
+    }
+
+    // 固定住键对应的项，未命中时先插入 value；放不进缓存时项只在 Handle 释放前有效
+    Handle acquireOrInsert(const Key& key, const Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        auto it = itemMap.find(key);
+        if (it != itemMap.end()) {
+            metrics.add(CacheMetrics::HITS);
+            itemList.splice(itemList.begin(), itemList, it->second);
+            return Handle(this, it->second);
+        }
+        metrics.add(CacheMetrics::MISSES);
+        size_t weight = weigh(key, value);
+        if (!fits(weight)) {
+            return Handle(this, insertUncached(key, value));
+        }
+        return Handle(this, insertNew(key, value, weight));
+    }
+
+    // 设置值；权重超过容量的项不缓存（已有的旧值也删除）
+    void put(const Key& key, const Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_PUT);
+        size_t weight = weigh(key, value);
+        auto it = itemMap.find(key);
+        if (it != itemMap.end()) {
+            if (!fits(weight)) {
+                detach(it->second);
+                itemMap.erase(it);
+                return;
+            }
+            if (it->second->pins == 0) {
+                // 键已存在，更新值和权重并移到头部，变重了就从尾部淘汰
+                totalWeight = totalWeight - it->second->weight + weight;
+                it->second->value = value;
+                it->second->weight = weight;
+                itemList.splice(itemList.begin(), itemList, it->second);
+                while (totalWeight > capacity && evictOne()) {}
+                return;
+            }
+            // 旧值仍被固定，摘下旧项，插入新项
+            detach(it->second);
+            while (totalWeight + weight > capacity && evictOne()) {}
+            itemList.emplace_front(key, value, weight);
+            totalWeight += weight;
+            it->second = itemList.begin();
+            return;
+        }
+
+        if (!fits(weight)) {
+            return;
+        }
+
+        // 添加新项到头部，放不下先淘汰最久未使用的（链表尾部）
+        insertNew(key, value, weight);
+    }
+
+    // 检查键是否存在
+    bool contains(const Key& key) const {
+        return itemMap.find(key) != itemMap.end();
+    }
+
+    // 插入 incoming（值为 value）需要淘汰时，第一个被淘汰的键（最靠近尾部的未固定项）；
+    // 加上它的权重仍放得下、它本身超过容量（不会被缓存）或全部固定时返回 false。
+    // 带权重时一次插入可能淘汰多个项，这里只给出第一个
+    bool victim(const Key& incoming, const Value& value, Key& victimKey) const {
+        return victimFor(weigh(incoming, value), victimKey);
+    }
+
+    // 同上，新项按权重 1 计，只适用于不带权重函数的缓存
+    bool victim(const Key&, Key& victimKey) const {
+        return victimFor(1, victimKey);
+    }
+
+    // 删除键
+    void remove(const Key& key) {
+        auto it = itemMap.find(key);
+        if (it != itemMap.end()) {
+            detach(it->second);
+            itemMap.erase(it);
+        }
+    }
+
+    // 清空缓存（固定的项等 Handle 释放后回收）
+    void clear() {
+        while (!itemList.empty()) {
+            detach(itemList.begin());
+        }
+        itemMap.clear();
+    }
+
+    // 获取当前大小
+    size_t size() const {
+        return itemList.size();
+    }
+
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    // 当前总权重（未传权重函数时等于 size()）
+    size_t weight() const {
+        return totalWeight;
+    }
+
+    // 因容量淘汰一个项之前调用 listener，传入空函数取消
+    void setEvictionListener(EvictionListener listener) {
+        onEvict = listener;
+    }
+
+    CacheStats stats() const {
+        CacheStats st = metrics.snapshot();
+        st.entries = itemList.size();
+        st.weight = totalWeight;
+        st.estimatedBytes = (itemList.size() + retiredList.size()) * listNodeBytes<Item>()
+                          + hashTableBytes(itemMap);
+        return st;
+    }
+
+    void resetStats() {
+        metrics.reset();
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭（默认）
+    void setLatencySampling(size_t n) {
+        metrics.setLatencySampling(n);
+    }
+
+    // 打印缓存内容
+    void print() const {
+        std::cout << "LRU Cache (容量: " << capacity << ", 大小: " << size();
+        if (weigher) {
+            std::cout << ", 权重: " << totalWeight;
+        }
+        std::cout << ")" << std::endl;
+        std::cout << "  [头部 -> 尾部]:" << std::endl;
+        for (const auto& item : itemList) {
+            std::cout << "    " << item.key << " => " << item.value << std::endl;
+        }
+    }
+};
+
+#endif // CACHE_LRU_CACHE_H
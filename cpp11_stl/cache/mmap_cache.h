@@ -0,0 +1,608 @@
+#ifndef CACHE_MMAP_CACHE_H
+#define CACHE_MMAP_CACHE_H
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache_metrics.h"
+
+// ==================== 内存映射持久化缓存 ====================
+
+/*
+ * 存放在内存映射文件中的缓存，可以作为 MultiLevelCache 的 L2：进程重启后数据还在，容量可以超过内存。
+ * 文件布局：
+ * - 头部：两份，每份带序号和校验和，每次修改后写入较旧的那一份；打开时取校验通过且序号最大的一份，
+ *   写到一半崩溃也至少有一份完整的头部
+ * - 索引：固定大小的开放寻址表（线性探测 + 向后移位删除），槽数为最大项数的两倍向上取 2 的幂，
+ *   每个槽记录键的哈希、记录在日志中的位置和 CLOCK 访问位
+ * - 数据：环形日志，记录 = 记录头（魔数、键长、值长、哈希、校验和）+ 键 + 值，只在 head 追加，
+ *   覆盖写也是追加新记录，旧记录成为死记录
+ * 淘汰为 CLOCK：日志尾部就是时钟指针。空间或项数不足时从尾部回收记录，死记录直接跳过，
+ * 访问位为 1 的记录清零后搬到 head（第二次机会），访问位为 0 的记录被淘汰。
+ *
+ * 打开已有文件时逐个检查记录头与索引项，记录校验和、哈希或位置不对的索引项丢弃；
+ * 日志结构本身损坏时清空整个缓存。进程崩溃后映射的页面仍由内核写回，数据不会丢；
+ * 断电时只有 flush() 之前写入的内容可靠，之后的修改可能丢失（已删除的项可能重新出现）。
+ *
+ * 键和值通过 MmapCodec 序列化，内置支持可平凡复制的类型和 std::string。
+ * 要求 Key、Value 可默认构造；非线程安全；同一个文件同一时间只能由一个实例打开。
+ * stats() 的计数只统计本次打开以来的操作，不写入文件。
+ */
+
+template<typename T>
+struct MmapCodec {
+    static_assert(std::is_trivially_copyable<T>::value, "需要为该类型特化 MmapCodec");
+
+    static size_t size(const T&) { return sizeof(T); }
+    static void write(char* dst, const T& v) { std::memcpy(dst, &v, sizeof(T)); }
+    static bool read(const char* src, size_t n, T& v) {
+        if (n != sizeof(T)) return false;
+        std::memcpy(&v, src, sizeof(T));
+        return true;
+    }
+};
+
+template<>
+struct MmapCodec<std::string> {
+    static size_t size(const std::string& s) { return s.size(); }
+    static void write(char* dst, const std::string& s) { std::memcpy(dst, s.data(), s.size()); }
+    static bool read(const char* src, size_t n, std::string& s) {
+        s.assign(src, n);
+        return true;
+    }
+};
+
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class MmapCache {
+private:
+    static const uint64_t FILE_MAGIC = 0x314C43504D4D4143ULL;  // "CACMMPC1"
+    static const uint32_t FILE_VERSION = 1;
+    static const uint32_t RECORD_MAGIC = 0x52454331u;          // "REC1"
+    static const uint32_t PAD_MAGIC = 0x50414431u;             // "PAD1"
+    static const size_t PAGE = 4096;
+    static const size_t HEADER_AREA = PAGE;
+
+    struct FileHeader {
+        uint64_t magic;
+        uint32_t version;
+        uint32_t reserved;
+        uint64_t seq;
+        uint64_t slotCount;
+        uint64_t maxEntries;
+        uint64_t dataBytes;
+        uint64_t head;      // 日志写入位置（逻辑偏移，单调递增）
+        uint64_t tail;      // 最早的记录（逻辑偏移）
+        uint64_t count;
+        uint64_t checksum;  // 前面所有字段的校验和
+    };
+
+    struct Slot {
+        uint64_t hash;    // 0 表示空槽
+        uint64_t offset;  // 记录的逻辑偏移
+        uint32_t ref;     // CLOCK 访问位
+        uint32_t reserved;
+    };
+
+    struct RecordHeader {
+        uint32_t magic;
+        uint32_t keyLen;
+        uint32_t valueLen;
+        uint32_t reserved;
+        uint64_t hash;
+        uint64_t checksum;  // 键和值的校验和
+    };
+
+    std::string path;
+    int fd = -1;
+    char* base = nullptr;
+    size_t mappedBytes = 0;
+
+    FileHeader* headers = nullptr;  // 两份头部
+    int current = 0;                // 当前有效的头部
+    Slot* slots = nullptr;
+    char* data = nullptr;
+
+    size_t slotMask = 0;
+    size_t maxEntries = 0;
+    uint64_t dataBytes = 0;
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    size_t count = 0;
+
+    Hash hasher;
+    std::string keyBuf;           // 当前操作的键的编码
+    std::vector<char> moveBuf;    // 第二次机会搬移记录时的暂存
+    CacheMetrics metrics;
+
+    static uint64_t checksumBytes(const void* p, size_t n, uint64_t h = 0xCBF29CE484222325ULL) {
+        // FNV-1a
+        const unsigned char* s = static_cast<const unsigned char*>(p);
+        for (size_t i = 0; i < n; ++i) {
+            h ^= s[i];
+            h *= 0x100000001B3ULL;
+        }
+        return h;
+    }
+
+    static uint64_t headerChecksum(const FileHeader& h) {
+        return checksumBytes(&h, offsetof(FileHeader, checksum));
+    }
+
+    static size_t align8(size_t n) {
+        return (n + 7) & ~(size_t)7;
+    }
+
+    static size_t roundUp(size_t n, size_t unit) {
+        return (n + unit - 1) / unit * unit;
+    }
+
+    uint64_t hashOf(const Key& key) const {
+        uint64_t h = (uint64_t)hasher(key) * 0x9E3779B97F4A7C15ULL;
+        h ^= h >> 32;
+        return h | 1;  // 0 留给空槽
+    }
+
+    size_t recordSize(const RecordHeader* r) const {
+        return align8(sizeof(RecordHeader) + r->keyLen + r->valueLen);
+    }
+
+    RecordHeader* recordAt(uint64_t offset) const {
+        return reinterpret_cast<RecordHeader*>(data + offset % dataBytes);
+    }
+
+    bool keyMatches(const RecordHeader* r) const {
+        return r->keyLen == keyBuf.size()
+            && std::memcmp(reinterpret_cast<const char*>(r + 1), keyBuf.data(), keyBuf.size()) == 0;
+    }
+
+    void encodeKey(const Key& key) {
+        keyBuf.resize(MmapCodec<Key>::size(key));
+        if (!keyBuf.empty()) {
+            MmapCodec<Key>::write(&keyBuf[0], key);
+        }
+    }
+
+    // 查找 keyBuf 对应的槽位，不存在时返回应插入的空槽位
+    size_t findSlot(uint64_t h) const {
+        size_t i = h & slotMask;
+        while (slots[i].hash != 0) {
+            if (slots[i].hash == h && keyMatches(recordAt(slots[i].offset))) {
+                break;
+            }
+            i = (i + 1) & slotMask;
+        }
+        return i;
+    }
+
+    // 指向 offset 处记录的槽位，没有时返回 SIZE_MAX（死记录）
+    size_t slotOfRecord(uint64_t h, uint64_t offset) const {
+        size_t i = h & slotMask;
+        while (slots[i].hash != 0) {
+            if (slots[i].hash == h && slots[i].offset == offset) {
+                return i;
+            }
+            i = (i + 1) & slotMask;
+        }
+        return SIZE_MAX;
+    }
+
+    void eraseSlot(size_t i) {
+        size_t j = i;
+        while (true) {
+            j = (j + 1) & slotMask;
+            if (slots[j].hash == 0) {
+                break;
+            }
+            size_t home = slots[j].hash & slotMask;
+            if (((j - home) & slotMask) >= ((j - i) & slotMask)) {
+                slots[i] = slots[j];
+                i = j;
+            }
+        }
+        slots[i].hash = 0;
+    }
+
+    void insertSlot(uint64_t h, uint64_t offset, uint32_t ref) {
+        size_t i = h & slotMask;
+        while (slots[i].hash != 0) {
+            i = (i + 1) & slotMask;
+        }
+        slots[i].offset = offset;
+        slots[i].ref = ref;
+        slots[i].hash = h;  // 最后写哈希，槽位才算生效
+    }
+
+    // 在 head 追加 bytes 字节需要的空间（含跳过环尾的部分）
+    uint64_t spaceNeeded(size_t bytes) const {
+        uint64_t remain = dataBytes - head % dataBytes;
+        return bytes <= remain ? bytes : bytes + remain;
+    }
+
+    uint64_t freeSpace() const {
+        return dataBytes - (head - tail);
+    }
+
+    // 在 head 处留出 bytes 字节，环尾放不下时填充到环尾再从头开始；返回记录的逻辑偏移。
+    // 调用者保证空间足够
+    uint64_t reserve(size_t bytes) {
+        uint64_t remain = dataBytes - head % dataBytes;
+        if (bytes > remain) {
+            if (remain >= sizeof(RecordHeader)) {
+                recordAt(head)->magic = PAD_MAGIC;
+            }
+            head += remain;
+        }
+        uint64_t offset = head;
+        head += bytes;
+        return offset;
+    }
+
+    // 回收日志尾部的一条记录：跳过填充和死记录，访问位为 1 的搬到 head，否则淘汰
+    void reclaimOne() {
+        uint64_t remain = dataBytes - tail % dataBytes;
+        if (remain < sizeof(RecordHeader) || recordAt(tail)->magic == PAD_MAGIC) {
+            tail += remain;
+            return;
+        }
+        RecordHeader* r = recordAt(tail);
+        size_t bytes = recordSize(r);
+        size_t i = slotOfRecord(r->hash, tail);
+        if (i == SIZE_MAX) {
+            tail += bytes;
+            return;
+        }
+        if (slots[i].ref) {
+            moveBuf.assign(reinterpret_cast<char*>(r), reinterpret_cast<char*>(r) + bytes);
+            tail += bytes;
+            if (spaceNeeded(bytes) <= freeSpace()) {
+                uint64_t offset = reserve(bytes);
+                std::memcpy(recordAt(offset), moveBuf.data(), bytes);
+                slots[i].offset = offset;
+                slots[i].ref = 0;
+                return;
+            }
+            // 环尾放不下，只能淘汰
+        } else {
+            tail += bytes;
+        }
+        eraseSlot(i);
+        --count;
+        metrics.add(CacheMetrics::EVICTIONS);
+    }
+
+    void commitHeader() {
+        int next = current ^ 1;
+        FileHeader& h = headers[next];
+        h = headers[current];
+        h.magic = FILE_MAGIC;
+        h.version = FILE_VERSION;
+        h.seq = headers[current].seq + 1;
+        h.head = head;
+        h.tail = tail;
+        h.count = count;
+        h.checksum = headerChecksum(h);
+        current = next;
+    }
+
+    void resetStorage() {
+        std::memset(slots, 0, (slotMask + 1) * sizeof(Slot));
+        head = tail = 0;
+        count = 0;
+        commitHeader();
+    }
+
+    void initFresh() {
+        std::memset(headers, 0, 2 * sizeof(FileHeader));
+        FileHeader& h = headers[0];
+        h.magic = FILE_MAGIC;
+        h.version = FILE_VERSION;
+        h.slotCount = slotMask + 1;
+        h.maxEntries = maxEntries;
+        h.dataBytes = dataBytes;
+        h.checksum = headerChecksum(h);
+        current = 0;
+        resetStorage();
+    }
+
+    bool headerValid(const FileHeader& h) const {
+        return h.magic == FILE_MAGIC && h.version == FILE_VERSION && h.checksum == headerChecksum(h)
+            && h.slotCount == slotMask + 1 && h.maxEntries == maxEntries && h.dataBytes == dataBytes
+            && h.tail <= h.head && h.head - h.tail <= dataBytes;
+    }
+
+    // 检查 offset 处是否是一条完整、未损坏的记录
+    bool recordValid(uint64_t offset) const {
+        uint64_t remain = dataBytes - offset % dataBytes;
+        if (remain < sizeof(RecordHeader)) return false;
+        const RecordHeader* r = recordAt(offset);
+        if (r->magic != RECORD_MAGIC) return false;
+        if ((uint64_t)r->keyLen + r->valueLen > remain - sizeof(RecordHeader)) return false;
+        const char* payload = reinterpret_cast<const char*>(r + 1);
+        return r->checksum == checksumBytes(payload, r->keyLen + r->valueLen);
+    }
+
+    // 打开已有文件：选出有效的头部，检查日志结构，重建索引
+    bool recover() {
+        const FileHeader& a = headers[0];
+        const FileHeader& b = headers[1];
+        bool va = headerValid(a), vb = headerValid(b);
+        if (!va && !vb) return false;
+        current = (va && (!vb || a.seq > b.seq)) ? 0 : 1;
+        head = headers[current].head;
+        tail = headers[current].tail;
+
+        // 从 tail 走到 head，记录头必须连续且合法
+        for (uint64_t p = tail; p < head; ) {
+            uint64_t remain = dataBytes - p % dataBytes;
+            if (remain < sizeof(RecordHeader) || recordAt(p)->magic == PAD_MAGIC) {
+                p += remain;
+                continue;
+            }
+            const RecordHeader* r = recordAt(p);
+            if (r->magic != RECORD_MAGIC
+                || (uint64_t)r->keyLen + r->valueLen > remain - sizeof(RecordHeader)) {
+                return false;
+            }
+            p += recordSize(r);
+            if (p > head) return false;
+        }
+
+        // 只保留指向 [tail, head) 内完整记录、哈希与键一致的索引项
+        std::vector<Slot> old(slots, slots + slotMask + 1);
+        std::memset(slots, 0, (slotMask + 1) * sizeof(Slot));
+        count = 0;
+        for (const Slot& s : old) {
+            if (s.hash == 0 || s.offset < tail || s.offset >= head || !recordValid(s.offset)) {
+                continue;
+            }
+            const RecordHeader* r = recordAt(s.offset);
+            Key key;
+            if (r->hash != s.hash
+                || !MmapCodec<Key>::read(reinterpret_cast<const char*>(r + 1), r->keyLen, key)
+                || hashOf(key) != s.hash) {
+                continue;
+            }
+            keyBuf.assign(reinterpret_cast<const char*>(r + 1), r->keyLen);
+            size_t i = findSlot(s.hash);
+            if (slots[i].hash != 0) {
+                // 重复的索引项（删除时的向后移位被打断），保留较新的记录
+                if (slots[i].offset < s.offset) slots[i].offset = s.offset;
+                continue;
+            }
+            if (count >= maxEntries) continue;
+            insertSlot(s.hash, s.offset, 0);
+            ++count;
+        }
+        commitHeader();
+        return true;
+    }
+
+    void openFile(size_t entries, size_t bytes) {
+        maxEntries = entries == 0 ? 1 : entries;
+        size_t n = 2;
+        while (n < maxEntries * 2) n <<= 1;
+        slotMask = n - 1;
+        if (bytes < PAGE) {
+            bytes = PAGE;
+        }
+        dataBytes = roundUp(bytes, 8);
+
+        size_t indexBytes = roundUp(n * sizeof(Slot), PAGE);
+        mappedBytes = HEADER_AREA + indexBytes + roundUp(dataBytes, PAGE);
+
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("open " + path + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("fstat " + path + ": " + std::strerror(err));
+        }
+        bool existing = (size_t)st.st_size == mappedBytes;
+        if (!existing && ::ftruncate(fd, mappedBytes) != 0) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("ftruncate " + path + ": " + std::strerror(err));
+        }
+        void* p = ::mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (p == MAP_FAILED) {
+            int err = errno;
+            ::close(fd);
+            throw std::runtime_error("mmap " + path + ": " + std::strerror(err));
+        }
+        base = static_cast<char*>(p);
+        headers = reinterpret_cast<FileHeader*>(base);
+        slots = reinterpret_cast<Slot*>(base + HEADER_AREA);
+        data = base + HEADER_AREA + indexBytes;
+
+        if (!existing || !recover()) {
+            initFresh();  // 新文件、尺寸不同或日志损坏
+        }
+    }
+
+    void closeFile() {
+        if (base) {
+            ::msync(base, mappedBytes, MS_SYNC);
+            ::munmap(base, mappedBytes);
+            base = nullptr;
+        }
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+public:
+    // 打开或创建 path；maxEntries 为最多缓存的项数，dataBytes 为日志区大小。
+    // 已有文件的尺寸与参数不同时清空重建。打开失败抛出 std::runtime_error
+    MmapCache(const std::string& filePath, size_t maxEntries, size_t dataBytes = 64 << 20)
+        : path(filePath) {
+        openFile(maxEntries, dataBytes);
+    }
+
+    ~MmapCache() {
+        closeFile();
+    }
+
+    MmapCache(const MmapCache&) = delete;
+    MmapCache& operator=(const MmapCache&) = delete;
+
+    MmapCache(MmapCache&& other)
+        : path(std::move(other.path)), fd(other.fd), base(other.base), mappedBytes(other.mappedBytes),
+          headers(other.headers), current(other.current), slots(other.slots), data(other.data),
+          slotMask(other.slotMask), maxEntries(other.maxEntries), dataBytes(other.dataBytes),
+          head(other.head), tail(other.tail), count(other.count), metrics(other.metrics) {
+        other.fd = -1;
+        other.base = nullptr;
+    }
+
+    Value get(const Key& key, const Value& defaultValue = Value()) {
+        Value value;
+        return tryGet(key, value) ? value : defaultValue;
+    }
+
+    bool tryGet(const Key& key, Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        encodeKey(key);
+        size_t i = findSlot(hashOf(key));
+        if (slots[i].hash == 0) {
+            metrics.add(CacheMetrics::MISSES);
+            return false;
+        }
+        const RecordHeader* r = recordAt(slots[i].offset);
+        if (!MmapCodec<Value>::read(reinterpret_cast<const char*>(r + 1) + r->keyLen, r->valueLen, value)) {
+            metrics.add(CacheMetrics::MISSES);
+            return false;
+        }
+        slots[i].ref = 1;
+        metrics.add(CacheMetrics::HITS);
+        return true;
+    }
+
+    // 超过日志区一半大小的项不缓存
+    void put(const Key& key, const Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_PUT);
+        encodeKey(key);
+        uint64_t h = hashOf(key);
+        size_t valueLen = MmapCodec<Value>::size(value);
+        size_t bytes = align8(sizeof(RecordHeader) + keyBuf.size() + valueLen);
+
+        size_t i = findSlot(h);
+        bool existed = slots[i].hash != 0;
+        if (existed) {
+            eraseSlot(i);  // 旧记录成为死记录
+            --count;
+        }
+        if (bytes > dataBytes / 2) {
+            commitHeader();
+            return;
+        }
+        while (count >= maxEntries || spaceNeeded(bytes) > freeSpace()) {
+            reclaimOne();
+        }
+
+        // 直接在日志中组装记录，魔数最后写
+        uint64_t offset = reserve(bytes);
+        RecordHeader* r = recordAt(offset);
+        char* payload = reinterpret_cast<char*>(r + 1);
+        std::memcpy(payload, keyBuf.data(), keyBuf.size());
+        if (valueLen > 0) {
+            MmapCodec<Value>::write(payload + keyBuf.size(), value);
+        }
+        r->keyLen = (uint32_t)keyBuf.size();
+        r->valueLen = (uint32_t)valueLen;
+        r->reserved = 0;
+        r->hash = h;
+        r->checksum = checksumBytes(payload, keyBuf.size() + valueLen);
+        r->magic = RECORD_MAGIC;
+
+        insertSlot(h, offset, 0);
+        ++count;
+        if (!existed) {
+            metrics.add(CacheMetrics::INSERTS);
+        }
+        commitHeader();
+    }
+
+    bool contains(const Key& key) {
+        encodeKey(key);
+        return slots[findSlot(hashOf(key))].hash != 0;
+    }
+
+    void remove(const Key& key) {
+        encodeKey(key);
+        size_t i = findSlot(hashOf(key));
+        if (slots[i].hash == 0) {
+            return;
+        }
+        eraseSlot(i);
+        --count;
+        commitHeader();
+    }
+
+    void clear() {
+        resetStorage();
+    }
+
+    // 把映射的页面同步写回磁盘
+    void flush() {
+        ::msync(base, mappedBytes, MS_SYNC);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    size_t getCapacity() const {
+        return maxEntries;
+    }
+
+    // 日志区中已使用的字节数（含死记录）
+    size_t logBytes() const {
+        return head - tail;
+    }
+
+    size_t fileBytes() const {
+        return mappedBytes;
+    }
+
+    // estimatedBytes 为索引表和日志中已使用的部分，它们在映射的文件页中，不占进程堆
+    CacheStats stats() const {
+        CacheStats st = metrics.snapshot();
+        st.entries = count;
+        st.weight = count;
+        st.estimatedBytes = (slotMask + 1) * sizeof(Slot) + (head - tail);
+        return st;
+    }
+
+    void resetStats() {
+        metrics.reset();
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭（默认）
+    void setLatencySampling(size_t n) {
+        metrics.setLatencySampling(n);
+    }
+
+    void print() const {
+        std::cout << "Mmap Cache (" << path << ", 容量: " << maxEntries << ", 大小: " << count
+                  << ", 日志: " << (head - tail) << "/" << dataBytes << " 字节)" << std::endl;
+    }
+};
+
+#endif // CACHE_MMAP_CACHE_H
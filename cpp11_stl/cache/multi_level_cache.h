@@ -0,0 +1,624 @@
+#ifndef CACHE_MULTI_LEVEL_CACHE_H
+#define CACHE_MULTI_LEVEL_CACHE_H
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cache_metrics.h"
+#include "lru_cache.h"
+
+// ==================== 多级缓存 ====================
+
+/*
+ * L1（小而快）-> L2（大而慢）-> loader（数据源）。
+ * L2 的类型由模板参数 L2Cache 决定，默认是 LRUCache；换成 MmapCache 后 L2 的数据在重启后保留，
+ * 容量也可以超过内存。L2Cache 需要提供 tryGet、put 和 stats。
+ * 两级容量默认按项数计，传入权重函数（见 weigher.h）后按总权重计，例如 L1 / L2 各自的字节预算。
+ *
+ * 未命中的加载是单飞（single-flight）的：同一个键同时只有一次 loader 调用，
+ * 其他未命中的线程等待同一个 shared_future，避免冷启动或过期时大量相同的请求同时打到数据源。
+ * - 加载由内部固定数量的加载线程执行，线程数就是 loader 的并发上限
+ * - get() 等待加载结果；getAsync() 立即返回 shared_future，命中时返回已就绪的 future
+ * - loader 抛出的异常传给所有等待者，结果不写入缓存
+ * - 加载期间对同一个键 put 的值优先：等待者拿到 put 的值，加载结果丢弃
+ * loader 中不要再调用同一个缓存的 get()：加载线程全忙时会互相等待。
+ *
+ * get() 返回值的拷贝；值较大时用 getPinned()，返回固定住 L1 中那一项的 Handle，
+ * 持有期间直接读取缓存内的值，该项不会被淘汰。Handle 必须在缓存销毁前释放。
+ * 内部有一把互斥锁保护两级缓存和统计，可以被多个线程同时使用。
+ *
+ * stats() 中命中（L1 或 L2）、未命中和延迟按整个多级缓存统计，采样的读延迟包含等待加载的时间；
+ * 插入、淘汰和项数取 L2 的（淘汰出 L2 才算离开缓存），内存估计为两级之和。
+ * 各级自己的统计见 l1Stats() / l2Stats()。
+ *
+ * 写入模式（默认只更新两级缓存，不写数据源）：
+ * - 写穿（enableWriteThrough）：put() 先调用 writer 写数据源，成功后再更新缓存；writer 抛出的异常
+ *   原样抛出，缓存不变。多个 put 的写入按顺序进行，数据源与缓存中的最终值一致
+ * - 写回（enableWriteBehind）：put() 只更新缓存并把键记入写缓冲，同一个键的多次写入合并为最后一次；
+ *   后台写回线程在缓冲达到 maxBatch 项或最早的脏项等待了 maxDelay 时，把缓冲分批（每批最多 maxBatch 项）
+ *   交给 writer。同一时间只有一批在写，先写入的值不会覆盖后写入的值
+ * - 写回的值在写完之前一直留在写缓冲中，两级缓存都未命中时先查写缓冲，不会从数据源读到旧值；
+ *   L2 为 LRUCache 时淘汰脏项会立即触发一次写回
+ * - writer 抛出异常时这一批放回写缓冲（不覆盖之后的新值），等 maxDelay 后重试；
+ *   flush() 写出当前所有脏项并等待完成，失败时抛出异常；析构时最后写一次，仍失败则丢弃
+ * 写入模式要在开始使用缓存之前设置，只能设置一次。
+ */
+
+template<typename Key, typename Value,
+         typename L2Cache = LRUCache<Key, Value>,
+         typename Hash = std::hash<Key>>
+class MultiLevelCache {
+public:
+    typedef std::function<Value(const Key&)> Loader;
+    typedef std::vector<std::pair<Key, Value>> Batch;
+    typedef std::function<void(const Batch&)> BatchWriter;
+
+    enum WriteMode { CACHE_ONLY, WRITE_THROUGH, WRITE_BEHIND };
+
+private:
+    // 正在加载的键
+    struct Inflight {
+        std::promise<Value> promise;
+        std::shared_future<Value> future;
+        bool overwritten = false;  // 加载期间被 put 覆盖
+        Value value;               // 覆盖的值
+
+        Inflight() : future(promise.get_future().share()) {}
+    };
+
+    LRUCache<Key, Value> l1Cache;  // 一级缓存（小而快）
+    L2Cache l2Cache;               // 二级缓存（大而慢）
+    Loader loader;                 // 数据加载函数
+
+    mutable std::mutex mtx;
+    std::unordered_map<Key, Inflight, Hash> inflight;
+    std::deque<Key> loadQueue;     // 等待加载线程的键
+    std::condition_variable loadCv;
+    std::vector<std::thread> loaders;
+    bool stopping = false;
+
+    CacheMetrics metrics;
+    size_t l1Hits = 0;
+    size_t loads = 0;      // loader 实际调用次数
+    size_t coalesced = 0;  // 合并到已有加载上的未命中次数
+
+    // 写入数据源
+    typedef std::chrono::steady_clock Clock;
+    WriteMode writeMode = CACHE_ONLY;
+    BatchWriter writer;
+    std::mutex writeThroughMtx;     // 写穿时让写数据源与更新缓存按同一顺序进行
+    std::unordered_map<Key, Value, Hash> dirty;     // 未写出的值，同一个键只留最后一次
+    std::unordered_map<Key, Value, Hash> flushing;  // 正在写的一批
+    Clock::time_point dirtySince;   // 写缓冲从空变为非空的时刻
+    size_t maxBatch = 0;
+    Clock::duration maxDelay = Clock::duration();
+    bool writing = false;           // 有一批正在写
+    bool flushNow = false;          // 不等 maxDelay 立即写
+    bool stoppingWriter = false;
+    std::condition_variable flushCv;
+    std::thread flusher;
+    size_t writes = 0;              // 写回模式下 put 的次数
+    size_t mergedWrites = 0;        // 合并到已有脏项上的次数
+    size_t flushedEntries = 0;
+    size_t flushedBatches = 0;
+    size_t writeErrors = 0;
+
+    static std::shared_future<Value> readyFuture(const Value& value) {
+        std::promise<Value> p;
+        p.set_value(value);
+        return p.get_future().share();
+    }
+
+    // 查两级缓存，命中时写入 value；每级只查一次哈希表；调用者持锁
+    bool lookupLocked(const Key& key, Value& value) {
+        if (const Value* v = l1Cache.find(key)) {
+            l1Hits++;
+            metrics.add(CacheMetrics::HITS);
+            value = *v;
+            return true;
+        }
+        if (l2Cache.tryGet(key, value)) {
+            metrics.add(CacheMetrics::HITS);
+            l1Cache.put(key, value);  // 提升到 L1
+            return true;
+        }
+        if (pendingWriteLocked(key, value)) {
+            metrics.add(CacheMetrics::HITS);
+            l2Cache.put(key, value);
+            l1Cache.put(key, value);
+            return true;
+        }
+        return false;
+    }
+
+    // 已被淘汰但还没写出的值；调用者持锁
+    bool pendingWriteLocked(const Key& key, Value& value) const {
+        auto it = dirty.find(key);
+        if (it == dirty.end()) {
+            it = flushing.find(key);
+            if (it == flushing.end()) {
+                return false;
+            }
+        }
+        value = it->second;
+        return true;
+    }
+
+    // 更新两级缓存，加载中的键以这个值为准；调用者持锁
+    void storeLocked(const Key& key, const Value& value) {
+        l1Cache.put(key, value);
+        l2Cache.put(key, value);
+        auto it = inflight.find(key);
+        if (it != inflight.end()) {
+            it->second.overwritten = true;
+            it->second.value = value;
+        }
+    }
+
+    void markDirtyLocked(const Key& key, const Value& value) {
+        writes++;
+        if (dirty.empty()) {
+            dirtySince = Clock::now();
+            flushCv.notify_one();  // 写回线程开始计时
+        }
+        auto result = dirty.insert(std::make_pair(key, value));
+        if (!result.second) {
+            result.first->second = value;
+            mergedWrites++;
+        }
+        if (dirty.size() >= maxBatch) {
+            flushNow = true;
+            flushCv.notify_one();
+        }
+    }
+
+    // L2 淘汰脏项：不等 maxDelay，立即写回；调用者持锁（在 L2 的 put 内调用）
+    void onL2Evict(const Key& key) {
+        if (dirty.count(key)) {
+            flushNow = true;
+            flushCv.notify_one();
+        }
+    }
+
+    // L2 为 LRUCache 时监听淘汰；其他类型的 L2 靠写缓冲保证读到未写出的值
+    template<typename Cache>
+    void watchL2Evictions(Cache&) {}
+
+    void watchL2Evictions(LRUCache<Key, Value>& cache) {
+        cache.setEvictionListener([this](const Key& key, const Value&) { onL2Evict(key); });
+    }
+
+    // 把写缓冲整个取出，分批交给 writer；调用时必须没有正在写的一批，返回时持锁。
+    // writer 抛出异常时未写出的项放回写缓冲，异常继续抛出
+    void writeDirtyLocked(std::unique_lock<std::mutex>& lock) {
+        flushing.swap(dirty);
+        writing = true;
+        flushNow = false;
+        lock.unlock();
+
+        Batch batch;
+        batch.reserve(std::min(maxBatch, flushing.size()));
+        auto it = flushing.begin();
+        std::exception_ptr error;
+        size_t written = 0, batches = 0;
+        while (it != flushing.end()) {
+            batch.clear();
+            auto end = it;
+            while (end != flushing.end() && batch.size() < maxBatch) {
+                batch.push_back(*end);
+                ++end;
+            }
+            try {
+                writer(batch);
+            } catch (...) {
+                error = std::current_exception();
+                break;
+            }
+            it = end;
+            written += batch.size();
+            batches++;
+        }
+
+        lock.lock();
+        for (; it != flushing.end(); ++it) {
+            dirty.insert(*it);  // 不覆盖写的过程中 put 的新值
+        }
+        if (!dirty.empty()) {
+            dirtySince = Clock::now();
+        }
+        flushing.clear();
+        writing = false;
+        flushedEntries += written;
+        flushedBatches += batches;
+        flushCv.notify_all();
+        if (error) {
+            writeErrors++;
+            std::rethrow_exception(error);
+        }
+    }
+
+    void flusherLoop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            if (writing) {
+                flushCv.wait(lock);  // flush() 正在写
+                continue;
+            }
+            if (dirty.empty()) {
+                if (stoppingWriter) {
+                    return;
+                }
+                flushCv.wait(lock);
+                continue;
+            }
+            if (!stoppingWriter && !flushNow && Clock::now() < dirtySince + maxDelay) {
+                flushCv.wait_until(lock, dirtySince + maxDelay);
+                continue;
+            }
+            try {
+                writeDirtyLocked(lock);
+            } catch (...) {
+                if (stoppingWriter) {
+                    dirty.clear();  // 析构时最后一次也失败，放弃
+                    return;
+                }
+                flushCv.wait_for(lock, maxDelay);  // 等一会儿再重试
+            }
+        }
+    }
+
+    // 未命中：加入已有的加载，或登记新的加载交给加载线程；调用者持锁
+    std::shared_future<Value> joinOrStartLocked(const Key& key) {
+        metrics.add(CacheMetrics::MISSES);
+        auto it = inflight.find(key);
+        if (it != inflight.end()) {
+            coalesced++;
+            return it->second.future;
+        }
+        std::shared_future<Value> f = inflight[key].future;
+        loadQueue.push_back(key);
+        loadCv.notify_one();
+        return f;
+    }
+
+    void loaderLoop() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            loadCv.wait(lock, [this] { return stopping || !loadQueue.empty(); });
+            if (loadQueue.empty()) {
+                return;  // stopping 且队列已清空
+            }
+            Key key = loadQueue.front();
+            loadQueue.pop_front();
+            loads++;
+            lock.unlock();
+
+            Value value;
+            std::exception_ptr error;
+            try {
+                value = loader(key);
+            } catch (...) {
+                error = std::current_exception();
+            }
+
+            lock.lock();
+            auto it = inflight.find(key);
+            std::promise<Value> promise(std::move(it->second.promise));
+            if (it->second.overwritten) {
+                value = it->second.value;
+                error = nullptr;
+            } else if (!error) {
+                l2Cache.put(key, value);
+                l1Cache.put(key, value);
+            }
+            inflight.erase(it);
+            // 先写缓存、撤掉 inflight 再唤醒等待者，之后到来的 get 直接命中
+            lock.unlock();
+            if (error) {
+                promise.set_exception(error);
+            } else {
+                promise.set_value(value);
+            }
+            lock.lock();
+        }
+    }
+
+    // 调用者持锁
+    CacheStats statsLocked() const {
+        CacheStats st = metrics.snapshot();
+        CacheStats l1 = l1Cache.stats();
+        CacheStats l2 = l2Cache.stats();
+        st.inserts = l2.inserts;
+        st.evictions = l2.evictions;
+        st.expirations = l2.expirations;
+        st.entries = l2.entries;
+        st.weight = l2.weight;
+        st.estimatedBytes = l1.estimatedBytes + l2.estimatedBytes;
+        return st;
+    }
+
+    void startLoaders(size_t n) {
+        if (n == 0) {
+            n = 1;
+        }
+        for (size_t i = 0; i < n; ++i) {
+            loaders.emplace_back(&MultiLevelCache::loaderLoop, this);
+        }
+    }
+
+public:
+    // 固定住的 L1 项，析构或 release() 时释放；只能移动不能复制
+    class Handle {
+    private:
+        friend class MultiLevelCache;
+        MultiLevelCache* owner = nullptr;
+        typename LRUCache<Key, Value>::Handle pinned;
+
+        Handle(MultiLevelCache* cache, typename LRUCache<Key, Value>::Handle&& h)
+            : owner(cache), pinned(std::move(h)) {}
+
+    public:
+        Handle() {}
+        Handle(Handle&& other) : owner(other.owner), pinned(std::move(other.pinned)) {
+            other.owner = nullptr;
+        }
+        Handle& operator=(Handle&& other) {
+            if (this != &other) {
+                release();
+                owner = other.owner;
+                pinned = std::move(other.pinned);
+                other.owner = nullptr;
+            }
+            return *this;
+        }
+        ~Handle() {
+            release();
+        }
+
+        explicit operator bool() const { return owner != nullptr; }
+        const Value& value() const { return pinned.value(); }
+        const Value& operator*() const { return pinned.value(); }
+        const Value* operator->() const { return &pinned.value(); }
+
+        // 在缓存的锁内释放 L1 中的固定
+        void release() {
+            if (owner) {
+                std::lock_guard<std::mutex> lock(owner->mtx);
+                pinned.release();
+                owner = nullptr;
+            }
+        }
+    };
+
+    MultiLevelCache(size_t l1Size, size_t l2Size, Loader loadFunc, size_t maxConcurrentLoads = 4)
+        : l1Cache(l1Size), l2Cache(l2Size), loader(loadFunc) {
+        startLoaders(maxConcurrentLoads);
+    }
+
+    // 按权重计容量：l1Budget / l2Budget 为两级各自的总权重上限（L2 为默认的 LRUCache 时）
+    MultiLevelCache(size_t l1Budget, size_t l2Budget, Weigher<Key, Value> weigher,
+                    Loader loadFunc, size_t maxConcurrentLoads = 4)
+        : l1Cache(l1Budget, weigher), l2Cache(l2Budget, weigher), loader(loadFunc) {
+        startLoaders(maxConcurrentLoads);
+    }
+
+    // 使用已经构造好的 L2，例如 MmapCache
+    MultiLevelCache(size_t l1Size, L2Cache&& l2, Loader loadFunc, size_t maxConcurrentLoads = 4)
+        : l1Cache(l1Size), l2Cache(std::move(l2)), loader(loadFunc) {
+        startLoaders(maxConcurrentLoads);
+    }
+
+    // 已登记的加载全部完成、写缓冲写出后才返回
+    ~MultiLevelCache() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stopping = true;
+            stoppingWriter = true;
+        }
+        loadCv.notify_all();
+        flushCv.notify_all();
+        for (auto& t : loaders) {
+            t.join();
+        }
+        if (flusher.joinable()) {
+            flusher.join();
+        }
+    }
+
+    MultiLevelCache(const MultiLevelCache&) = delete;
+    MultiLevelCache& operator=(const MultiLevelCache&) = delete;
+
+    // 未命中时等待加载完成；loader 抛出的异常原样抛出
+    Value get(const Key& key) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        std::shared_future<Value> f;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            Value value;
+            if (lookupLocked(key, value)) {
+                return value;
+            }
+            f = joinOrStartLocked(key);
+        }
+        return f.get();
+    }
+
+    // 同 get()，但不拷贝值：返回固定住 L1 中该项的 Handle。
+    // L2 命中或加载完成后值先放入 L1 再固定；L1 容量为 0 时值只在 Handle 中
+    Handle getPinned(const Key& key) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        std::unique_lock<std::mutex> lock(mtx);
+        typename LRUCache<Key, Value>::Handle h = l1Cache.acquire(key);
+        if (h) {
+            l1Hits++;
+            metrics.add(CacheMetrics::HITS);
+            return Handle(this, std::move(h));
+        }
+        Value value;
+        if (l2Cache.tryGet(key, value)) {
+            metrics.add(CacheMetrics::HITS);
+            return Handle(this, l1Cache.acquireOrInsert(key, value));
+        }
+        if (pendingWriteLocked(key, value)) {
+            metrics.add(CacheMetrics::HITS);
+            l2Cache.put(key, value);
+            return Handle(this, l1Cache.acquireOrInsert(key, value));
+        }
+        std::shared_future<Value> f = joinOrStartLocked(key);
+        lock.unlock();
+        const Value& loaded = f.get();
+        lock.lock();
+        // 加载结果已写入 L1，除非这期间又被淘汰
+        return Handle(this, l1Cache.acquireOrInsert(key, loaded));
+    }
+
+    std::shared_future<Value> getAsync(const Key& key) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        std::lock_guard<std::mutex> lock(mtx);
+        Value value;
+        if (lookupLocked(key, value)) {
+            return readyFuture(value);
+        }
+        return joinOrStartLocked(key);
+    }
+
+    // 按写入模式更新缓存并写数据源（或记入写缓冲）；写穿时 writer 的异常原样抛出
+    void put(const Key& key, const Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_PUT);
+        if (writeMode == WRITE_THROUGH) {
+            std::lock_guard<std::mutex> order(writeThroughMtx);
+            writer(Batch(1, std::make_pair(key, value)));
+            std::lock_guard<std::mutex> lock(mtx);
+            storeLocked(key, value);
+            writes++;
+            flushedEntries++;
+            flushedBatches++;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mtx);
+        storeLocked(key, value);
+        if (writeMode == WRITE_BEHIND) {
+            markDirtyLocked(key, value);
+        }
+    }
+
+    // 写穿：每次 put 先用只含一项的批次调用 writer
+    void enableWriteThrough(BatchWriter batchWriter) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (writeMode != CACHE_ONLY) {
+            return;
+        }
+        writer = batchWriter;
+        writeMode = WRITE_THROUGH;
+    }
+
+    // 写回：缓冲达到 batchSize 项或最早的脏项等待了 delay 时写出
+    void enableWriteBehind(BatchWriter batchWriter, size_t batchSize = 256,
+                           std::chrono::milliseconds delay = std::chrono::milliseconds(100)) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (writeMode != CACHE_ONLY) {
+            return;
+        }
+        writer = batchWriter;
+        maxBatch = batchSize == 0 ? 1 : batchSize;
+        maxDelay = delay;
+        writeMode = WRITE_BEHIND;
+        watchL2Evictions(l2Cache);
+        flusher = std::thread(&MultiLevelCache::flusherLoop, this);
+    }
+
+    // 写出当前所有脏项，返回时已写入数据源；writer 抛出的异常原样抛出（未写出的项留在写缓冲中）
+    void flush() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (writing) {
+            flushCv.wait(lock);
+        }
+        if (!dirty.empty()) {
+            writeDirtyLocked(lock);
+        }
+    }
+
+    // 还没写入数据源的键数
+    size_t pendingWrites() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return dirty.size() + flushing.size();
+    }
+
+    // 正在加载的键数
+    size_t pendingLoads() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return inflight.size();
+    }
+
+    size_t loaderCalls() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return loads;
+    }
+
+    CacheStats stats() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return statsLocked();
+    }
+
+    CacheStats l1Stats() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return l1Cache.stats();
+    }
+
+    CacheStats l2Stats() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return l2Cache.stats();
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭（默认）
+    void setLatencySampling(size_t n) {
+        metrics.setLatencySampling(n);
+    }
+
+    void printStats() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        CacheStats st = statsLocked();
+        size_t total = st.hits + st.misses;
+        size_t l2Hits = st.hits - l1Hits;
+        if (total == 0 && writes == 0) {
+            std::cout << "没有访问记录" << std::endl;
+            return;
+        }
+
+        std::cout << "\n=== 缓存统计 ===" << std::endl;
+        if (total > 0) {
+            std::cout << "总访问: " << total << std::endl;
+            std::cout << "L1 命中: " << l1Hits << " ("
+                      << std::fixed << std::setprecision(1) << (100.0 * l1Hits / total) << "%)" << std::endl;
+            std::cout << "L2 命中: " << l2Hits << " ("
+                      << (100.0 * l2Hits / total) << "%)" << std::endl;
+            std::cout << "未命中: " << st.misses << " ("
+                      << (100.0 * st.misses / total) << "%)" << std::endl;
+            std::cout << "命中率: " << (100.0 * st.hitRatio()) << "%" << std::endl;
+        }
+        std::cout << "加载: " << loads << " 次，合并的未命中: " << coalesced << std::endl;
+        if (writeMode != CACHE_ONLY) {
+            std::cout << "写入: " << writes << " 次，合并 " << mergedWrites << " 次，写出 "
+                      << flushedEntries << " 项 / " << flushedBatches << " 批";
+            if (writeErrors > 0) {
+                std::cout << "，失败 " << writeErrors << " 次";
+            }
+            std::cout << std::endl;
+        }
+    }
+};
+
+#endif // CACHE_MULTI_LEVEL_CACHE_H
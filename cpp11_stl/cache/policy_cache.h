@@ -0,0 +1,649 @@
+#ifndef CACHE_POLICY_CACHE_H
+#define CACHE_POLICY_CACHE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "cache_metrics.h"
+
+// ==================== 策略化缓存 ====================
+
+/*
+ * 存储与淘汰策略分离：
+ * - PolicyCache 负责存储：项放在容量固定的槽位数组中，unordered_map 把键映射到槽位下标
+ * - 淘汰策略只和槽位下标打交道，自己维护需要的元数据（链表、访问位、频率、幽灵队列）
+ * - 策略是模板参数，所有调用在编译期确定，可以内联，热路径上没有虚函数
+ *
+ * 策略需要提供的接口：
+ *   Policy(size_t capacity)
+ *   void onInsert(uint32_t slot, size_t hash)   新项放入 slot，hash 为键的哈希值
+ *   void onAccess(uint32_t slot)                命中
+ *   uint32_t victim(size_t incomingHash)        缓存已满时下一个要淘汰的槽位（incomingHash 为即将插入的键），
+ *                                               不移除；可以推进内部状态（扫描指针、队列间移动），
+ *                                               紧接着的 evict() 必须返回同一个槽位
+ *   uint32_t evict(size_t incomingHash)         选出并移除一个槽位
+ *   void onRemove(uint32_t slot)                项被显式删除
+ *   void clear()
+ *
+ * 已实现的策略：
+ * - LRUPolicy：最近最少使用，命中时移到链表头部
+ * - LFUPolicy：最不经常使用，频率桶实现 O(1)，同频率按 LRU
+ * - ClockPolicy：CLOCK（二次机会），命中只置访问位，指针环形扫描槽位数组
+ * - SievePolicy：SIEVE，FIFO 队列 + 访问位，淘汰指针从旧往新移动，命中只置访问位
+ * - S3FifoPolicy：S3-FIFO，小 FIFO（10%）过滤只访问一次的键，主 FIFO 带 2 位频率，幽灵队列记录被小队列淘汰的键
+ * - ARCPolicy：自适应替换缓存，T1（访问一次）/ T2（访问多次）两个 LRU 及其幽灵队列 B1 / B2，
+ *   根据幽灵命中调整两者的目标比例
+ * 幽灵队列只保存键的哈希值；哈希冲突只会让个别键被误判为"曾经出现过"，不影响正确性。
+ *
+ * PolicyCache 的 stats() 返回命中、插入、淘汰等计数（见 cache_metrics.h）；
+ * 估计内存只含存储核心（槽位数组、空闲槽位、键索引），不含策略自己的元数据。
+ */
+
+// 以槽位下标串起来的双向链表；同一组链接上可以有多条链表，每个槽位同时只在一条链表中
+class SlotLinks {
+public:
+    static const uint32_t NIL = 0xFFFFFFFFu;
+
+    struct List {
+        uint32_t head = NIL;  // 最新
+        uint32_t tail = NIL;  // 最旧
+        size_t size = 0;
+    };
+
+    // 传值而不是引用 NIL，类外不需要再定义这个静态成员
+    explicit SlotLinks(size_t n) : prev(n, uint32_t(NIL)), next(n, uint32_t(NIL)) {}
+
+    void pushFront(List& l, uint32_t s) {
+        prev[s] = NIL;
+        next[s] = l.head;
+        if (l.head != NIL) prev[l.head] = s; else l.tail = s;
+        l.head = s;
+        ++l.size;
+    }
+
+    void remove(List& l, uint32_t s) {
+        if (prev[s] != NIL) next[prev[s]] = next[s]; else l.head = next[s];
+        if (next[s] != NIL) prev[next[s]] = prev[s]; else l.tail = prev[s];
+        --l.size;
+    }
+
+    void moveToFront(List& l, uint32_t s) {
+        if (l.head != s) {
+            remove(l, s);
+            pushFront(l, s);
+        }
+    }
+
+    // 向头部（更新的一侧）方向的相邻槽位
+    uint32_t newer(uint32_t s) const {
+        return prev[s];
+    }
+
+private:
+    std::vector<uint32_t> prev;
+    std::vector<uint32_t> next;
+};
+
+// 只记录键哈希值的 LRU / FIFO 队列，用于幽灵项
+class GhostList {
+private:
+    std::list<size_t> order;  // 头部最新
+    std::unordered_map<size_t, std::list<size_t>::iterator> pos;
+
+public:
+    bool contains(size_t h) const {
+        return pos.find(h) != pos.end();
+    }
+
+    void pushFront(size_t h) {
+        erase(h);
+        order.push_front(h);
+        pos[h] = order.begin();
+    }
+
+    bool erase(size_t h) {
+        auto it = pos.find(h);
+        if (it == pos.end()) {
+            return false;
+        }
+        order.erase(it->second);
+        pos.erase(it);
+        return true;
+    }
+
+    void popBack() {
+        pos.erase(order.back());
+        order.pop_back();
+    }
+
+    size_t size() const {
+        return order.size();
+    }
+
+    void clear() {
+        order.clear();
+        pos.clear();
+    }
+};
+
+// ==================== 淘汰策略 ====================
+
+class LRUPolicy {
+private:
+    SlotLinks links;
+    SlotLinks::List lru;
+
+public:
+    explicit LRUPolicy(size_t capacity) : links(capacity) {}
+
+    void onInsert(uint32_t slot, size_t) { links.pushFront(lru, slot); }
+    void onAccess(uint32_t slot) { links.moveToFront(lru, slot); }
+    void onRemove(uint32_t slot) { links.remove(lru, slot); }
+
+    uint32_t victim(size_t) { return lru.tail; }
+
+    uint32_t evict(size_t) {
+        uint32_t s = lru.tail;
+        links.remove(lru, s);
+        return s;
+    }
+
+    void clear() { lru = SlotLinks::List(); }
+};
+
+class LFUPolicy {
+private:
+    struct Bucket {
+        size_t frequency;
+        std::list<uint32_t> slots;  // 头部最近访问
+
+        Bucket(size_t f) : frequency(f) {}
+    };
+    typedef std::list<Bucket>::iterator BucketIter;
+
+    std::list<Bucket> buckets;  // 按频率升序
+    std::vector<BucketIter> bucketOf;
+    std::vector<std::list<uint32_t>::iterator> posOf;
+
+    void detach(uint32_t slot) {
+        BucketIter b = bucketOf[slot];
+        b->slots.erase(posOf[slot]);
+        if (b->slots.empty()) {
+            buckets.erase(b);
+        }
+    }
+
+public:
+    explicit LFUPolicy(size_t capacity) : bucketOf(capacity), posOf(capacity) {}
+
+    void onInsert(uint32_t slot, size_t) {
+        if (buckets.empty() || buckets.front().frequency != 1) {
+            buckets.emplace_front(1);
+        }
+        buckets.front().slots.push_front(slot);
+        bucketOf[slot] = buckets.begin();
+        posOf[slot] = buckets.front().slots.begin();
+    }
+
+    void onAccess(uint32_t slot) {
+        BucketIter cur = bucketOf[slot];
+        BucketIter next = std::next(cur);
+        if (next == buckets.end() || next->frequency != cur->frequency + 1) {
+            next = buckets.insert(next, Bucket(cur->frequency + 1));
+        }
+        next->slots.splice(next->slots.begin(), cur->slots, posOf[slot]);
+        bucketOf[slot] = next;
+        if (cur->slots.empty()) {
+            buckets.erase(cur);
+        }
+    }
+
+    void onRemove(uint32_t slot) { detach(slot); }
+
+    uint32_t victim(size_t) { return buckets.front().slots.back(); }
+
+    uint32_t evict(size_t) {
+        uint32_t s = buckets.front().slots.back();
+        detach(s);
+        return s;
+    }
+
+    void clear() { buckets.clear(); }
+};
+
+class ClockPolicy {
+private:
+    std::vector<uint8_t> referenced;
+    std::vector<uint8_t> used;
+    size_t hand = 0;
+
+public:
+    explicit ClockPolicy(size_t capacity) : referenced(capacity, 0), used(capacity, 0) {}
+
+    void onInsert(uint32_t slot, size_t) {
+        used[slot] = 1;
+        referenced[slot] = 0;
+    }
+    void onAccess(uint32_t slot) { referenced[slot] = 1; }
+    void onRemove(uint32_t slot) { used[slot] = 0; }
+
+    // 访问位为 1 的清零并跳过（二次机会），指针停在第一个访问位为 0 的项上
+    uint32_t victim(size_t) {
+        while (!used[hand] || referenced[hand]) {
+            referenced[hand] = 0;
+            hand = (hand + 1) % used.size();
+        }
+        return (uint32_t)hand;
+    }
+
+    uint32_t evict(size_t h) {
+        uint32_t s = victim(h);
+        used[s] = 0;
+        hand = (hand + 1) % used.size();
+        return s;
+    }
+
+    void clear() {
+        std::fill(used.begin(), used.end(), 0);
+        hand = 0;
+    }
+};
+
+class SievePolicy {
+private:
+    SlotLinks links;
+    SlotLinks::List queue;      // 新项插在头部，从不移动
+    std::vector<uint8_t> visited;
+    uint32_t hand = SlotLinks::NIL;
+
+public:
+    explicit SievePolicy(size_t capacity) : links(capacity), visited(capacity, 0) {}
+
+    void onInsert(uint32_t slot, size_t) {
+        links.pushFront(queue, slot);
+        visited[slot] = 0;
+    }
+    void onAccess(uint32_t slot) { visited[slot] = 1; }
+
+    void onRemove(uint32_t slot) {
+        if (hand == slot) {
+            hand = links.newer(slot);
+        }
+        links.remove(queue, slot);
+    }
+
+    // 指针从上次停下的位置向新的一侧移动，清掉沿途的访问位，停在第一个未访问的项上
+    uint32_t victim(size_t) {
+        uint32_t s = hand != SlotLinks::NIL ? hand : queue.tail;
+        while (visited[s]) {
+            visited[s] = 0;
+            s = links.newer(s);
+            if (s == SlotLinks::NIL) {
+                s = queue.tail;
+            }
+        }
+        hand = s;
+        return s;
+    }
+
+    uint32_t evict(size_t h) {
+        uint32_t s = victim(h);
+        hand = links.newer(s);
+        links.remove(queue, s);
+        return s;
+    }
+
+    void clear() {
+        queue = SlotLinks::List();
+        hand = SlotLinks::NIL;
+    }
+};
+
+class S3FifoPolicy {
+private:
+    SlotLinks links;
+    SlotLinks::List small;
+    SlotLinks::List main;
+    GhostList ghost;
+    std::vector<uint8_t> freq;     // 0 ~ 3
+    std::vector<uint8_t> inMain;
+    std::vector<size_t> hashes;
+    size_t smallTarget;
+    size_t ghostLimit;
+
+public:
+    explicit S3FifoPolicy(size_t capacity)
+        : links(capacity), freq(capacity, 0), inMain(capacity, 0), hashes(capacity, 0),
+          smallTarget(capacity / 10 == 0 ? 1 : capacity / 10),
+          ghostLimit(capacity - smallTarget == 0 ? 1 : capacity - smallTarget) {}
+
+    // 幽灵队列里有的键直接进入主队列，否则进入小队列
+    void onInsert(uint32_t slot, size_t hash) {
+        hashes[slot] = hash;
+        freq[slot] = 0;
+        if (ghost.erase(hash)) {
+            inMain[slot] = 1;
+            links.pushFront(main, slot);
+        } else {
+            inMain[slot] = 0;
+            links.pushFront(small, slot);
+        }
+    }
+
+    void onAccess(uint32_t slot) {
+        if (freq[slot] < 3) ++freq[slot];
+    }
+
+    void onRemove(uint32_t slot) {
+        links.remove(inMain[slot] ? main : small, slot);
+    }
+
+    uint32_t victim(size_t) {
+        while (true) {
+            if (small.size >= smallTarget || main.size == 0) {
+                // 小队列：访问过不止一次的移入主队列，否则就是淘汰对象
+                uint32_t t = small.tail;
+                if (freq[t] > 1) {
+                    links.remove(small, t);
+                    freq[t] = 0;
+                    inMain[t] = 1;
+                    links.pushFront(main, t);
+                    continue;
+                }
+                return t;
+            }
+            // 主队列：频率不为 0 的减一后重新放回头部，否则就是淘汰对象
+            uint32_t t = main.tail;
+            if (freq[t] > 0) {
+                --freq[t];
+                links.moveToFront(main, t);
+                continue;
+            }
+            return t;
+        }
+    }
+
+    // 从小队列淘汰的键记入幽灵队列
+    uint32_t evict(size_t h) {
+        uint32_t t = victim(h);
+        if (inMain[t]) {
+            links.remove(main, t);
+        } else {
+            links.remove(small, t);
+            ghost.pushFront(hashes[t]);
+            if (ghost.size() > ghostLimit) {
+                ghost.popBack();
+            }
+        }
+        return t;
+    }
+
+    void clear() {
+        small = SlotLinks::List();
+        main = SlotLinks::List();
+        ghost.clear();
+    }
+};
+
+class ARCPolicy {
+private:
+    SlotLinks links;
+    SlotLinks::List t1;            // 只访问过一次
+    SlotLinks::List t2;            // 访问过至少两次
+    GhostList b1;                  // 从 T1 淘汰的键
+    GhostList b2;                  // 从 T2 淘汰的键
+    std::vector<uint8_t> inT2;
+    std::vector<size_t> hashes;
+    size_t capacity;
+    double target = 0;             // T1 的目标大小 p
+    bool adapted = false;          // victim() 已为即将插入的键调整过 p
+    size_t adaptedHash = 0;
+
+    // 幽灵命中：B1 命中说明 T1 太小，B2 命中说明 T2 太小
+    void adapt(size_t h) {
+        if (b1.contains(h)) {
+            double delta = b1.size() >= b2.size() ? 1.0 : (double)b2.size() / b1.size();
+            target = std::min((double)capacity, target + delta);
+        } else if (b2.contains(h)) {
+            double delta = b2.size() >= b1.size() ? 1.0 : (double)b1.size() / b2.size();
+            target = std::max(0.0, target - delta);
+        }
+    }
+
+public:
+    explicit ARCPolicy(size_t cap) : links(cap), inT2(cap, 0), hashes(cap, 0), capacity(cap) {}
+
+    void onInsert(uint32_t slot, size_t hash) {
+        hashes[slot] = hash;
+        if (b1.contains(hash) || b2.contains(hash)) {
+            if (!(adapted && adaptedHash == hash)) {
+                adapt(hash);
+            }
+            b1.erase(hash);
+            b2.erase(hash);
+            inT2[slot] = 1;
+            links.pushFront(t2, slot);
+        } else {
+            // 保持 |T1| + |B1| <= c 且四个队列总长 <= 2c
+            while (t1.size + 1 + b1.size() > capacity && b1.size() > 0) {
+                b1.popBack();
+            }
+            while (t1.size + t2.size + 1 + b1.size() + b2.size() > 2 * capacity && b2.size() > 0) {
+                b2.popBack();
+            }
+            inT2[slot] = 0;
+            links.pushFront(t1, slot);
+        }
+        adapted = false;
+    }
+
+    void onAccess(uint32_t slot) {
+        if (inT2[slot]) {
+            links.moveToFront(t2, slot);
+        } else {
+            links.remove(t1, slot);
+            inT2[slot] = 1;
+            links.pushFront(t2, slot);
+        }
+    }
+
+    void onRemove(uint32_t slot) {
+        links.remove(inT2[slot] ? t2 : t1, slot);
+    }
+
+    // ARC 的 REPLACE：T1 超过目标大小时从 T1 淘汰，否则从 T2 淘汰
+    uint32_t victim(size_t incomingHash) {
+        if (!(adapted && adaptedHash == incomingHash)) {
+            adapt(incomingHash);
+            adapted = true;
+            adaptedHash = incomingHash;
+        }
+        bool inB2 = b2.contains(incomingHash);
+        if (t1.size > 0 && ((double)t1.size > target || (inB2 && (double)t1.size == target) || t2.size == 0)) {
+            return t1.tail;
+        }
+        return t2.tail;
+    }
+
+    // 被淘汰的键进入对应的幽灵队列
+    uint32_t evict(size_t incomingHash) {
+        uint32_t s = victim(incomingHash);
+        if (inT2[s]) {
+            links.remove(t2, s);
+            b2.pushFront(hashes[s]);
+        } else {
+            links.remove(t1, s);
+            b1.pushFront(hashes[s]);
+        }
+        return s;
+    }
+
+    void clear() {
+        t1 = SlotLinks::List();
+        t2 = SlotLinks::List();
+        b1.clear();
+        b2.clear();
+        target = 0;
+        adapted = false;
+    }
+};
+
+// ==================== 存储核心 ====================
+
+template<typename Key, typename Value, typename Policy = LRUPolicy, typename Hash = std::hash<Key>>
+class PolicyCache {
+private:
+    struct Entry {
+        Key key;
+        Value value;
+    };
+
+    size_t capacity;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<Key, uint32_t, Hash> index;
+    Policy policy;
+    CacheMetrics metrics;
+
+    void resetFreeSlots() {
+        freeSlots.clear();
+        for (size_t i = capacity; i > 0; --i) {
+            freeSlots.push_back((uint32_t)(i - 1));
+        }
+    }
+
+public:
+    PolicyCache(size_t cap) : capacity(cap), entries(cap), policy(cap) {
+        index.reserve(cap);
+        resetFreeSlots();
+    }
+
+    Value get(const Key& key, const Value& defaultValue = Value()) {
+        Value value;
+        return tryGet(key, value) ? value : defaultValue;
+    }
+
+    bool tryGet(const Key& key, Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        auto it = index.find(key);
+        if (it == index.end()) {
+            metrics.add(CacheMetrics::MISSES);
+            return false;
+        }
+        metrics.add(CacheMetrics::HITS);
+        policy.onAccess(it->second);
+        value = entries[it->second].value;
+        return true;
+    }
+
+    void put(const Key& key, const Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_PUT);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            entries[it->second].value = value;
+            policy.onAccess(it->second);
+            return;
+        }
+        if (capacity == 0) {
+            return;
+        }
+
+        size_t h = index.hash_function()(key);
+        uint32_t slot;
+        if (freeSlots.empty()) {
+            slot = policy.evict(h);
+            index.erase(entries[slot].key);
+            metrics.add(CacheMetrics::EVICTIONS);
+        } else {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        entries[slot].key = key;
+        entries[slot].value = value;
+        index.emplace(key, slot);
+        policy.onInsert(slot, h);
+        metrics.add(CacheMetrics::INSERTS);
+    }
+
+    bool contains(const Key& key) const {
+        return index.find(key) != index.end();
+    }
+
+    // 缓存已满时，插入 incoming 会淘汰的键；未满时返回 false
+    bool victim(const Key& incoming, Key& victimKey) {
+        if (capacity == 0 || !freeSlots.empty()) {
+            return false;
+        }
+        victimKey = entries[policy.victim(index.hash_function()(incoming))].key;
+        return true;
+    }
+
+    // 与 LRUCache 的接口一致；按项数计容量，值不影响结果
+    bool victim(const Key& incoming, const Value&, Key& victimKey) {
+        return victim(incoming, victimKey);
+    }
+
+    void remove(const Key& key) {
+        auto it = index.find(key);
+        if (it == index.end()) {
+            return;
+        }
+        uint32_t slot = it->second;
+        policy.onRemove(slot);
+        index.erase(it);
+        entries[slot] = Entry();
+        freeSlots.push_back(slot);
+    }
+
+    void clear() {
+        index.clear();
+        policy.clear();
+        for (auto& e : entries) {
+            e = Entry();
+        }
+        resetFreeSlots();
+    }
+
+    size_t size() const {
+        return index.size();
+    }
+
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    CacheStats stats() const {
+        CacheStats st = metrics.snapshot();
+        st.entries = index.size();
+        st.weight = index.size();
+        st.estimatedBytes = entries.capacity() * sizeof(Entry)
+                          + freeSlots.capacity() * sizeof(uint32_t) + hashTableBytes(index);
+        return st;
+    }
+
+    void resetStats() {
+        metrics.reset();
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭（默认）
+    void setLatencySampling(size_t n) {
+        metrics.setLatencySampling(n);
+    }
+
+    // 打印顺序为哈希表顺序，与淘汰顺序无关
+    void print() const {
+        std::cout << "Policy Cache (容量: " << capacity << ", 大小: " << size() << ")" << std::endl;
+        for (const auto& p : index) {
+            std::cout << "    " << p.first << " => " << entries[p.second].value << std::endl;
+        }
+    }
+};
+
+#endif // CACHE_POLICY_CACHE_H
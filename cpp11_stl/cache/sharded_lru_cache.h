@@ -0,0 +1,169 @@
+#ifndef CACHE_SHARDED_LRU_CACHE_H
+#define CACHE_SHARDED_LRU_CACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "cache_metrics.h"
+#include "lru_cache.h"
+
+// ==================== 分片的线程安全 LRU 缓存 ====================
+
+/*
+ * 用一把锁保护整个 LRUCache 会让所有线程串行（get 也要调整链表）。
+ * 分片后：
+ * - 键经哈希映射到 N 个分片之一，每个分片有自己的锁、链表和哈希表，不同分片的访问互不阻塞
+ * - 每个分片独立按 LRU 淘汰，容量为总容量 / N（向上取整），因此是近似的全局 LRU
+ * - 命中、插入、淘汰等计数由各分片的 LRUCache 在锁内按线程分条记录（见 cache_metrics.h），
+ *   stats() 逐个分片加锁取快照再合并；采样的延迟在外层计时，包含等锁的时间
+ * - 分片数取不小于指定值的 2 的幂，按掩码选分片
+ * - 每个分片单独分配，末尾填充一个缓存行，避免相邻分片的锁伪共享
+ * - 传入权重函数时容量按总权重计，同样平均分给各个分片
+ */
+
+template<typename Key, typename Value, typename Hash = std::hash<Key>>
+class ShardedLRUCache {
+private:
+    static const size_t CACHE_LINE = 64;
+
+    struct Shard {
+        std::mutex mtx;
+        LRUCache<Key, Value> cache;
+        char padding[CACHE_LINE];  // 与下一个分片的热点字段隔开
+
+        Shard(size_t cap, const Weigher<Key, Value>& w) : cache(cap, w) {}
+    };
+
+    std::vector<std::unique_ptr<Shard>> shards;
+    size_t shardMask;
+    size_t capacity;
+    Hash hasher;
+    CacheMetrics metrics;  // 只用于延迟采样
+
+    // std::hash 对整数通常是恒等映射，混合一次再取高位，避免键的低位规律导致分片不均
+    Shard& shardFor(const Key& key) const {
+        uint64_t h = (uint64_t)hasher(key) * 0x9E3779B97F4A7C15ULL;
+        return *shards[(size_t)(h >> 32) & shardMask];
+    }
+
+    static size_t roundUpPowerOfTwo(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+public:
+    ShardedLRUCache(size_t cap, size_t shardCount = 16,
+                    Weigher<Key, Value> weigher = Weigher<Key, Value>()) : capacity(cap) {
+        size_t n = roundUpPowerOfTwo(shardCount == 0 ? 1 : shardCount);
+        shardMask = n - 1;
+        size_t perShard = (cap + n - 1) / n;
+        if (perShard == 0) perShard = 1;
+        shards.reserve(n);
+        for (size_t i = 0; i < n; ++i) {
+            shards.emplace_back(new Shard(perShard, weigher));
+        }
+    }
+
+    ShardedLRUCache(const ShardedLRUCache&) = delete;
+    ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+    bool tryGet(const Key& key, Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        Shard& s = shardFor(key);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        return s.cache.tryGet(key, value);
+    }
+
+    Value get(const Key& key, const Value& defaultValue = Value()) {
+        Value value;
+        return tryGet(key, value) ? value : defaultValue;
+    }
+
+    void put(const Key& key, const Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_PUT);
+        Shard& s = shardFor(key);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.cache.put(key, value);
+    }
+
+    bool contains(const Key& key) const {
+        Shard& s = shardFor(key);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        return s.cache.contains(key);
+    }
+
+    void remove(const Key& key) {
+        Shard& s = shardFor(key);
+        std::lock_guard<std::mutex> lock(s.mtx);
+        s.cache.remove(key);
+    }
+
+    void clear() {
+        for (auto& s : shards) {
+            std::lock_guard<std::mutex> lock(s->mtx);
+            s->cache.clear();
+        }
+    }
+
+    // 逐个分片加锁求和，并发修改时只是一个近似值
+    size_t size() const {
+        size_t total = 0;
+        for (auto& s : shards) {
+            std::lock_guard<std::mutex> lock(s->mtx);
+            total += s->cache.size();
+        }
+        return total;
+    }
+
+    // 逐个分片加锁求和，同 size()
+    size_t weight() const {
+        size_t total = 0;
+        for (auto& s : shards) {
+            std::lock_guard<std::mutex> lock(s->mtx);
+            total += s->cache.weight();
+        }
+        return total;
+    }
+
+    size_t getCapacity() const { return capacity; }
+    size_t shardCount() const { return shards.size(); }
+
+    // 单个分片的统计，不含延迟（延迟只在外层统计）
+    CacheStats shardStats(size_t i) const {
+        std::lock_guard<std::mutex> lock(shards[i]->mtx);
+        return shards[i]->cache.stats();
+    }
+
+    // 逐个分片加锁取快照再合并，同 size()
+    CacheStats stats() const {
+        CacheStats total;
+        for (size_t i = 0; i < shards.size(); ++i) {
+            total += shardStats(i);
+        }
+        CacheStats outer = metrics.snapshot();
+        total.getLatency = outer.getLatency;
+        total.putLatency = outer.putLatency;
+        total.estimatedBytes += shards.size() * sizeof(Shard);
+        return total;
+    }
+
+    void resetStats() {
+        for (auto& s : shards) {
+            std::lock_guard<std::mutex> lock(s->mtx);
+            s->cache.resetStats();
+        }
+        metrics.reset();
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭（默认）
+    void setLatencySampling(size_t n) {
+        metrics.setLatencySampling(n);
+    }
+};
+
+#endif // CACHE_SHARDED_LRU_CACHE_H
@@ -0,0 +1,342 @@
+#ifndef CACHE_TINYLFU_CACHE_H
+#define CACHE_TINYLFU_CACHE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cache_metrics.h"
+#include "policy_cache.h"
+#include "weigher.h"
+
+// ==================== W-TinyLFU 准入过滤 ====================
+
+/*
+ * 普通缓存对每个新键都无条件接纳，一次性的扫描会把热点数据挤出去。W-TinyLFU 在缓存前加一层准入：
+ * - 频率草图（count-min sketch）：4 行 4 位计数器，估计每个键近期被访问的次数，
+ *   每记录 10 × 容量 次访问所有计数器减半，让估计值跟上访问模式的变化
+ * - 门卫（doorkeeper）：一个小的布隆过滤器，键第一次出现只记在门卫里，第二次起才进入草图，
+ *   大量只出现一次的键不会占用草图的计数器；草图减半时门卫清空
+ * - 窗口 LRU（容量的 1%）：新键先进入窗口，给突发的新热点积累频率的机会
+ * - 主缓存（其余 99%）：窗口淘汰出来的候选键只有估计频率高于主缓存的淘汰对象时才被接纳，
+ *   否则直接丢弃
+ * 草图和门卫的大小都向上取整到 2 的幂：容量为 2 的幂时草图每项 2 字节、门卫每项 1 字节，
+ * 否则最多接近翻倍（容量 10000 时按 16384 分配，实测共约 4.9 字节/项）。
+ * 访问频率在 get / tryGet 中记录（cache-aside 用法下未命中后的 put 不重复计数）。
+ */
+
+// 4 位计数器的 count-min sketch，带门卫
+class FrequencySketch {
+private:
+    static const int DEPTH = 4;
+
+    std::vector<uint64_t> table;      // 每个 uint64 存 16 个 4 位计数器，DEPTH 行依次排列
+    std::vector<uint64_t> doorkeeper; // 布隆过滤器位图
+    size_t widthMask;                 // 每行计数器数 - 1
+    size_t doorkeeperMask;            // 门卫位数 - 1
+    size_t sampleSize;
+    size_t additions = 0;
+
+    static uint64_t mix(uint64_t x) {
+        // splitmix64 的终结函数，std::hash 对整数是恒等映射，需要先打散
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    static size_t roundUpPowerOfTwo(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    // 第 row 行的计数器下标（双重哈希）
+    size_t counterIndex(uint64_t h, int row) const {
+        uint64_t h2 = (h >> 32) | 1;
+        return row * (widthMask + 1) + ((h + row * h2) & widthMask);
+    }
+
+    unsigned counterAt(size_t i) const {
+        return (unsigned)(table[i >> 4] >> ((i & 15) << 2)) & 0xF;
+    }
+
+    void incrementAt(size_t i) {
+        table[i >> 4] += 1ULL << ((i & 15) << 2);
+    }
+
+    // 门卫用 h 的两段 32 位各取一位
+    bool doorkeeperContains(uint64_t h) const {
+        size_t a = h & doorkeeperMask, b = (h >> 32) & doorkeeperMask;
+        return ((doorkeeper[a >> 6] >> (a & 63)) & 1) && ((doorkeeper[b >> 6] >> (b & 63)) & 1);
+    }
+
+    void doorkeeperAdd(uint64_t h) {
+        size_t a = h & doorkeeperMask, b = (h >> 32) & doorkeeperMask;
+        doorkeeper[a >> 6] |= 1ULL << (a & 63);
+        doorkeeper[b >> 6] |= 1ULL << (b & 63);
+    }
+
+    // 所有计数器减半（每个 4 位计数器右移一位，屏蔽掉从高位移进来的位），门卫清空
+    void reset() {
+        for (auto& w : table) {
+            w = (w >> 1) & 0x7777777777777777ULL;
+        }
+        std::fill(doorkeeper.begin(), doorkeeper.end(), 0);
+        additions /= 2;
+    }
+
+public:
+    explicit FrequencySketch(size_t capacity) {
+        size_t width = roundUpPowerOfTwo(capacity < 16 ? 16 : capacity);
+        widthMask = width - 1;
+        table.assign(DEPTH * width / 16, 0);
+        sampleSize = 10 * (capacity == 0 ? 1 : capacity);
+        size_t bits = roundUpPowerOfTwo(capacity < 64 ? 64 : capacity * 8);
+        doorkeeperMask = bits - 1;
+        doorkeeper.assign(bits / 64, 0);
+    }
+
+    // 记录一次访问；只把值最小的计数器加一（保守更新），计数器饱和于 15
+    void increment(size_t hash) {
+        uint64_t h = mix(hash);
+        if (!doorkeeperContains(h)) {
+            doorkeeperAdd(h);
+        } else {
+            size_t idx[DEPTH];
+            unsigned minCount = 15;
+            for (int r = 0; r < DEPTH; ++r) {
+                idx[r] = counterIndex(h, r);
+                minCount = std::min(minCount, counterAt(idx[r]));
+            }
+            if (minCount < 15) {
+                for (int r = 0; r < DEPTH; ++r) {
+                    if (counterAt(idx[r]) == minCount) {
+                        incrementAt(idx[r]);
+                    }
+                }
+            }
+        }
+        if (++additions >= sampleSize) {
+            reset();
+        }
+    }
+
+    unsigned estimate(size_t hash) const {
+        uint64_t h = mix(hash);
+        unsigned minCount = 15;
+        for (int r = 0; r < DEPTH; ++r) {
+            minCount = std::min(minCount, counterAt(counterIndex(h, r)));
+        }
+        return minCount + (doorkeeperContains(h) ? 1 : 0);
+    }
+
+    size_t memoryBytes() const {
+        return (table.size() + doorkeeper.size()) * sizeof(uint64_t);
+    }
+};
+
+// ==================== W-TinyLFU 缓存 ====================
+
+/*
+ * MainCache 是主缓存的类型，可以是 LRUCache 或任意 PolicyCache，需要提供：
+ *   MainCache(size_t capacity)、tryGet、put、contains、remove、clear、size、getCapacity、stats、resetStats、
+ *   bool victim(const Key& incoming, const Value& value, Key& victimKey)
+ *       插入 incoming 需要淘汰时返回第一个被淘汰的键；带权重的主缓存按 incoming 自己的权重判断是否放得下
+ *
+ * 按权重计容量时用带 weigher 的构造函数，MainCache 还需要提供 MainCache(size_t capacity, Weigher<Key, Value>)
+ * （如 LRUCache）。窗口和主缓存用同一个 weigher，容量都按权重计；草图按预计的项数而不是权重分配。
+ *
+ * stats() 中命中、未命中、插入和延迟按整个缓存统计（插入指新键进入窗口）；
+ * 淘汰包括被准入拒绝而丢弃的候选键和主缓存自己的淘汰；估计内存包括窗口、草图和主缓存。
+ */
+
+template<typename Key, typename Value,
+         typename MainCache = PolicyCache<Key, Value, LRUPolicy>,
+         typename Hash = std::hash<Key>>
+class TinyLFUCache {
+private:
+    struct WindowItem {
+        Key key;
+        Value value;
+        size_t weight;
+
+        WindowItem(const Key& k, const Value& v, size_t w) : key(k), value(v), weight(w) {}
+    };
+
+    size_t capacity;
+    size_t windowCapacity;
+    size_t windowWeight = 0;
+    std::list<WindowItem> window;  // 窗口 LRU，头部最近使用
+    std::unordered_map<Key, typename std::list<WindowItem>::iterator, Hash> windowIndex;
+    Weigher<Key, Value> weigher;
+    MainCache main;
+    FrequencySketch sketch;
+    Hash hasher;
+    size_t admitted = 0;
+    size_t rejected = 0;
+    CacheMetrics metrics;
+
+    static size_t windowCapacityFor(size_t cap, double windowRatio) {
+        return cap == 0 ? 0 : std::max((size_t)1, (size_t)(cap * windowRatio));
+    }
+
+    size_t weigh(const Key& key, const Value& value) const {
+        return weigher ? weigher(key, value) : 1;
+    }
+
+    // 窗口满了，把最久未使用的项作为候选交给主缓存；比主缓存整个容量还重的候选放不进去，直接丢弃
+    void evictWindow() {
+        WindowItem& candidate = window.back();
+        Key victimKey;
+        if (candidate.weight <= main.getCapacity()
+            && (!main.victim(candidate.key, candidate.value, victimKey)
+                || sketch.estimate(hasher(candidate.key)) > sketch.estimate(hasher(victimKey)))) {
+            main.put(candidate.key, candidate.value);
+            ++admitted;
+        } else {
+            ++rejected;
+            metrics.add(CacheMetrics::EVICTIONS);
+        }
+        windowWeight -= candidate.weight;
+        windowIndex.erase(candidate.key);
+        window.pop_back();
+    }
+
+public:
+    TinyLFUCache(size_t cap, double windowRatio = 0.01)
+        : capacity(cap),
+          windowCapacity(windowCapacityFor(cap, windowRatio)),
+          main(cap - windowCapacity),
+          sketch(cap) {}
+
+    // 按权重计容量：cap 是总权重上限，expectedEntries 是预计的项数，用来分配草图
+    TinyLFUCache(size_t cap, Weigher<Key, Value> w, size_t expectedEntries, double windowRatio = 0.01)
+        : capacity(cap),
+          windowCapacity(windowCapacityFor(cap, windowRatio)),
+          weigher(w),
+          main(cap - windowCapacity, w),
+          sketch(expectedEntries) {}
+
+    Value get(const Key& key, const Value& defaultValue = Value()) {
+        Value value;
+        return tryGet(key, value) ? value : defaultValue;
+    }
+
+    bool tryGet(const Key& key, Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        sketch.increment(hasher(key));
+        auto it = windowIndex.find(key);
+        if (it != windowIndex.end()) {
+            window.splice(window.begin(), window, it->second);
+            value = it->second->value;
+            metrics.add(CacheMetrics::HITS);
+            return true;
+        }
+        bool hit = main.tryGet(key, value);
+        metrics.add(hit ? CacheMetrics::HITS : CacheMetrics::MISSES);
+        return hit;
+    }
+
+    void put(const Key& key, const Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_PUT);
+        if (capacity == 0) {
+            return;
+        }
+        size_t weight = weigh(key, value);
+        auto it = windowIndex.find(key);
+        if (it != windowIndex.end()) {
+            windowWeight = windowWeight - it->second->weight + weight;
+            it->second->value = value;
+            it->second->weight = weight;
+            window.splice(window.begin(), window, it->second);
+            return;
+        }
+        if (main.contains(key)) {
+            main.put(key, value);
+            return;
+        }
+
+        // 比整个窗口还重的项也先进入窗口，下次淘汰时再由主缓存决定是否放得下
+        while (!window.empty() && windowWeight + weight > windowCapacity) {
+            evictWindow();
+        }
+        window.emplace_front(key, value, weight);
+        windowIndex[key] = window.begin();
+        windowWeight += weight;
+        metrics.add(CacheMetrics::INSERTS);
+    }
+
+    bool contains(const Key& key) const {
+        return windowIndex.find(key) != windowIndex.end() || main.contains(key);
+    }
+
+    void remove(const Key& key) {
+        auto it = windowIndex.find(key);
+        if (it != windowIndex.end()) {
+            windowWeight -= it->second->weight;
+            window.erase(it->second);
+            windowIndex.erase(it);
+            return;
+        }
+        main.remove(key);
+    }
+
+    void clear() {
+        window.clear();
+        windowIndex.clear();
+        windowWeight = 0;
+        main.clear();
+    }
+
+    size_t size() const {
+        return window.size() + main.size();
+    }
+
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    // 键的估计访问频率
+    unsigned frequency(const Key& key) const {
+        return sketch.estimate(hasher(key));
+    }
+
+    // 窗口淘汰的候选中被主缓存接纳 / 拒绝的次数
+    size_t admittedCount() const { return admitted; }
+    size_t rejectedCount() const { return rejected; }
+
+    size_t sketchBytes() const {
+        return sketch.memoryBytes();
+    }
+
+    CacheStats stats() const {
+        CacheStats mainStats = main.stats();
+        CacheStats st = metrics.snapshot();
+        st.evictions += mainStats.evictions;
+        st.entries = size();
+        st.weight = windowWeight + mainStats.weight;
+        st.estimatedBytes = window.size() * listNodeBytes<WindowItem>()
+                          + hashTableBytes(windowIndex) + sketch.memoryBytes() + mainStats.estimatedBytes;
+        return st;
+    }
+
+    void resetStats() {
+        metrics.reset();
+        main.resetStats();
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭（默认）；只对整个缓存的 tryGet / put 计时
+    void setLatencySampling(size_t n) {
+        metrics.setLatencySampling(n);
+    }
+};
+
+#endif // CACHE_TINYLFU_CACHE_H
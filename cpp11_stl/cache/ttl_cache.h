@@ -0,0 +1,330 @@
+#ifndef CACHE_TTL_CACHE_H
+#define CACHE_TTL_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "cache_metrics.h"
+#include "weigher.h"
+
+// ==================== 带过期的缓存 ====================
+
+/*
+ * 过期时间索引：按 expireTime 排序的最小堆，堆顶是最早过期的项，清理时只看堆顶，不扫描整个表。
+ * - 惰性检查：get / contains 遇到已过期的项直接删除并按未命中处理
+ * - 增量清理：每次操作最多从堆顶清理 reapBudget 个已过期的项，单次操作的开销有上界
+ * - 后台清理（可选）：startReaper() 启动一个线程定期清理，每次持锁最多清理 REAPER_BATCH 个
+ * - 时钟缓存：每次操作只读一次时钟；后台线程运行时由它每个周期更新一次时间戳，
+ *   操作直接读这个时间戳，过期判断的精度为清理周期
+ *
+ * 覆盖写或删除后堆里的旧记录不立即删除，弹出时与表中的 expireTime 对比识别为过时记录；
+ * 堆中的记录数超过有效项的两倍时用有效项重建堆。
+ * 内部有一把互斥锁，可以被多个线程同时使用。size() 包含已过期但尚未清理的项。
+ *
+ * 容量（可选）：默认不限；指定后按项数计，传入权重函数（见 weigher.h）则按总权重计。
+ * 超出容量时从堆顶淘汰最早过期的项，已过期但未清理的项也占容量。
+ *
+ * stats() 返回命中、插入、淘汰、过期等计数和内存估计（见 cache_metrics.h）；
+ * 过期计数包括惰性删除和清理删除的项，采样的延迟包含等锁的时间。
+ */
+
+template<typename Key, typename Value>
+class TTLCache {
+public:
+    typedef std::chrono::steady_clock Clock;
+    typedef Clock::time_point TimePoint;
+
+private:
+    static const size_t REAPER_BATCH = 1024;
+
+    struct CacheItem {
+        Value value;
+        TimePoint expireTime;
+        size_t weight;
+    };
+
+    struct Expiry {
+        TimePoint expireTime;
+        Key key;
+
+        bool operator>(const Expiry& other) const {
+            return expireTime > other.expireTime;
+        }
+    };
+
+    std::unordered_map<Key, CacheItem> cache;
+    std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>> expiries;
+    std::chrono::milliseconds defaultTTL;
+    size_t reapBudget;
+    size_t capacity;          // 总权重上限，SIZE_MAX 表示不限
+    size_t totalWeight = 0;
+    Weigher<Key, Value> weigher;
+    mutable std::mutex mtx;
+    CacheMetrics metrics;
+
+    // 后台清理线程
+    std::thread reaper;
+    std::condition_variable reaperCv;
+    bool stopping = false;
+    std::atomic<bool> clockCached;
+    std::atomic<Clock::rep> cachedNow;  // 缓存的 time_since_epoch().count()
+
+    TimePoint now() const {
+        if (clockCached.load(std::memory_order_relaxed)) {
+            return TimePoint(Clock::duration(cachedNow.load(std::memory_order_relaxed)));
+        }
+        return Clock::now();
+    }
+
+    // 从堆顶清理最多 limit 个已过期的项（过时记录不计入），调用者持锁
+    size_t reapLocked(TimePoint t, size_t limit) {
+        size_t reaped = 0;
+        while (reaped < limit && !expiries.empty() && expiries.top().expireTime <= t) {
+            const Expiry& e = expiries.top();
+            auto it = cache.find(e.key);
+            if (it != cache.end() && it->second.expireTime == e.expireTime) {
+                eraseLocked(it);
+                ++reaped;
+                metrics.add(CacheMetrics::EXPIRATIONS);
+            }
+            expiries.pop();
+        }
+        return reaped;
+    }
+
+    void eraseLocked(typename std::unordered_map<Key, CacheItem>::iterator it) {
+        totalWeight -= it->second.weight;
+        cache.erase(it);
+    }
+
+    // 超出容量时淘汰最早过期的项（不论是否已过期），调用者持锁
+    void evictLocked() {
+        while (totalWeight > capacity && !expiries.empty()) {
+            const Expiry& e = expiries.top();
+            auto it = cache.find(e.key);
+            if (it != cache.end() && it->second.expireTime == e.expireTime) {
+                eraseLocked(it);
+                metrics.add(CacheMetrics::EVICTIONS);
+            }
+            expiries.pop();
+        }
+    }
+
+    void compactLocked() {
+        if (expiries.size() <= 2 * cache.size() + 64) {
+            return;
+        }
+        std::vector<Expiry> live;
+        live.reserve(cache.size());
+        for (const auto& p : cache) {
+            live.push_back(Expiry{p.second.expireTime, p.first});
+        }
+        expiries = decltype(expiries)(std::greater<Expiry>(), std::move(live));
+    }
+
+    void reaperLoop(std::chrono::milliseconds interval) {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (!stopping) {
+            TimePoint t = Clock::now();
+            cachedNow.store(t.time_since_epoch().count(), std::memory_order_relaxed);
+            // 分批清理，批次之间放开锁，不长时间阻塞前台操作
+            while (reapLocked(t, REAPER_BATCH) == REAPER_BATCH) {
+                lock.unlock();
+                lock.lock();
+                if (stopping) return;
+            }
+            reaperCv.wait_for(lock, interval);
+        }
+    }
+
+public:
+    TTLCache(std::chrono::milliseconds ttl = std::chrono::milliseconds(5000), size_t budget = 8)
+        : defaultTTL(ttl), reapBudget(budget), capacity(SIZE_MAX), clockCached(false), cachedNow(0) {}
+
+    // 限制容量：cap 为项数，传入权重函数时为总权重上限
+    TTLCache(std::chrono::milliseconds ttl, size_t budget, size_t cap,
+             Weigher<Key, Value> w = Weigher<Key, Value>())
+        : defaultTTL(ttl), reapBudget(budget), capacity(cap), weigher(w),
+          clockCached(false), cachedNow(0) {}
+
+    ~TTLCache() {
+        stopReaper();
+    }
+
+    TTLCache(const TTLCache&) = delete;
+    TTLCache& operator=(const TTLCache&) = delete;
+
+    void put(const Key& key, const Value& value,
+             std::chrono::milliseconds ttl = std::chrono::milliseconds(0)) {
+        if (ttl == std::chrono::milliseconds(0)) {
+            ttl = defaultTTL;
+        }
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_PUT);
+        std::lock_guard<std::mutex> lock(mtx);
+        TimePoint t = now();
+        reapLocked(t, reapBudget);
+
+        size_t weight = weigher ? weigher(key, value) : 1;
+        auto it = cache.find(key);
+        bool existed = it != cache.end();
+        if (existed) {
+            eraseLocked(it);  // 堆中的旧记录之后作为过时记录弹出
+        }
+        if (capacity == 0 || weight > capacity) {
+            return;  // 放不下的项不缓存
+        }
+        if (!existed) {
+            metrics.add(CacheMetrics::INSERTS);
+        }
+
+        TimePoint expireTime = t + ttl;
+        cache[key] = CacheItem{value, expireTime, weight};
+        totalWeight += weight;
+        expiries.push(Expiry{expireTime, key});
+        evictLocked();
+        compactLocked();
+    }
+
+    Value get(const Key& key, const Value& defaultValue = Value()) {
+        Value value;
+        return tryGet(key, value) ? value : defaultValue;
+    }
+
+    bool tryGet(const Key& key, Value& value) {
+        CacheMetrics::Timer timer(metrics, CacheMetrics::OP_GET);
+        std::lock_guard<std::mutex> lock(mtx);
+        TimePoint t = now();
+        reapLocked(t, reapBudget);
+
+        auto it = cache.find(key);
+        if (it == cache.end()) {
+            metrics.add(CacheMetrics::MISSES);
+            return false;
+        }
+        if (it->second.expireTime <= t) {
+            eraseLocked(it);  // 惰性删除，堆中的记录之后作为过时记录弹出
+            metrics.add(CacheMetrics::EXPIRATIONS);
+            metrics.add(CacheMetrics::MISSES);
+            return false;
+        }
+        metrics.add(CacheMetrics::HITS);
+        value = it->second.value;
+        return true;
+    }
+
+    bool contains(const Key& key) {
+        std::lock_guard<std::mutex> lock(mtx);
+        TimePoint t = now();
+        reapLocked(t, reapBudget);
+        auto it = cache.find(key);
+        return it != cache.end() && it->second.expireTime > t;
+    }
+
+    void remove(const Key& key) {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            eraseLocked(it);
+        }
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mtx);
+        cache.clear();
+        expiries = decltype(expiries)();
+        totalWeight = 0;
+    }
+
+    // 立即清理最多 maxItems 个已过期的项，返回清理的数量
+    size_t reapExpired(size_t maxItems = SIZE_MAX) {
+        std::lock_guard<std::mutex> lock(mtx);
+        return reapLocked(Clock::now(), maxItems);
+    }
+
+    // 每次操作顺带清理的数量上限，0 表示只做惰性检查
+    void setReapBudget(size_t budget) {
+        std::lock_guard<std::mutex> lock(mtx);
+        reapBudget = budget;
+    }
+
+    void startReaper(std::chrono::milliseconds interval = std::chrono::milliseconds(100)) {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (reaper.joinable()) {
+            return;
+        }
+        stopping = false;
+        cachedNow.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        clockCached.store(true, std::memory_order_relaxed);
+        reaper = std::thread(&TTLCache::reaperLoop, this, interval);
+    }
+
+    void stopReaper() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!reaper.joinable()) {
+                return;
+            }
+            stopping = true;
+            clockCached.store(false, std::memory_order_relaxed);
+        }
+        reaperCv.notify_all();
+        reaper.join();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return cache.size();
+    }
+
+    size_t getCapacity() const {
+        return capacity;
+    }
+
+    // 当前总权重（未传权重函数时等于 size()）
+    size_t weight() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return totalWeight;
+    }
+
+    CacheStats stats() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        CacheStats st = metrics.snapshot();
+        st.entries = cache.size();
+        st.weight = totalWeight;
+        st.estimatedBytes = hashTableBytes(cache) + expiries.size() * sizeof(Expiry);
+        return st;
+    }
+
+    void resetStats() {
+        metrics.reset();
+    }
+
+    // 每 n 次操作采样一次延迟，0 表示关闭（默认）
+    void setLatencySampling(size_t n) {
+        metrics.setLatencySampling(n);
+    }
+
+    void print() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        std::cout << "TTL Cache (大小: " << cache.size() << ")" << std::endl;
+        TimePoint t = now();
+        for (const auto& p : cache) {
+            auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+                p.second.expireTime - t).count();
+            std::cout << "    " << p.first << " => " << p.second.value
+                      << " (剩余: " << remaining << "ms)" << std::endl;
+        }
+    }
+};
+
+#endif // CACHE_TTL_CACHE_H
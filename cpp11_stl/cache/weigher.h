@@ -0,0 +1,56 @@
+#ifndef CACHE_WEIGHER_H
+#define CACHE_WEIGHER_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// ==================== 项的权重 ====================
+
+/*
+ * 缓存默认按项数计容量（每项权重为 1）。构造时传入权重函数后，容量就是所有项权重之和的上限，
+ * 例如用 ByteWeigher 按估计的字节数计：
+ * - 插入或覆盖时调用一次权重函数，结果记在项里；删除、淘汰时按记下的权重增量更新总权重，不重新计算
+ * - 插入后总权重超过容量就继续淘汰，直到放得下为止
+ * - 权重超过容量的项不缓存
+ */
+
+template<typename Key, typename Value>
+using Weigher = std::function<size_t(const Key&, const Value&)>;
+
+// 估计对象占用的字节数：对象本身 + 堆上的内容
+template<typename T>
+typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value, size_t>::type
+estimateBytes(const T&) {
+    return sizeof(T);
+}
+
+inline size_t estimateBytes(const std::string& s) {
+    // 短字符串存放在对象内部（libstdc++ 为 15 字节以内），不另外占用堆内存
+    return sizeof(std::string) + (s.capacity() > 15 ? s.capacity() + 1 : 0);
+}
+
+template<typename T>
+size_t estimateBytes(const std::vector<T>& v) {
+    size_t bytes = sizeof(v) + (v.capacity() - v.size()) * sizeof(T);
+    for (const auto& x : v) {
+        bytes += estimateBytes(x);
+    }
+    return bytes;
+}
+
+// 按键和值的估计字节数计权重，perEntryOverhead 为每项的簿记开销（链表节点、哈希节点等）
+template<typename Key, typename Value>
+struct ByteWeigher {
+    size_t perEntryOverhead;
+
+    explicit ByteWeigher(size_t overhead = 0) : perEntryOverhead(overhead) {}
+
+    size_t operator()(const Key& key, const Value& value) const {
+        return estimateBytes(key) + estimateBytes(value) + perEntryOverhead;
+    }
+};
+
+#endif // CACHE_WEIGHER_H
@@ -0,0 +1,150 @@
+#ifndef CACHE_WORKLOAD_H
+#define CACHE_WORKLOAD_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// ==================== 访问序列 ====================
+
+/*
+ * 缓存实测和模拟器用的访问序列（键为 0 起的整数）：
+ * - Zipf：少数热点键占大部分访问
+ * - 混入扫描：Zipf 访问中夹着对冷键的大段顺序扫描，检验淘汰策略是否被扫描冲掉热点
+ * - 短 TTL：Zipf 访问，每个键有自己的存活时间，检验过期带来的未命中
+ * - 轨迹文件：每行一次访问，第一列为键（任意不含空白的字符串），可选的第二列为 TTL（毫秒）
+ */
+
+// 一条访问序列；ttlMs 按键下标给出存活时间，为空表示不过期
+struct Workload {
+    std::string name;
+    std::vector<int> keys;
+    std::vector<int> ttlMs;
+    int keySpace = 0;  // 键的取值范围 [0, keySpace)
+};
+
+/*
+ * Zipf 分布：第 k 热的键被访问的概率正比于 1 / k^s。
+ * 预先计算累积分布，二分查找采样；键按随机排列打散，热点不集中在小整数上。
+ * keySpace <= 0 时返回空序列。
+ */
+inline std::vector<int> makeZipfTrace(int keySpace, double s, size_t length, unsigned seed) {
+    if (keySpace <= 0) {
+        return std::vector<int>();
+    }
+    std::vector<double> cdf(keySpace);
+    double sum = 0;
+    for (int k = 0; k < keySpace; ++k) {
+        sum += 1.0 / std::pow(k + 1.0, s);
+        cdf[k] = sum;
+    }
+
+    std::vector<int> perm(keySpace);
+    for (int k = 0; k < keySpace; ++k) perm[k] = k;
+    std::mt19937 rng(seed);
+    std::shuffle(perm.begin(), perm.end(), rng);
+
+    std::uniform_real_distribution<double> dist(0.0, sum);
+    std::vector<int> trace(length);
+    for (size_t i = 0; i < length; ++i) {
+        size_t k = std::lower_bound(cdf.begin(), cdf.end(), dist(rng)) - cdf.begin();
+        trace[i] = perm[std::min(k, (size_t)keySpace - 1)];
+    }
+    return trace;
+}
+
+/*
+ * 混入扫描：以 10000 次访问为一段，scanFraction 比例的段是对一大片冷键的顺序扫描
+ * （范围为 scanRange，从 keySpace 开始循环），其余段是 Zipf 访问。
+ * keySpace 或 scanRange <= 0 时返回空序列。
+ */
+inline std::vector<int> makeScanMixedTrace(int keySpace, double s, size_t length, double scanFraction,
+                                           int scanRange, unsigned seed) {
+    if (keySpace <= 0 || scanRange <= 0) {
+        return std::vector<int>();
+    }
+    const size_t SEGMENT = 10000;
+    std::vector<int> zipf = makeZipfTrace(keySpace, s, length, seed);
+    std::vector<int> trace;
+    trace.reserve(length);
+    std::mt19937 rng(seed + 1);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    int scanPos = 0;
+    for (size_t seg = 0; seg < length; seg += SEGMENT) {
+        bool scan = coin(rng) < scanFraction;
+        for (size_t i = seg; i < std::min(length, seg + SEGMENT); ++i) {
+            if (scan) {
+                trace.push_back(keySpace + scanPos);
+                scanPos = (scanPos + 1) % scanRange;
+            } else {
+                trace.push_back(zipf[i]);
+            }
+        }
+    }
+    return trace;
+}
+
+/*
+ * 短 TTL：Zipf 访问，每个键的 TTL 从 ttlChoices 中随机取一个（毫秒），
+ * 回放按真实时间进行，序列越长过期越多。
+ */
+inline Workload makeTTLWorkload(int keySpace, double s, size_t length,
+                                const std::vector<int>& ttlChoices, unsigned seed) {
+    Workload w;
+    w.name = "ttl";
+    w.keys = makeZipfTrace(keySpace, s, length, seed);
+    w.keySpace = std::max(keySpace, 0);
+    w.ttlMs.resize(w.keySpace);
+    std::mt19937 rng(seed + 2);
+    for (auto& ttl : w.ttlMs) {
+        ttl = ttlChoices[rng() % ttlChoices.size()];
+    }
+    return w;
+}
+
+/*
+ * 读取轨迹文件，键按第一次出现的顺序编号；空行和 # 开头的行跳过。
+ * 出现 TTL 列时按键记录最后一次给出的 TTL，没有给出的键不过期（TTL 为 0）。
+ * 文件打不开返回 false。
+ */
+inline bool loadTraceFile(const std::string& path, Workload& w) {
+    std::ifstream in(path);
+    if (!in) {
+        return false;
+    }
+    w = Workload();
+    w.name = path;
+    std::unordered_map<std::string, int> ids;
+    std::vector<int> ttls;
+    bool hasTTL = false;
+    std::string line, key;
+    while (std::getline(in, line)) {
+        std::istringstream fields(line);
+        if (!(fields >> key) || key[0] == '#') {
+            continue;
+        }
+        auto it = ids.emplace(key, (int)ids.size()).first;
+        if (it->second == (int)ttls.size()) {
+            ttls.push_back(0);
+        }
+        int ttl;
+        if (fields >> ttl) {
+            ttls[it->second] = ttl;
+            hasTTL = true;
+        }
+        w.keys.push_back(it->second);
+    }
+    w.keySpace = (int)ids.size();
+    if (hasTTL) {
+        w.ttlMs.swap(ttls);
+    }
+    return true;
+}
+
+#endif // CACHE_WORKLOAD_H
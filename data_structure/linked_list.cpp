@@ -1,226 +1,92 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
-#include <new>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "linked_list.h"
 using namespace std;
 
 
-class node {
-    public:
-        int val;
-        node *next;
-        node(): val(0), next(nullptr) {}
-        node(int v): val(v), next(nullptr) {}
-};
-
-class link_list{
-    public:
-        int get_value(int idx);
-        bool add_at_head(int val);
-        bool add_at_tail(int val);
-
-        bool add_at_index(int idx, int val);
-        bool delete_at_index(int idx);
-        void print_all_elements();
-        link_list(): _size(0), head(nullptr) {
-            head = new (std::nothrow) node();
-        }
-        link_list(const link_list &l);
-        link_list& operator=(const link_list &other);
-        ~link_list();
-
-    private:
-        int _size;   // 链表元素个数
-        node *head;  // 虚拟头节点
-};
-
-link_list::link_list(const link_list &l): _size(0), head(nullptr) {
-    head = new (std::nothrow) node();
-    if ( !head ) throw std::bad_alloc();
-
-    node *cur = head, *cur_l = l.head->next;
-    for ( int i = 1; i <= l._size; ++i ) {
-        node *tmp = new (std::nothrow)node(cur_l->val);
-        if ( !tmp ) {
-            while ( head->next ) {
-                node* to_delete = head->next;
-                head->next = to_delete->next;
-                delete to_delete;
-            }
-            delete head;
-            head = nullptr;
-            throw std::bad_alloc();
-        }
-        cur_l = cur_l->next;
-        cur->next = tmp;
-        cur = cur->next;
-    }
-    _size = l._size;
-
-}
-
-link_list& link_list::operator=(const link_list &other) {
-    // 自我赋值检查
-    if (this == &other) {
-        return *this;
-    }
-
-    // 先创建新副本（异常安全：如果失败，原对象不变）
-    node *new_head = new (std::nothrow) node();
-    if (!new_head) throw std::bad_alloc();
-
-    node *cur = new_head;
-    node *cur_other = other.head->next;
-
-    for (int i = 1; i <= other._size; ++i) {
-        node *tmp = new (std::nothrow) node(cur_other->val);
-        if (!tmp) {
-            // 清理已分配的节点
-            while (new_head->next) {
-                node* to_delete = new_head->next;
-                new_head->next = to_delete->next;
-                delete to_delete;
-            }
-            delete new_head;
-            throw std::bad_alloc();
-        }
-        cur->next = tmp;
-        cur = cur->next;
-        cur_other = cur_other->next;
-    }
-
-    // 新副本创建成功，释放原有资源
-    node *old_head = head;
-    for (int i = 1; i <= _size; ++i) {
-        node *to_delete = head->next;
-        head->next = to_delete->next;
-        delete to_delete;
-    }
-    delete old_head;
-
-    // 使用新资源
-    head = new_head;
-    _size = other._size;
-
-    return *this;
-}
-
-int link_list::get_value(int idx) {
-    if ( idx > _size || idx <= 0 ) return -1;
-    node *cur = head;
-    for ( int i = 1; i <= idx; ++i ) {
-        cur = cur->next;
-    }
-    return cur->val;
-}
-
-bool link_list::add_at_head(int val) {
-    node *node1 = new (std::nothrow) node(val);
-    if ( !node1 ) return false;
-
-    if ( _size > 0 ) {
-        node *tmp = head->next;
-        head->next = node1;
-        node1->next = tmp;
-    } else {
-        head->next = node1;
-    }
-    _size += 1;
-    return true;
-}
-
-bool link_list::add_at_tail(int val) {
-    node *node1 = new (std::nothrow) node(val);
-    if ( !node1 ) return false;
-
-    node *cur = head;
-    for ( int i = 1; i <= _size; ++i )
-        cur = cur->next;
-
-    cur->next = node1;
-    _size += 1;
-    return true;
-}
-
-bool link_list::add_at_index(int idx, int val) {
-    if ( idx <= 0 ) {
-        bool ret = add_at_head(val);
-        cout << "add node status " << ret << endl;
-        return ret;
-    }
-    else if ( idx > _size ) {
-        bool ret = add_at_tail(val);
-        cout << "add node status " << ret << endl;
-        return ret;
-    }
-    else {
-        node *node1 = new (std::nothrow) node(val);
-        if ( !node1 )  return false;
-        node *cur = head;
-        for ( int i=1; i < idx; ++i ) {
-            cur = cur->next;
+// 构建 n 个节点、头部删除/插入 n 次、整体析构，比较两种分配策略的耗时
+template <template <class> class Alloc>
+void bench_allocator(const char *name, int n) {
+    typedef chrono::steady_clock clock;
+    clock::time_point t0 = clock::now();
+    clock::time_point t1, t2;
+    {
+        link_list<int, Alloc> list;
+        for ( int i = 0; i < n; ++i )
+            list.add_at_tail(i);
+        t1 = clock::now();
+
+        for ( int i = 0; i < n; ++i ) {
+            list.delete_at_index(1);
+            list.add_at_head(i);
         }
-        
-        node *tmp = cur->next;
-        cur->next = node1;
-        node1->next = tmp;
-        _size += 1;
+        t2 = clock::now();
     }
-    return true;
-}
-
-bool link_list::delete_at_index(int idx) {
-    if ( idx < 1 || idx > _size ) 
-        return false;
+    clock::time_point t3 = clock::now();
 
-    node *cur = head;
-    for ( int i = 1; i < idx; ++i ) 
-        cur = cur->next;
-
-    node *tmp = cur->next->next;
-    node *tar = cur->next;
-    delete tar;
-
-    cur->next = tmp;
-    _size -= 1;
-    return true;
-}
-
-void link_list::print_all_elements() {
-    node *cur = head->next;
-    cout << "here are elements at list: " << endl;
-    for ( int i = 1; i <= _size; ++i ) {
-        cout << cur->val << ", " ;
-        cur = cur->next;
-    }
-    cout << endl;
+    cout << name << ": build " << chrono::duration_cast<chrono::milliseconds>(t1 - t0).count()
+         << " ms, churn " << chrono::duration_cast<chrono::milliseconds>(t2 - t1).count()
+         << " ms, destroy " << chrono::duration_cast<chrono::milliseconds>(t3 - t2).count()
+         << " ms" << endl;
 }
 
-
-
-link_list::~link_list() {
-    node *cur = head->next;
-    cout << "~link_list()" << endl;
-    
-    for ( int i = 1; i <= _size; ++i ) {
-        node *tmp = cur;
-        cout << cur->val << ", " << endl;
-        cur = cur->next;
-        delete tmp;
-    }
-    delete head;
-    _size = 0;
+link_list<string> make_words() {
+    link_list<string> words{"alpha", "beta", "gamma"};
+    return words;  // 移动返回，不再深拷贝
 }
 
-
 int main() {
-    link_list list;
+    link_list<int> list;
     for ( int i=1; i<11; ++i )
         list.add_at_tail(i);
-    
+
     list.print_all_elements();
     list.delete_at_index(5);
     list.print_all_elements();
 
-    link_list list1(list);
+    link_list<int> list1(list);
     list1.print_all_elements();
+
+    link_list<int> list3;
+    list3.add_at_head(0);
+    list3 = list1;
+    list3.print_all_elements();
+
+    link_list<int, heap_allocator> list2;
+    list2.add_at_head(42);
+    list2.print_all_elements();
+
+    // 迭代器配合标准算法
+    cout << "sum = " << accumulate(list.begin(), list.end(), 0) << endl;
+    auto it = find(list.begin(), list.end(), 7);
+    if ( it != list.end() ) *it = 70;
+    cout << "max = " << *max_element(list.cbegin(), list.cend()) << endl;
+
+    // 泛型元素、原位构造与移动
+    link_list<string> words = make_words();
+    words.emplace_back(3, 'z');
+    words.emplace_at(2, "inserted");
+    words.print_all_elements();
+    link_list<string> moved(std::move(words));
+    cout << "moved size " << moved.size() << ", source size " << words.size() << endl;
+
+    // 批量追加与拼接
+    vector<int> v(5);
+    iota(v.begin(), v.end(), 100);
+    link_list<int> bulk;
+    bulk.append(v.begin(), v.end());
+    link_list<int> extra{-1, -2};
+    bulk.splice(3, extra);
+    bulk.print_all_elements();
+    cout << "after splice: extra size " << extra.size() << ", back " << bulk.back() << endl;
+
+    const int n = 1000000;
+    cout << "allocator benchmark, " << n << " nodes" << endl;
+    bench_allocator<heap_allocator>("heap_allocator", n);
+    bench_allocator<pool_allocator>("pool_allocator", n);
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,462 @@
+#ifndef LINKED_LIST_H
+#define LINKED_LIST_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// ====== 节点分配策略 ======
+// 策略接口：
+//   void* allocate();          分配一个 Node 大小的内存，失败返回 nullptr
+//   void deallocate(void *p);  归还 allocate() 得到的内存
+//   void swap(Alloc &other);   交换两个分配器管理的内存（用于链表的 swap / move）
+//   void merge(Alloc &other);  接管 other 的全部内存（用于 splice），之后 other 为空
+//   bulk_release               为 true 时分配器析构会整块释放所有内存，
+//                              元素可平凡析构时链表析构不必逐个归还节点
+
+// 默认堆分配：每个节点单独 new / delete
+template <class Node>
+class heap_allocator {
+    public:
+        static const bool bulk_release = false;
+
+        void* allocate() { return ::operator new(sizeof(Node), std::nothrow); }
+        void deallocate(void *p) { ::operator delete(p); }
+        void swap(heap_allocator &) noexcept {}
+        void merge(heap_allocator &) noexcept {}
+};
+
+// 内存池分配：节点从连续的大块中切分，释放的节点挂到侵入式空闲链表上复用，
+// 分配器析构时整块释放。块大小从 MIN_BLOCK_NODES 开始翻倍增长到 MAX_BLOCK_NODES。
+// 每个链表独占自己的分配器，不需要加锁。
+template <class Node>
+class pool_allocator {
+    public:
+        static const bool bulk_release = true;
+
+        pool_allocator(): blocks(nullptr), free_list(nullptr), cursor(nullptr),
+                          remaining(0), next_block_nodes(MIN_BLOCK_NODES) {}
+        ~pool_allocator() {
+            while ( blocks ) {
+                block_header *tmp = blocks;
+                blocks = blocks->next;
+                ::operator delete(tmp);
+            }
+        }
+        pool_allocator(const pool_allocator &) = delete;
+        pool_allocator& operator=(const pool_allocator &) = delete;
+
+        void* allocate() {
+            if ( free_list ) {
+                slot *s = free_list;
+                free_list = s->next;
+                return s;
+            }
+            if ( remaining == 0 && !grow() )
+                return nullptr;
+            --remaining;
+            return cursor++;
+        }
+
+        void deallocate(void *p) {
+            slot *s = static_cast<slot*>(p);
+            s->next = free_list;
+            free_list = s;
+        }
+
+        void swap(pool_allocator &other) noexcept {
+            std::swap(blocks, other.blocks);
+            std::swap(free_list, other.free_list);
+            std::swap(cursor, other.cursor);
+            std::swap(remaining, other.remaining);
+            std::swap(next_block_nodes, other.next_block_nodes);
+        }
+
+        // 把 other 的块挂到自己的块链表上。other 的空闲槽位不再复用，
+        // 随块一起在析构时释放，这样合并是 O(块数) 而不是 O(空闲节点数)
+        void merge(pool_allocator &other) noexcept {
+            if ( !other.blocks ) return;
+            block_header *last = other.blocks;
+            while ( last->next )
+                last = last->next;
+            last->next = blocks;
+            blocks = other.blocks;
+
+            other.blocks = nullptr;
+            other.free_list = nullptr;
+            other.cursor = nullptr;
+            other.remaining = 0;
+        }
+
+    private:
+        static const size_t MIN_BLOCK_NODES = 64;
+        static const size_t MAX_BLOCK_NODES = 64 * 1024;
+
+        // 空闲时存放下一个空闲槽位，使用时存放节点本身
+        union slot {
+            slot *next;
+            alignas(Node) unsigned char storage[sizeof(Node)];
+        };
+
+        // 块头，后面紧跟 count 个槽位
+        struct alignas(std::max_align_t) block_header {
+            block_header *next;
+            size_t count;
+        };
+
+        bool grow() {
+            size_t n = next_block_nodes;
+            void *mem = ::operator new(sizeof(block_header) + n * sizeof(slot), std::nothrow);
+            if ( !mem ) return false;
+
+            block_header *b = static_cast<block_header*>(mem);
+            b->next = blocks;
+            b->count = n;
+            blocks = b;
+            cursor = reinterpret_cast<slot*>(b + 1);
+            remaining = n;
+            if ( next_block_nodes < MAX_BLOCK_NODES )
+                next_block_nodes *= 2;
+            return true;
+        }
+
+        block_header *blocks;     // 已分配的块
+        slot *free_list;          // 回收的节点
+        slot *cursor;             // 当前块中下一个未使用的槽位
+        size_t remaining;         // 当前块剩余的未使用槽位
+        size_t next_block_nodes;  // 下一个块的槽位数
+};
+
+// ====== 单链表 ======
+// - 虚拟头节点内嵌在链表对象中，移动构造/赋值不需要分配内存，可以 noexcept
+// - tail 指向最后一个节点（空链表时指向虚拟头节点），尾部插入 O(1)
+// - 下标从 1 开始；分配失败时修改类操作返回 false，拷贝构造抛出 std::bad_alloc
+
+template <class T, template <class> class Alloc = pool_allocator>
+class link_list{
+    private:
+        struct node_base {
+            node_base *next;
+            node_base(): next(nullptr) {}
+        };
+        struct node: node_base {
+            T val;
+            template <class... Args>
+            explicit node(Args&&... args): node_base(), val(std::forward<Args>(args)...) {}
+        };
+
+        template <bool Const>
+        class iter {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef typename std::conditional<Const, const T*, T*>::type pointer;
+                typedef typename std::conditional<Const, const T&, T&>::type reference;
+
+                iter(): cur(nullptr) {}
+                explicit iter(node_base *n): cur(n) {}
+                // 允许 iterator 隐式转换为 const_iterator
+                template <bool C = Const, class = typename std::enable_if<C>::type>
+                iter(const iter<false> &other): cur(other.cur) {}
+
+                reference operator*() const { return static_cast<node*>(cur)->val; }
+                pointer operator->() const { return &static_cast<node*>(cur)->val; }
+                iter& operator++() { cur = cur->next; return *this; }
+                iter operator++(int) { iter tmp(*this); cur = cur->next; return tmp; }
+                bool operator==(const iter &other) const { return cur == other.cur; }
+                bool operator!=(const iter &other) const { return cur != other.cur; }
+
+            private:
+                friend class link_list;
+                template <bool> friend class iter;
+                node_base *cur;
+        };
+
+    public:
+        typedef T value_type;
+        typedef iter<false> iterator;
+        typedef iter<true> const_iterator;
+
+        T get_value(int idx) const;      // 越界返回 T()
+        bool add_at_head(T val) { return emplace_front(std::move(val)); }
+        bool add_at_tail(T val) { return emplace_back(std::move(val)); }
+
+        bool add_at_index(int idx, T val) { return emplace_at(idx, std::move(val)); }
+        bool delete_at_index(int idx);
+        void print_all_elements() const;
+
+        // 原位构造元素
+        template <class... Args> bool emplace_front(Args&&... args);
+        template <class... Args> bool emplace_back(Args&&... args);
+        template <class... Args> bool emplace_at(int idx, Args&&... args);
+
+        // 批量追加 [first, last)，分配失败时回滚，链表保持不变
+        template <class InputIt> bool append(InputIt first, InputIt last);
+        bool append(std::initializer_list<T> il) { return append(il.begin(), il.end()); }
+
+        // 把 other 的全部元素插入到 idx 位置之前（idx > size() 时追加到末尾），
+        // 只修改指针，不拷贝元素；other 变为空
+        void splice(int idx, link_list &other);
+        void splice(link_list &other) { splice(_size + 1, other); }
+
+        iterator begin() { return iterator(head.next); }
+        iterator end() { return iterator(); }
+        const_iterator begin() const { return const_iterator(head.next); }
+        const_iterator end() const { return const_iterator(); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator cend() const { return end(); }
+
+        T& front() { return static_cast<node*>(head.next)->val; }
+        T& back() { return static_cast<node*>(tail)->val; }
+        int size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        void clear();
+
+        link_list(): _size(0), tail(&head) {}
+        link_list(std::initializer_list<T> il);
+        link_list(const link_list &l);
+        link_list(link_list &&l) noexcept;
+        link_list& operator=(const link_list &other);
+        link_list& operator=(link_list &&other) noexcept;
+        ~link_list();
+
+        void swap(link_list &other) noexcept;
+
+    private:
+        template <class... Args>
+        node* create_node(Args&&... args) {
+            void *p = alloc.allocate();
+            if ( !p ) return nullptr;
+            try {
+                return new (p) node(std::forward<Args>(args)...);
+            } catch (...) {
+                alloc.deallocate(p);
+                throw;
+            }
+        }
+        void destroy_node(node_base *n) {
+            static_cast<node*>(n)->~node();
+            alloc.deallocate(n);
+        }
+        void destroy_chain(node_base *first);  // 逐个析构并归还节点
+        void link_after(node_base *prev, node_base *n);
+        node_base* node_before(int idx);  // 第 idx 个元素的前驱，idx 为 1 时是虚拟头节点
+
+        Alloc<node> alloc;  // 节点分配器，必须在节点之前构造、之后析构
+        int _size;        // 链表元素个数
+        node_base head;   // 虚拟头节点
+        node_base *tail;  // 最后一个节点，空链表时为 &head
+};
+
+template <class T, template <class> class Alloc>
+void link_list<T, Alloc>::destroy_chain(node_base *first) {
+    while ( first ) {
+        node_base *to_delete = first;
+        first = first->next;
+        destroy_node(to_delete);
+    }
+}
+
+template <class T, template <class> class Alloc>
+void link_list<T, Alloc>::link_after(node_base *prev, node_base *n) {
+    n->next = prev->next;
+    prev->next = n;
+    if ( prev == tail )
+        tail = n;
+    _size += 1;
+}
+
+template <class T, template <class> class Alloc>
+typename link_list<T, Alloc>::node_base* link_list<T, Alloc>::node_before(int idx) {
+    if ( idx > _size )
+        return tail;
+    node_base *cur = &head;
+    for ( int i = 1; i < idx; ++i )
+        cur = cur->next;
+    return cur;
+}
+
+template <class T, template <class> class Alloc>
+link_list<T, Alloc>::link_list(std::initializer_list<T> il): _size(0), tail(&head) {
+    if ( !append(il) ) throw std::bad_alloc();
+}
+
+template <class T, template <class> class Alloc>
+link_list<T, Alloc>::link_list(const link_list &l): _size(0), tail(&head) {
+    if ( !append(l.begin(), l.end()) ) throw std::bad_alloc();
+}
+
+template <class T, template <class> class Alloc>
+link_list<T, Alloc>::link_list(link_list &&l) noexcept: _size(0), tail(&head) {
+    swap(l);
+}
+
+template <class T, template <class> class Alloc>
+link_list<T, Alloc>& link_list<T, Alloc>::operator=(const link_list &other) {
+    // 自我赋值检查
+    if (this == &other) {
+        return *this;
+    }
+
+    // 先创建新副本（异常安全：如果失败，原对象不变），再交换，
+    // 节点和分配它们的内存池一起交换，原有资源随 tmp 析构释放
+    link_list tmp(other);
+    swap(tmp);
+    return *this;
+}
+
+template <class T, template <class> class Alloc>
+link_list<T, Alloc>& link_list<T, Alloc>::operator=(link_list &&other) noexcept {
+    if (this != &other) {
+        link_list tmp(std::move(other));
+        swap(tmp);
+    }
+    return *this;
+}
+
+template <class T, template <class> class Alloc>
+void link_list<T, Alloc>::swap(link_list &other) noexcept {
+    alloc.swap(other.alloc);
+    std::swap(_size, other._size);
+    std::swap(head.next, other.head.next);
+    std::swap(tail, other.tail);
+    // 空链表的 tail 指向各自的虚拟头节点，交换后需要修正
+    if ( tail == &other.head ) tail = &head;
+    if ( other.tail == &head ) other.tail = &other.head;
+}
+
+template <class T, template <class> class Alloc>
+T link_list<T, Alloc>::get_value(int idx) const {
+    if ( idx > _size || idx <= 0 ) return T();
+    const node_base *cur = &head;
+    for ( int i = 1; i <= idx; ++i ) {
+        cur = cur->next;
+    }
+    return static_cast<const node*>(cur)->val;
+}
+
+template <class T, template <class> class Alloc>
+template <class... Args>
+bool link_list<T, Alloc>::emplace_front(Args&&... args) {
+    node *node1 = create_node(std::forward<Args>(args)...);
+    if ( !node1 ) return false;
+    link_after(&head, node1);
+    return true;
+}
+
+template <class T, template <class> class Alloc>
+template <class... Args>
+bool link_list<T, Alloc>::emplace_back(Args&&... args) {
+    node *node1 = create_node(std::forward<Args>(args)...);
+    if ( !node1 ) return false;
+    link_after(tail, node1);
+    return true;
+}
+
+template <class T, template <class> class Alloc>
+template <class... Args>
+bool link_list<T, Alloc>::emplace_at(int idx, Args&&... args) {
+    if ( idx <= 0 )
+        return emplace_front(std::forward<Args>(args)...);
+
+    node *node1 = create_node(std::forward<Args>(args)...);
+    if ( !node1 ) return false;
+    link_after(node_before(idx), node1);
+    return true;
+}
+
+template <class T, template <class> class Alloc>
+template <class InputIt>
+bool link_list<T, Alloc>::append(InputIt first, InputIt last) {
+    // 先在旁边串好新节点，全部成功后一次性挂到尾部
+    node_base chain;
+    node_base *chain_tail = &chain;
+    int count = 0;
+    try {
+        for ( ; first != last; ++first ) {
+            node *n = create_node(*first);
+            if ( !n ) {
+                destroy_chain(chain.next);
+                return false;
+            }
+            chain_tail->next = n;
+            chain_tail = n;
+            ++count;
+        }
+    } catch (...) {
+        destroy_chain(chain.next);
+        throw;
+    }
+
+    if ( count > 0 ) {
+        tail->next = chain.next;
+        tail = chain_tail;
+        _size += count;
+    }
+    return true;
+}
+
+template <class T, template <class> class Alloc>
+void link_list<T, Alloc>::splice(int idx, link_list &other) {
+    if ( this == &other || other._size == 0 ) return;
+    if ( idx < 1 ) idx = 1;
+
+    node_base *prev = node_before(idx);
+    other.tail->next = prev->next;
+    prev->next = other.head.next;
+    if ( prev == tail )
+        tail = other.tail;
+    _size += other._size;
+
+    // 节点的内存归 other 的分配器所有，一并接管
+    alloc.merge(other.alloc);
+    other.head.next = nullptr;
+    other.tail = &other.head;
+    other._size = 0;
+}
+
+template <class T, template <class> class Alloc>
+bool link_list<T, Alloc>::delete_at_index(int idx) {
+    if ( idx < 1 || idx > _size )
+        return false;
+
+    node_base *cur = node_before(idx);
+    node_base *tar = cur->next;
+    cur->next = tar->next;
+    if ( tar == tail )
+        tail = cur;
+    destroy_node(tar);
+    _size -= 1;
+    return true;
+}
+
+template <class T, template <class> class Alloc>
+void link_list<T, Alloc>::print_all_elements() const {
+    std::cout << "here are elements at list: " << std::endl;
+    for ( const_iterator it = begin(); it != end(); ++it ) {
+        std::cout << *it << ", " ;
+    }
+    std::cout << std::endl;
+}
+
+template <class T, template <class> class Alloc>
+void link_list<T, Alloc>::clear() {
+    destroy_chain(head.next);
+    head.next = nullptr;
+    tail = &head;
+    _size = 0;
+}
+
+template <class T, template <class> class Alloc>
+link_list<T, Alloc>::~link_list() {
+    // 整块释放的分配器 + 平凡析构的元素：内存随分配器回收，不必逐个遍历
+    if ( Alloc<node>::bulk_release && std::is_trivially_destructible<T>::value ) return;
+    destroy_chain(head.next);
+}
+
+#endif // LINKED_LIST_H
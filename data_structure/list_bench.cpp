@@ -0,0 +1,371 @@
+// 链表变体基准测试
+//
+// 编译：g++ -std=c++11 -O2 -pthread -o list_bench list_bench.cpp
+// 运行：./list_bench positional [n...]
+//       ./list_bench stress [threads] [seconds]
+//       ./list_bench concurrent [threads...]
+//       ./list_bench snapshot [n...]
+//
+// positional：顺序构建、全量遍历、随机 get_value、随机 add_at_index / delete_at_index，
+//             每种操作输出 ns/op；各实现执行完全相同的操作序列，checksum 必须一致
+// stress：    多线程在很小的 key 范围上高冲突地 insert / remove / contains lockfree_list，
+//             结束后逐个 key 核对成功插入次数 - 成功删除次数与链表最终内容
+// concurrent：lockfree_list 与一把互斥锁保护的 link_list 的有序集合吞吐量对比
+// snapshot：  反复拷贝出快照再修改一处，对比 link_list 深拷贝与 persistent_list 结构共享
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "linked_list.h"
+#include "lockfree_list.h"
+#include "persistent_list.h"
+#include "skip_list.h"
+#include "unrolled_list.h"
+using namespace std;
+
+typedef chrono::steady_clock bench_clock;
+
+static double ns_between(bench_clock::time_point a, bench_clock::time_point b) {
+    return chrono::duration_cast<chrono::duration<double, nano> >(b - a).count();
+}
+
+// ====== positional：按下标操作 ======
+
+struct positional_ops {
+    vector<int> get_idx;     // 随机读取的下标
+    vector<int> insert_idx;  // 随机插入的下标
+    vector<int> delete_idx;  // 随机删除的下标
+};
+
+// 控制单项测试的总工作量：O(n) 的实现在 n 很大时只做少量操作
+static int op_count(int n) {
+    long long ops = 200000000LL / n;
+    if ( ops > 100000 ) ops = 100000;
+    if ( ops < 20 ) ops = 20;
+    return (int)ops;
+}
+
+static positional_ops make_positional_ops(int n) {
+    positional_ops ops;
+    mt19937 rng(12345);
+    int m = op_count(n);
+    for ( int i = 0; i < m; ++i )
+        ops.get_idx.push_back(uniform_int_distribution<int>(1, n)(rng));
+    // 插入和删除交替进行时长度在 n 与 n+1 之间变化
+    for ( int i = 0; i < m; ++i ) {
+        ops.insert_idx.push_back(uniform_int_distribution<int>(1, n + 1)(rng));
+        ops.delete_idx.push_back(uniform_int_distribution<int>(1, n + 1)(rng));
+    }
+    return ops;
+}
+
+template <class List>
+void bench_positional(const char *name, int n, const positional_ops &ops) {
+    long long checksum = 0;
+    bench_clock::time_point t0 = bench_clock::now();
+
+    List list;
+    for ( int i = 0; i < n; ++i )
+        list.add_at_tail(i);
+    bench_clock::time_point t1 = bench_clock::now();
+
+    for ( typename List::const_iterator it = list.begin(); it != list.end(); ++it )
+        checksum += *it;
+    bench_clock::time_point t2 = bench_clock::now();
+
+    for ( size_t i = 0; i < ops.get_idx.size(); ++i )
+        checksum += list.get_value(ops.get_idx[i]);
+    bench_clock::time_point t3 = bench_clock::now();
+
+    for ( size_t i = 0; i < ops.insert_idx.size(); ++i ) {
+        list.add_at_index(ops.insert_idx[i], (int)i);
+        list.delete_at_index(ops.delete_idx[i]);
+    }
+    bench_clock::time_point t4 = bench_clock::now();
+
+    for ( typename List::const_iterator it = list.begin(); it != list.end(); ++it )
+        checksum += *it;
+    bench_clock::time_point t5 = bench_clock::now();
+
+    double m = (double)ops.get_idx.size();
+    cout << left << setw(26) << name << right << fixed << setprecision(1)
+         << setw(10) << ns_between(t0, t1) / n
+         << setw(10) << (ns_between(t1, t2) + ns_between(t4, t5)) / (2.0 * n)
+         << setw(12) << ns_between(t2, t3) / m
+         << setw(14) << ns_between(t3, t4) / (2 * m)
+         << "   " << checksum << endl;
+}
+
+static void run_positional(const vector<int> &sizes) {
+    for ( size_t s = 0; s < sizes.size(); ++s ) {
+        int n = sizes[s];
+        positional_ops ops = make_positional_ops(n);
+        cout << "\nn = " << n << ", random ops = " << ops.get_idx.size() << " (ns/op)" << endl;
+        cout << left << setw(26) << "list" << right << setw(10) << "append" << setw(10) << "iterate"
+             << setw(12) << "get_value" << setw(14) << "insert+delete" << "   checksum" << endl;
+
+        bench_positional<link_list<int> >("link_list", n, ops);
+        bench_positional<link_list<int, heap_allocator> >("link_list<heap>", n, ops);
+        bench_positional<unrolled_list<int, 16> >("unrolled_list<16>", n, ops);
+        bench_positional<unrolled_list<int, 64> >("unrolled_list<64>", n, ops);
+        bench_positional<unrolled_list<int, 256> >("unrolled_list<256>", n, ops);
+        bench_positional<skip_list<int> >("skip_list", n, ops);
+    }
+}
+
+// ====== stress：lockfree_list 正确性 ======
+
+static bool run_stress(int nthreads, int seconds) {
+    const int key_range = 256;
+    lockfree_list<int> set;
+    atomic<bool> stop(false);
+    // delta[t][k] = 线程 t 对 key k 的成功插入次数 - 成功删除次数
+    vector<vector<long long> > delta(nthreads, vector<long long>(key_range, 0));
+    vector<long long> ops(nthreads, 0);
+
+    vector<thread> threads;
+    for ( int t = 0; t < nthreads; ++t ) {
+        threads.push_back(thread([&, t]() {
+            mt19937 rng(1000 + t);
+            long long n = 0;
+            while ( !stop.load(memory_order_relaxed) ) {
+                int key = (int)(rng() % key_range);
+                unsigned op = rng() % 3;
+                if ( op == 0 ) {
+                    if ( set.insert(key) ) delta[t][key]++;
+                } else if ( op == 1 ) {
+                    if ( set.remove(key) ) delta[t][key]--;
+                } else {
+                    set.contains(key);
+                }
+                ++n;
+            }
+            ops[t] = n;
+        }));
+    }
+    this_thread::sleep_for(chrono::seconds(seconds));
+    stop.store(true);
+    for ( size_t t = 0; t < threads.size(); ++t )
+        threads[t].join();
+
+    bool ok = true;
+    vector<int> present(key_range, 0);
+    int prev = -1, count = 0;
+    set.for_each([&](int key) {
+        if ( key <= prev ) ok = false;  // 必须严格递增
+        prev = key;
+        present[key] = 1;
+        ++count;
+    });
+    for ( int k = 0; k < key_range; ++k ) {
+        long long sum = 0;
+        for ( int t = 0; t < nthreads; ++t )
+            sum += delta[t][k];
+        if ( sum != present[k] || sum != (set.contains(k) ? 1 : 0) ) {
+            cerr << "key " << k << ": net inserts " << sum << ", present " << present[k] << endl;
+            ok = false;
+        }
+    }
+    if ( count != set.size() ) ok = false;
+
+    long long total = 0;
+    for ( int t = 0; t < nthreads; ++t )
+        total += ops[t];
+    cout << "stress: " << nthreads << " threads, " << seconds << " s, " << total << " ops, "
+         << count << " keys left: " << (ok ? "PASS" : "FAIL") << endl;
+    return ok;
+}
+
+// ====== concurrent：有序集合吞吐量 ======
+
+// 对照组：一把互斥锁保护的有序 link_list
+class locked_list_set {
+    public:
+        bool insert(int key) {
+            lock_guard<mutex> lock(mtx);
+            int idx = 1;
+            for ( link_list<int>::iterator it = list.begin(); it != list.end(); ++it, ++idx ) {
+                if ( *it == key ) return false;
+                if ( *it > key ) break;
+            }
+            return list.add_at_index(idx, key);
+        }
+        bool remove(int key) {
+            lock_guard<mutex> lock(mtx);
+            int idx = 1;
+            for ( link_list<int>::iterator it = list.begin(); it != list.end(); ++it, ++idx ) {
+                if ( *it == key ) return list.delete_at_index(idx);
+                if ( *it > key ) break;
+            }
+            return false;
+        }
+        bool contains(int key) {
+            lock_guard<mutex> lock(mtx);
+            for ( link_list<int>::iterator it = list.begin(); it != list.end(); ++it ) {
+                if ( *it >= key ) return *it == key;
+            }
+            return false;
+        }
+
+    private:
+        mutex mtx;
+        link_list<int> list;
+};
+
+// 80% contains、10% insert、10% remove，预先填充一半 key，返回每秒操作数（百万）
+template <class Set>
+double bench_set(int nthreads, int key_range, double seconds) {
+    Set set;
+    for ( int k = 0; k < key_range; k += 2 )
+        set.insert(k);
+
+    atomic<bool> start(false), stop(false);
+    atomic<long long> total(0), hits(0);
+    vector<thread> threads;
+    for ( int t = 0; t < nthreads; ++t ) {
+        threads.push_back(thread([&, t]() {
+            mt19937 rng(t + 1);
+            long long n = 0, found = 0;
+            while ( !start.load() ) {}
+            while ( !stop.load(memory_order_relaxed) ) {
+                int key = (int)(rng() % key_range);
+                unsigned op = rng() % 10;
+                // 累计返回值，防止编译器把无副作用的查找整个优化掉
+                if ( op == 0 ) found += set.insert(key);
+                else if ( op == 1 ) found += set.remove(key);
+                else found += set.contains(key);
+                ++n;
+            }
+            total += n;
+            hits += found;
+        }));
+    }
+    start.store(true);
+    this_thread::sleep_for(chrono::duration<double>(seconds));
+    stop.store(true);
+    for ( size_t t = 0; t < threads.size(); ++t )
+        threads[t].join();
+    if ( hits.load() < 0 ) cout << hits.load();
+    return total.load() / seconds / 1e6;
+}
+
+static void run_concurrent(const vector<int> &thread_counts) {
+    const int key_ranges[] = {64, 1024};
+    for ( size_t r = 0; r < sizeof(key_ranges) / sizeof(key_ranges[0]); ++r ) {
+        cout << "\nkey range " << key_ranges[r] << " (Mops/s, 80% contains / 10% insert / 10% remove)" << endl;
+        cout << setw(8) << "threads" << setw(16) << "lockfree_list" << setw(16) << "mutex+link_list" << endl;
+        for ( size_t i = 0; i < thread_counts.size(); ++i ) {
+            int n = thread_counts[i];
+            double lf = bench_set<lockfree_list<int> >(n, key_ranges[r], 1.0);
+            double mx = bench_set<locked_list_set>(n, key_ranges[r], 1.0);
+            cout << setw(8) << n << fixed << setprecision(2) << setw(16) << lf << setw(16) << mx << endl;
+        }
+    }
+}
+
+// ====== snapshot：快照 + 修改 ======
+
+// 保留 SNAPSHOTS 个快照，每个快照在头部插入一个元素或修改一个随机位置的元素
+template <class List>
+void bench_snapshot(const char *name, int n, const vector<int> &edit_idx) {
+    List base;
+    for ( int i = 0; i < n; ++i )
+        base.add_at_tail(i);
+
+    long long checksum = 0;
+    bench_clock::time_point t0 = bench_clock::now();
+    {
+        vector<List> snapshots;
+        snapshots.reserve(edit_idx.size());
+        for ( size_t i = 0; i < edit_idx.size(); ++i ) {
+            snapshots.push_back(base);
+            snapshots.back().add_at_head((int)i);
+        }
+        bench_clock::time_point t1 = bench_clock::now();
+
+        vector<List> edited;
+        edited.reserve(edit_idx.size());
+        for ( size_t i = 0; i < edit_idx.size(); ++i ) {
+            edited.push_back(base);
+            edited.back().delete_at_index(edit_idx[i]);
+            edited.back().add_at_index(edit_idx[i], -1);
+        }
+        bench_clock::time_point t2 = bench_clock::now();
+
+        for ( size_t i = 0; i < edited.size(); ++i )
+            checksum += snapshots[i].get_value(1) + edited[i].get_value(edit_idx[i]);
+
+        double m = (double)edit_idx.size();
+        cout << left << setw(18) << name << right << fixed << setprecision(1)
+             << setw(20) << ns_between(t0, t1) / m
+             << setw(22) << ns_between(t1, t2) / m;
+    }
+    cout << "   " << checksum << endl;
+}
+
+static void run_snapshot(const vector<int> &sizes) {
+    const int SNAPSHOTS = 1000;
+    for ( size_t s = 0; s < sizes.size(); ++s ) {
+        int n = sizes[s];
+        mt19937 rng(7);
+        vector<int> edit_idx;
+        for ( int i = 0; i < SNAPSHOTS; ++i )
+            edit_idx.push_back(uniform_int_distribution<int>(1, n)(rng));
+
+        cout << "\nn = " << n << ", " << SNAPSHOTS << " snapshots (ns per snapshot)" << endl;
+        cout << left << setw(18) << "list" << right << setw(20) << "copy+add_at_head"
+             << setw(22) << "copy+edit at random" << "   checksum" << endl;
+        bench_snapshot<link_list<int> >("link_list", n, edit_idx);
+        bench_snapshot<persistent_list<int> >("persistent_list", n, edit_idx);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if ( argc < 2 ) {
+        cerr << "usage: " << argv[0] << " positional [n...] | stress [threads] [seconds]"
+             << " | concurrent [threads...] | snapshot [n...]" << endl;
+        return 1;
+    }
+
+    vector<int> sizes;
+    for ( int i = 2; i < argc; ++i )
+        sizes.push_back(atoi(argv[i]));
+
+    if ( strcmp(argv[1], "positional") == 0 ) {
+        if ( sizes.empty() ) {
+            sizes.push_back(10000);
+            sizes.push_back(100000);
+            sizes.push_back(1000000);
+        }
+        run_positional(sizes);
+    } else if ( strcmp(argv[1], "stress") == 0 ) {
+        int nthreads = sizes.size() > 0 ? sizes[0] : (int)thread::hardware_concurrency();
+        int seconds = sizes.size() > 1 ? sizes[1] : 3;
+        return run_stress(nthreads > 1 ? nthreads : 2, seconds) ? 0 : 1;
+    } else if ( strcmp(argv[1], "concurrent") == 0 ) {
+        if ( sizes.empty() ) {
+            for ( int n = 1; n <= 64; n *= 2 )
+                sizes.push_back(n);
+        }
+        run_concurrent(sizes);
+    } else if ( strcmp(argv[1], "snapshot") == 0 ) {
+        if ( sizes.empty() ) {
+            sizes.push_back(1000);
+            sizes.push_back(10000);
+            sizes.push_back(100000);
+        }
+        run_snapshot(sizes);
+    } else {
+        cerr << "unknown mode: " << argv[1] << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,303 @@
+#ifndef LOCKFREE_LIST_H
+#define LOCKFREE_LIST_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+#include <vector>
+
+// ====== 基于纪元的内存回收（epoch-based reclamation） ======
+// 无锁结构摘下的节点可能仍被其他线程读取，不能立即释放：
+// - 线程访问共享结构前 enter()，在本地记录中公布自己观察到的全局纪元，结束后 exit()
+// - 摘下的节点 retire() 到当前纪元的回收袋中
+// - 所有活跃线程都已进入当前纪元 e 时全局纪元前进到 e+1；
+//   纪元 t 中退休的节点在全局纪元到达 t+2 后不可能再被任何线程引用，可以释放
+// 每个线程有 3 个回收袋（按纪元 % 3 轮转），复用一个袋子前先释放其中的旧节点。
+// 进程内所有无锁结构共享一个回收域；线程退出后其记录交给后来的线程复用。
+
+class epoch_domain {
+    public:
+        typedef void (*deleter_t)(void*);
+
+        static epoch_domain& instance() {
+            static epoch_domain domain;
+            return domain;
+        }
+
+        void enter() {
+            record *r = local_record();
+            if ( r->nest++ > 0 ) return;
+            uint64_t e = global_epoch.load();
+            // seq_cst 写：之后对共享结构的读不会被重排到公布纪元之前
+            r->state.store((e << 1) | 1);
+        }
+
+        void exit() {
+            record *r = local_record();
+            if ( --r->nest > 0 ) return;
+            r->state.store(0, std::memory_order_release);
+        }
+
+        void retire(void *p, deleter_t deleter) {
+            record *r = local_record();
+            uint64_t e = global_epoch.load();
+            int idx = (int)(e % 3);
+            if ( r->bag_epoch[idx] != e ) {
+                // 袋中是纪元 e-3 或更早退休的节点，已经安全
+                free_bag(r->bags[idx]);
+                r->bag_epoch[idx] = e;
+            }
+            r->bags[idx].push_back(retired(p, deleter));
+            if ( ++r->retire_count % ADVANCE_INTERVAL == 0 )
+                try_advance();
+        }
+
+        ~epoch_domain() {
+            record *r = records.load();
+            while ( r ) {
+                record *next = r->next;
+                for ( int i = 0; i < 3; ++i )
+                    free_bag(r->bags[i]);
+                delete r;
+                r = next;
+            }
+        }
+
+    private:
+        static const unsigned ADVANCE_INTERVAL = 64;  // 每退休多少个节点尝试推进一次纪元
+
+        struct retired {
+            void *ptr;
+            deleter_t deleter;
+            retired(void *p, deleter_t d): ptr(p), deleter(d) {}
+        };
+
+        struct record {
+            std::atomic<uint64_t> state;   // (纪元 << 1) | 活跃位，不活跃时为 0
+            std::atomic<bool> in_use;
+            record *next;
+            int nest;                      // enter() 嵌套深度，只由所属线程访问
+            unsigned retire_count;
+            uint64_t bag_epoch[3];
+            std::vector<retired> bags[3];
+            record(): state(0), in_use(true), next(nullptr), nest(0), retire_count(0) {
+                bag_epoch[0] = bag_epoch[1] = bag_epoch[2] = 0;
+            }
+        };
+
+        // 线程退出时归还记录
+        struct thread_handle {
+            record *rec;
+            thread_handle(): rec(nullptr) {}
+            ~thread_handle() {
+                if ( rec ) {
+                    rec->state.store(0);
+                    rec->in_use.store(false, std::memory_order_release);
+                }
+            }
+        };
+
+        epoch_domain(): global_epoch(3), records(nullptr) {}
+        epoch_domain(const epoch_domain &) = delete;
+        epoch_domain& operator=(const epoch_domain &) = delete;
+
+        record* local_record() {
+            static thread_local thread_handle handle;
+            if ( !handle.rec )
+                handle.rec = acquire_record();
+            return handle.rec;
+        }
+
+        record* acquire_record() {
+            for ( record *r = records.load(); r; r = r->next ) {
+                bool expected = false;
+                if ( !r->in_use.load() && r->in_use.compare_exchange_strong(expected, true) )
+                    return r;
+            }
+            record *r = new record();
+            record *head = records.load();
+            do {
+                r->next = head;
+            } while ( !records.compare_exchange_weak(head, r) );
+            return r;
+        }
+
+        void try_advance() {
+            uint64_t e = global_epoch.load();
+            for ( record *r = records.load(); r; r = r->next ) {
+                uint64_t s = r->state.load();
+                if ( (s & 1) && (s >> 1) != e )
+                    return;  // 还有线程停留在旧纪元
+            }
+            global_epoch.compare_exchange_strong(e, e + 1);
+        }
+
+        static void free_bag(std::vector<retired> &bag) {
+            for ( size_t i = 0; i < bag.size(); ++i )
+                bag[i].deleter(bag[i].ptr);
+            bag.clear();
+        }
+
+        std::atomic<uint64_t> global_epoch;
+        std::atomic<record*> records;
+};
+
+// 作用域内处于临界区
+class epoch_guard {
+    public:
+        epoch_guard() { epoch_domain::instance().enter(); }
+        ~epoch_guard() { epoch_domain::instance().exit(); }
+        epoch_guard(const epoch_guard &) = delete;
+        epoch_guard& operator=(const epoch_guard &) = delete;
+};
+
+// ====== 无锁有序链表（Harris 算法） ======
+// 有序集合语义：insert / remove / contains，可被任意多个线程并发调用。
+// - 删除分两步：先 CAS 把节点 next 指针的最低位置 1（逻辑删除），再 CAS 把它从前驱上摘下（物理删除）
+// - 查找途中遇到已标记的节点顺手摘下，每个节点只会被成功摘下一次，由摘下它的线程 retire
+// - 插入和删除失败时从头重新查找，contains 只读不写
+// 析构、size() 以外的接口都是线程安全的；析构时不能有其他线程正在访问。
+
+template <class T>
+class lockfree_list {
+    private:
+        struct node {
+            std::atomic<uintptr_t> next;   // 后继指针，最低位为删除标记
+            T key;
+            template <class... Args>
+            explicit node(Args&&... args): next(0), key(std::forward<Args>(args)...) {}
+        };
+
+        static node* ptr_of(uintptr_t v) { return reinterpret_cast<node*>(v & ~uintptr_t(1)); }
+        static bool is_marked(uintptr_t v) { return (v & 1) != 0; }
+        static uintptr_t as_word(node *n) { return reinterpret_cast<uintptr_t>(n); }
+        static void delete_node(void *p) { delete static_cast<node*>(p); }
+
+    public:
+        bool insert(const T &key);       // 已存在或分配失败返回 false
+        bool remove(const T &key);       // 不存在返回 false
+        bool contains(const T &key) const;
+
+        int size() const { return _size.load(std::memory_order_relaxed); }  // 并发修改时为近似值
+
+        // 单线程遍历（调用者保证没有并发修改），跳过已逻辑删除的节点
+        template <class F> void for_each(F f) const {
+            for ( node *cur = ptr_of(head.load()); cur; cur = ptr_of(cur->next.load()) ) {
+                if ( !is_marked(cur->next.load()) )
+                    f(cur->key);
+            }
+        }
+
+        lockfree_list(): head(0), _size(0) {}
+        lockfree_list(const lockfree_list &) = delete;
+        lockfree_list& operator=(const lockfree_list &) = delete;
+        ~lockfree_list();
+
+    private:
+        // 返回 prev（最后一个 key 小于目标的节点的 next 字段）与 cur（第一个 key 不小于目标的未删除节点），
+        // 途中摘下并回收已标记的节点
+        void search(const T &key, std::atomic<uintptr_t> *&prev, node *&cur);
+
+        std::atomic<uintptr_t> head;   // 虚拟头节点，只需要 next 字段
+        std::atomic<int> _size;
+};
+
+template <class T>
+void lockfree_list<T>::search(const T &key, std::atomic<uintptr_t> *&prev, node *&cur) {
+retry:
+    prev = &head;
+    cur = ptr_of(prev->load());
+    while ( cur ) {
+        uintptr_t succ = cur->next.load();
+        if ( is_marked(succ) ) {
+            // cur 已被逻辑删除，尝试摘下；前驱变化了（被插入或被标记）就从头再来
+            uintptr_t expected = as_word(cur);
+            if ( !prev->compare_exchange_strong(expected, succ & ~uintptr_t(1)) )
+                goto retry;
+            epoch_domain::instance().retire(cur, delete_node);
+            cur = ptr_of(succ);
+            continue;
+        }
+        if ( !(cur->key < key) )
+            return;
+        prev = &cur->next;
+        cur = ptr_of(succ);
+    }
+}
+
+template <class T>
+bool lockfree_list<T>::insert(const T &key) {
+    epoch_guard guard;
+    node *n = nullptr;
+    while ( true ) {
+        std::atomic<uintptr_t> *prev;
+        node *cur;
+        search(key, prev, cur);
+        if ( cur && !(key < cur->key) ) {
+            delete n;
+            return false;
+        }
+        if ( !n ) {
+            n = new (std::nothrow) node(key);
+            if ( !n ) return false;
+        }
+        n->next.store(as_word(cur), std::memory_order_relaxed);
+        uintptr_t expected = as_word(cur);
+        if ( prev->compare_exchange_strong(expected, as_word(n)) ) {
+            _size.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+}
+
+template <class T>
+bool lockfree_list<T>::remove(const T &key) {
+    epoch_guard guard;
+    while ( true ) {
+        std::atomic<uintptr_t> *prev;
+        node *cur;
+        search(key, prev, cur);
+        if ( !cur || key < cur->key )
+            return false;
+
+        uintptr_t succ = cur->next.load();
+        if ( is_marked(succ) )
+            continue;
+        // 逻辑删除：标记成功的线程才算删除了这个 key
+        if ( !cur->next.compare_exchange_strong(succ, succ | 1) )
+            continue;
+        _size.fetch_sub(1, std::memory_order_relaxed);
+
+        // 物理删除：失败说明前驱变了，交给一次查找来摘下
+        uintptr_t expected = as_word(cur);
+        if ( prev->compare_exchange_strong(expected, succ) )
+            epoch_domain::instance().retire(cur, delete_node);
+        else
+            search(key, prev, cur);
+        return true;
+    }
+}
+
+template <class T>
+bool lockfree_list<T>::contains(const T &key) const {
+    epoch_guard guard;
+    node *cur = ptr_of(head.load());
+    while ( cur && cur->key < key )
+        cur = ptr_of(cur->next.load());
+    return cur && !(key < cur->key) && !is_marked(cur->next.load());
+}
+
+template <class T>
+lockfree_list<T>::~lockfree_list() {
+    // 链上剩下的节点（包括已标记未摘下的）由这里释放，已摘下的由回收域释放
+    node *cur = ptr_of(head.load());
+    while ( cur ) {
+        node *next = ptr_of(cur->next.load());
+        delete cur;
+        cur = next;
+    }
+}
+
+#endif // LOCKFREE_LIST_H
@@ -0,0 +1,217 @@
+#ifndef PERSISTENT_LIST_H
+#define PERSISTENT_LIST_H
+
+#include <atomic>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <utility>
+
+// ====== 持久化链表（结构共享） ======
+// 链表对象只是指向首节点的句柄，节点带引用计数，可被多个链表共享：
+// - 拷贝构造 / 拷贝赋值 O(1)：只增加首节点的引用计数，得到一个快照
+// - 修改时做路径复制：第 idx 个位置之前的节点若与其他快照共享就复制一份，
+//   之后未改动的后缀原样共享；只被自己持有（引用计数为 1）的节点直接原地修改
+// - 节点引用计数归零时释放，并沿链表依次释放不再被引用的后继
+// 接口与 link_list 一致（1-based 下标，分配失败返回 false）。
+// 不同线程可以各自持有、读取、修改共享节点的快照；同一个链表对象不能被多个线程同时修改。
+
+template <class T>
+class persistent_list {
+    private:
+        struct node {
+            std::atomic<int> refs;
+            node *next;     // 持有 next 的一个引用
+            T val;
+            template <class... Args>
+            explicit node(node *n, Args&&... args): refs(1), next(n), val(std::forward<Args>(args)...) {}
+        };
+
+        static node* retain(node *n) {
+            if ( n ) n->refs.fetch_add(1, std::memory_order_relaxed);
+            return n;
+        }
+        // 释放一个引用；节点被释放时它对 next 的引用也随之释放
+        static void release(node *n) {
+            while ( n && n->refs.fetch_sub(1, std::memory_order_acq_rel) == 1 ) {
+                node *next = n->next;
+                delete n;
+                n = next;
+            }
+        }
+
+    public:
+        // 快照只读，修改必须通过链表接口进行以保证路径复制
+        class const_iterator {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const T* pointer;
+                typedef const T& reference;
+
+                const_iterator(): cur(nullptr) {}
+                explicit const_iterator(const node *n): cur(n) {}
+
+                reference operator*() const { return cur->val; }
+                pointer operator->() const { return &cur->val; }
+                const_iterator& operator++() { cur = cur->next; return *this; }
+                const_iterator operator++(int) { const_iterator tmp(*this); cur = cur->next; return tmp; }
+                bool operator==(const const_iterator &other) const { return cur == other.cur; }
+                bool operator!=(const const_iterator &other) const { return cur != other.cur; }
+
+            private:
+                const node *cur;
+        };
+        typedef T value_type;
+        typedef const_iterator iterator;
+
+        T get_value(int idx) const;      // 越界返回 T()
+        bool add_at_head(T val);         // O(1)，整个原链表作为后缀共享
+        bool add_at_tail(T val) { return add_at_index(_size + 1, std::move(val)); }
+
+        bool add_at_index(int idx, T val);
+        bool delete_at_index(int idx);
+        bool set_value(int idx, T val);  // 修改第 idx 个元素，复制其前缀（未共享时原地修改）
+        void print_all_elements() const;
+
+        const_iterator begin() const { return const_iterator(head); }
+        const_iterator end() const { return const_iterator(); }
+
+        int size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        void clear() { release(head); head = nullptr; _size = 0; }
+
+        // 两个链表是否共享首节点（用于观察快照之间的结构共享）
+        bool shares_with(const persistent_list &other) const { return head && head == other.head; }
+
+        persistent_list(): head(nullptr), _size(0) {}
+        persistent_list(const persistent_list &l): head(retain(l.head)), _size(l._size) {}
+        persistent_list(persistent_list &&l) noexcept: head(l.head), _size(l._size) {
+            l.head = nullptr;
+            l._size = 0;
+        }
+        persistent_list& operator=(const persistent_list &other) {
+            persistent_list tmp(other);
+            swap(tmp);
+            return *this;
+        }
+        persistent_list& operator=(persistent_list &&other) noexcept {
+            persistent_list tmp(std::move(other));
+            swap(tmp);
+            return *this;
+        }
+        ~persistent_list() { release(head); }
+
+        void swap(persistent_list &other) noexcept {
+            std::swap(head, other.head);
+            std::swap(_size, other._size);
+        }
+
+    private:
+        // 保证前 count 个节点只被本链表持有（共享的就复制），返回第 count 个节点的 next 字段，
+        // count 为 0 时返回 &head（相当于虚拟头节点）。分配失败返回 nullptr，链表内容不变
+        node** unique_prefix(int count);
+
+        node *head;
+        int _size;
+};
+
+template <class T>
+typename persistent_list<T>::node** persistent_list<T>::unique_prefix(int count) {
+    node **slot = &head;
+    for ( int i = 0; i < count; ++i ) {
+        node *cur = *slot;
+        if ( cur->refs.load(std::memory_order_acquire) != 1 ) {
+            // 与其他快照共享：复制本节点，副本共享原来的后继
+            node *copy = new (std::nothrow) node(cur->next, cur->val);
+            if ( !copy ) return nullptr;
+            retain(cur->next);
+            *slot = copy;
+            release(cur);
+            cur = copy;
+        }
+        slot = &cur->next;
+    }
+    return slot;
+}
+
+template <class T>
+T persistent_list<T>::get_value(int idx) const {
+    if ( idx > _size || idx <= 0 ) return T();
+    const node *cur = head;
+    for ( int i = 1; i < idx; ++i )
+        cur = cur->next;
+    return cur->val;
+}
+
+template <class T>
+bool persistent_list<T>::add_at_head(T val) {
+    node *n = new (std::nothrow) node(head, std::move(val));
+    if ( !n ) return false;
+    head = n;  // 原首节点的引用转交给新节点
+    _size += 1;
+    return true;
+}
+
+template <class T>
+bool persistent_list<T>::add_at_index(int idx, T val) {
+    if ( idx <= 1 ) return add_at_head(std::move(val));
+    if ( idx > _size ) idx = _size + 1;
+
+    node **slot = unique_prefix(idx - 1);
+    if ( !slot ) return false;
+    node *n = new (std::nothrow) node(*slot, std::move(val));
+    if ( !n ) return false;
+    *slot = n;
+    _size += 1;
+    return true;
+}
+
+template <class T>
+bool persistent_list<T>::delete_at_index(int idx) {
+    if ( idx < 1 || idx > _size )
+        return false;
+
+    node **slot = unique_prefix(idx - 1);
+    if ( !slot ) return false;
+    node *victim = *slot;
+    *slot = retain(victim->next);
+    release(victim);
+    _size -= 1;
+    return true;
+}
+
+template <class T>
+bool persistent_list<T>::set_value(int idx, T val) {
+    if ( idx < 1 || idx > _size )
+        return false;
+
+    node **slot = unique_prefix(idx - 1);
+    if ( !slot ) return false;
+    node *cur = *slot;
+    if ( cur->refs.load(std::memory_order_acquire) == 1 ) {
+        cur->val = std::move(val);
+        return true;
+    }
+    // 被修改的节点本身共享：换成新节点，后缀照常共享
+    // 分配成功后才增加后继的引用：分配失败时构造函数的实参不一定被求值
+    node *n = new (std::nothrow) node(cur->next, std::move(val));
+    if ( !n ) return false;
+    retain(cur->next);
+    *slot = n;
+    release(cur);
+    return true;
+}
+
+template <class T>
+void persistent_list<T>::print_all_elements() const {
+    std::cout << "here are elements at list: " << std::endl;
+    for ( const_iterator it = begin(); it != end(); ++it ) {
+        std::cout << *it << ", " ;
+    }
+    std::cout << std::endl;
+}
+
+#endif // PERSISTENT_LIST_H
@@ -0,0 +1,305 @@
+#ifndef SKIP_LIST_H
+#define SKIP_LIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// ====== 可按下标访问的跳表（indexable skip list） ======
+// 每一层的前向指针都记录跨度 width = 目标节点的位置 - 当前节点的位置，
+// 查找第 idx 个元素时沿各层累加跨度，访问、插入、删除都是期望 O(log n)。
+// 接口与 link_list 一致（1-based 下标、虚拟头节点、分配失败返回 false）。
+// - 节点层数按 1/4 概率逐层晋升，MAX_LEVEL = 16 足够支撑数十亿元素
+// - 节点高度不定，前向指针数组紧跟节点分配在同一块内存中，因此不使用定长节点的分配策略
+
+template <class T>
+class skip_list {
+    private:
+        static const int MAX_LEVEL = 16;
+
+        struct node_base;
+        struct link {
+            node_base *next;
+            int width;     // 到 next 的位置差，next 为空时无意义
+        };
+        struct node_base {
+            link *forward;  // forward[0 .. level-1]
+            int level;
+        };
+        struct node: node_base {
+            T val;
+            template <class... Args>
+            explicit node(Args&&... args): node_base(), val(std::forward<Args>(args)...) {}
+        };
+
+        // 前向指针数组放在节点之后，按 link 对齐
+        static size_t links_offset() {
+            return (sizeof(node) + alignof(link) - 1) / alignof(link) * alignof(link);
+        }
+
+        template <bool Const>
+        class iter {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef typename std::conditional<Const, const T*, T*>::type pointer;
+                typedef typename std::conditional<Const, const T&, T&>::type reference;
+
+                iter(): cur(nullptr) {}
+                explicit iter(node_base *n): cur(n) {}
+                template <bool C = Const, class = typename std::enable_if<C>::type>
+                iter(const iter<false> &other): cur(other.cur) {}
+
+                reference operator*() const { return static_cast<node*>(cur)->val; }
+                pointer operator->() const { return &static_cast<node*>(cur)->val; }
+                iter& operator++() { cur = cur->forward[0].next; return *this; }
+                iter operator++(int) { iter tmp(*this); ++*this; return tmp; }
+                bool operator==(const iter &other) const { return cur == other.cur; }
+                bool operator!=(const iter &other) const { return cur != other.cur; }
+
+            private:
+                template <bool> friend class iter;
+                node_base *cur;
+        };
+
+    public:
+        typedef T value_type;
+        typedef iter<false> iterator;
+        typedef iter<true> const_iterator;
+
+        T get_value(int idx) const;      // 越界返回 T()
+        bool add_at_head(T val) { return add_at_index(1, std::move(val)); }
+        bool add_at_tail(T val) { return add_at_index(_size + 1, std::move(val)); }
+
+        bool add_at_index(int idx, T val);
+        bool delete_at_index(int idx);
+        void print_all_elements() const;
+
+        iterator begin() { return iterator(head.forward[0].next); }
+        iterator end() { return iterator(); }
+        const_iterator begin() const { return const_iterator(head.forward[0].next); }
+        const_iterator end() const { return const_iterator(); }
+
+        int size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        void clear();
+
+        skip_list(): _size(0), _level(1), rng_state(0x9E3779B97F4A7C15ULL) { reset_head(); }
+        skip_list(const skip_list &l);
+        skip_list(skip_list &&l) noexcept: skip_list() { swap(l); }
+        skip_list& operator=(const skip_list &other);
+        skip_list& operator=(skip_list &&other) noexcept;
+        ~skip_list() { clear(); }
+
+        void swap(skip_list &other) noexcept;
+
+    private:
+        void reset_head() {
+            head.forward = head_links;
+            head.level = MAX_LEVEL;
+            for ( int i = 0; i < MAX_LEVEL; ++i ) {
+                head_links[i].next = nullptr;
+                head_links[i].width = 0;
+            }
+        }
+
+        int random_level() {
+            // xorshift64，每次取两位决定是否晋升一层（概率 1/4）
+            rng_state ^= rng_state << 13;
+            rng_state ^= rng_state >> 7;
+            rng_state ^= rng_state << 17;
+            uint64_t bits = rng_state;
+            int lvl = 1;
+            while ( lvl < MAX_LEVEL && (bits & 3) == 0 ) {
+                ++lvl;
+                bits >>= 2;
+            }
+            return lvl;
+        }
+
+        node* create_node(T &&val) {
+            int lvl = random_level();
+            void *p = ::operator new(links_offset() + lvl * sizeof(link), std::nothrow);
+            if ( !p ) return nullptr;
+            node *n;
+            try {
+                n = new (p) node(std::move(val));
+            } catch (...) {
+                ::operator delete(p);
+                throw;
+            }
+            n->forward = reinterpret_cast<link*>(static_cast<char*>(p) + links_offset());
+            n->level = lvl;
+            return n;
+        }
+        void destroy_node(node_base *n) {
+            static_cast<node*>(n)->~node();
+            ::operator delete(n);
+        }
+
+        // 自顶向下找到每层中位置 < idx 的最后一个节点及其位置
+        void find_preds(int idx, node_base **update, int *rank) const;
+
+        int _size;
+        int _level;                   // 当前使用的最高层数
+        uint64_t rng_state;
+        node_base head;               // 虚拟头节点，位置为 0
+        link head_links[MAX_LEVEL];
+};
+
+template <class T>
+void skip_list<T>::find_preds(int idx, node_base **update, int *rank) const {
+    node_base *x = const_cast<node_base*>(&head);
+    int pos = 0;
+    for ( int i = _level - 1; i >= 0; --i ) {
+        while ( x->forward[i].next && pos + x->forward[i].width < idx ) {
+            pos += x->forward[i].width;
+            x = x->forward[i].next;
+        }
+        update[i] = x;
+        rank[i] = pos;
+    }
+}
+
+template <class T>
+skip_list<T>::skip_list(const skip_list &l): skip_list() {
+    for ( const_iterator it = l.begin(); it != l.end(); ++it ) {
+        if ( !add_at_tail(*it) ) {
+            clear();
+            throw std::bad_alloc();
+        }
+    }
+}
+
+template <class T>
+skip_list<T>& skip_list<T>::operator=(const skip_list &other) {
+    if (this != &other) {
+        skip_list tmp(other);
+        swap(tmp);
+    }
+    return *this;
+}
+
+template <class T>
+skip_list<T>& skip_list<T>::operator=(skip_list &&other) noexcept {
+    if (this != &other) {
+        skip_list tmp(std::move(other));
+        swap(tmp);
+    }
+    return *this;
+}
+
+template <class T>
+void skip_list<T>::swap(skip_list &other) noexcept {
+    std::swap(_size, other._size);
+    std::swap(_level, other._level);
+    std::swap(rng_state, other.rng_state);
+    for ( int i = 0; i < MAX_LEVEL; ++i )
+        std::swap(head_links[i], other.head_links[i]);
+}
+
+template <class T>
+T skip_list<T>::get_value(int idx) const {
+    if ( idx > _size || idx <= 0 ) return T();
+    const node_base *x = &head;
+    int pos = 0;
+    for ( int i = _level - 1; i >= 0; --i ) {
+        while ( x->forward[i].next && pos + x->forward[i].width <= idx ) {
+            pos += x->forward[i].width;
+            x = x->forward[i].next;
+        }
+        if ( pos == idx ) break;
+    }
+    return static_cast<const node*>(x)->val;
+}
+
+template <class T>
+bool skip_list<T>::add_at_index(int idx, T val) {
+    if ( idx <= 0 ) idx = 1;
+    if ( idx > _size ) idx = _size + 1;
+
+    node *n = create_node(std::move(val));
+    if ( !n ) return false;
+
+    node_base *update[MAX_LEVEL];
+    int rank[MAX_LEVEL];
+    if ( n->level > _level ) {
+        for ( int i = _level; i < n->level; ++i ) {
+            head.forward[i].next = nullptr;
+            head.forward[i].width = 0;
+        }
+        _level = n->level;
+    }
+    find_preds(idx, update, rank);
+
+    for ( int i = 0; i < _level; ++i ) {
+        link &l = update[i]->forward[i];
+        if ( i < n->level ) {
+            // 新节点插在 update[i] 与原后继之间，原后继的位置后移一位
+            n->forward[i].next = l.next;
+            n->forward[i].width = l.next ? rank[i] + l.width + 1 - idx : 0;
+            l.next = n;
+            l.width = idx - rank[i];
+        } else if ( l.next ) {
+            l.width += 1;  // 跨过了新节点
+        }
+    }
+    _size += 1;
+    return true;
+}
+
+template <class T>
+bool skip_list<T>::delete_at_index(int idx) {
+    if ( idx < 1 || idx > _size )
+        return false;
+
+    node_base *update[MAX_LEVEL];
+    int rank[MAX_LEVEL];
+    find_preds(idx, update, rank);
+    node_base *target = update[0]->forward[0].next;
+
+    for ( int i = 0; i < _level; ++i ) {
+        link &l = update[i]->forward[i];
+        if ( l.next == target ) {
+            l.next = target->forward[i].next;
+            l.width = l.next ? l.width + target->forward[i].width - 1 : 0;
+        } else if ( l.next ) {
+            l.width -= 1;
+        }
+    }
+    while ( _level > 1 && !head.forward[_level - 1].next )
+        --_level;
+
+    destroy_node(target);
+    _size -= 1;
+    return true;
+}
+
+template <class T>
+void skip_list<T>::print_all_elements() const {
+    std::cout << "here are elements at list: " << std::endl;
+    for ( const_iterator it = begin(); it != end(); ++it ) {
+        std::cout << *it << ", " ;
+    }
+    std::cout << std::endl;
+}
+
+template <class T>
+void skip_list<T>::clear() {
+    node_base *cur = head.forward[0].next;
+    while ( cur ) {
+        node_base *to_delete = cur;
+        cur = cur->forward[0].next;
+        destroy_node(to_delete);
+    }
+    reset_head();
+    _level = 1;
+    _size = 0;
+}
+
+#endif // SKIP_LIST_H
@@ -0,0 +1,324 @@
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include "linked_list.h"
+
+// ====== 展开链表（unrolled linked list） ======
+// 每个节点（块）存放最多 ChunkSize 个连续元素，遍历和按下标定位时每个块只追一次指针，
+// 块内是顺序访存。接口与 link_list 一致（1-based 下标、虚拟头节点、分配失败返回 false）。
+// - 插入到满块时把块对半分裂
+// - 删除后块与后继块合计不超过 ChunkSize 时合并，空块直接摘除
+// - 尾部追加时尾块满了直接开新块，顺序构建的链表每个块都是满的
+
+template <class T, int ChunkSize = 64, template <class> class Alloc = pool_allocator>
+class unrolled_list {
+    static_assert(ChunkSize >= 2, "ChunkSize must be at least 2");
+
+    private:
+        struct chunk_base {
+            chunk_base *next;
+            int count;
+            chunk_base(): next(nullptr), count(0) {}
+        };
+        struct chunk: chunk_base {
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type storage[ChunkSize];
+            T* at(int i) { return reinterpret_cast<T*>(&storage[i]); }
+            const T* at(int i) const { return reinterpret_cast<const T*>(&storage[i]); }
+        };
+
+        template <bool Const>
+        class iter {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef T value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef typename std::conditional<Const, const T*, T*>::type pointer;
+                typedef typename std::conditional<Const, const T&, T&>::type reference;
+
+                iter(): cur(nullptr), off(0) {}
+                explicit iter(chunk_base *c): cur(c), off(0) {}
+                template <bool C = Const, class = typename std::enable_if<C>::type>
+                iter(const iter<false> &other): cur(other.cur), off(other.off) {}
+
+                reference operator*() const { return *static_cast<chunk*>(cur)->at(off); }
+                pointer operator->() const { return static_cast<chunk*>(cur)->at(off); }
+                iter& operator++() {
+                    if ( ++off == cur->count ) {
+                        cur = cur->next;
+                        off = 0;
+                    }
+                    return *this;
+                }
+                iter operator++(int) { iter tmp(*this); ++*this; return tmp; }
+                bool operator==(const iter &other) const { return cur == other.cur && off == other.off; }
+                bool operator!=(const iter &other) const { return !(*this == other); }
+
+            private:
+                template <bool> friend class iter;
+                chunk_base *cur;
+                int off;
+        };
+
+    public:
+        typedef T value_type;
+        typedef iter<false> iterator;
+        typedef iter<true> const_iterator;
+
+        T get_value(int idx) const;      // 越界返回 T()
+        bool add_at_head(T val) { return add_at_index(1, std::move(val)); }
+        bool add_at_tail(T val);
+
+        bool add_at_index(int idx, T val);
+        bool delete_at_index(int idx);
+        void print_all_elements() const;
+
+        iterator begin() { return iterator(head.next); }
+        iterator end() { return iterator(); }
+        const_iterator begin() const { return const_iterator(head.next); }
+        const_iterator end() const { return const_iterator(); }
+
+        int size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        int chunk_count() const { return _chunks; }
+        void clear();
+
+        unrolled_list(): _size(0), _chunks(0), tail(&head) {}
+        unrolled_list(const unrolled_list &l);
+        unrolled_list(unrolled_list &&l) noexcept: _size(0), _chunks(0), tail(&head) { swap(l); }
+        unrolled_list& operator=(const unrolled_list &other);
+        unrolled_list& operator=(unrolled_list &&other) noexcept;
+        ~unrolled_list();
+
+        void swap(unrolled_list &other) noexcept;
+
+    private:
+        chunk* create_chunk() {
+            void *p = alloc.allocate();
+            if ( !p ) return nullptr;
+            _chunks += 1;
+            return new (p) chunk();
+        }
+        void destroy_chunk(chunk_base *c) {
+            chunk *ch = static_cast<chunk*>(c);
+            for ( int i = 0; i < ch->count; ++i )
+                ch->at(i)->~T();
+            ch->~chunk();
+            alloc.deallocate(ch);
+            _chunks -= 1;
+        }
+        chunk* insert_chunk_after(chunk_base *prev);
+        void unlink_next(chunk_base *prev);
+        // 找到第 idx 个元素（1-based）所在的块及块内偏移，prev 为该块的前驱
+        chunk_base* locate(int idx, chunk_base *&prev, int &off) const;
+
+        Alloc<chunk> alloc;  // 块分配器，必须在块之前构造、之后析构
+        int _size;          // 元素个数
+        int _chunks;        // 块个数
+        chunk_base head;    // 虚拟头块，不存元素
+        chunk_base *tail;   // 最后一个块，空链表时为 &head
+};
+
+template <class T, int ChunkSize, template <class> class Alloc>
+typename unrolled_list<T, ChunkSize, Alloc>::chunk*
+unrolled_list<T, ChunkSize, Alloc>::insert_chunk_after(chunk_base *prev) {
+    chunk *c = create_chunk();
+    if ( !c ) return nullptr;
+    c->next = prev->next;
+    prev->next = c;
+    if ( prev == tail )
+        tail = c;
+    return c;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+void unrolled_list<T, ChunkSize, Alloc>::unlink_next(chunk_base *prev) {
+    chunk_base *c = prev->next;
+    prev->next = c->next;
+    if ( c == tail )
+        tail = prev;
+    destroy_chunk(c);
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+typename unrolled_list<T, ChunkSize, Alloc>::chunk_base*
+unrolled_list<T, ChunkSize, Alloc>::locate(int idx, chunk_base *&prev, int &off) const {
+    chunk_base *p = const_cast<chunk_base*>(&head);
+    chunk_base *cur = p->next;
+    int pos = idx - 1;
+    while ( pos >= cur->count ) {
+        pos -= cur->count;
+        p = cur;
+        cur = cur->next;
+    }
+    prev = p;
+    off = pos;
+    return cur;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+unrolled_list<T, ChunkSize, Alloc>::unrolled_list(const unrolled_list &l): _size(0), _chunks(0), tail(&head) {
+    for ( const_iterator it = l.begin(); it != l.end(); ++it ) {
+        if ( !add_at_tail(*it) ) {
+            clear();
+            throw std::bad_alloc();
+        }
+    }
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+unrolled_list<T, ChunkSize, Alloc>&
+unrolled_list<T, ChunkSize, Alloc>::operator=(const unrolled_list &other) {
+    if (this != &other) {
+        unrolled_list tmp(other);
+        swap(tmp);
+    }
+    return *this;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+unrolled_list<T, ChunkSize, Alloc>&
+unrolled_list<T, ChunkSize, Alloc>::operator=(unrolled_list &&other) noexcept {
+    if (this != &other) {
+        unrolled_list tmp(std::move(other));
+        swap(tmp);
+    }
+    return *this;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+void unrolled_list<T, ChunkSize, Alloc>::swap(unrolled_list &other) noexcept {
+    alloc.swap(other.alloc);
+    std::swap(_size, other._size);
+    std::swap(_chunks, other._chunks);
+    std::swap(head.next, other.head.next);
+    std::swap(tail, other.tail);
+    if ( tail == &other.head ) tail = &head;
+    if ( other.tail == &head ) other.tail = &other.head;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+T unrolled_list<T, ChunkSize, Alloc>::get_value(int idx) const {
+    if ( idx > _size || idx <= 0 ) return T();
+    chunk_base *prev;
+    int off;
+    chunk_base *c = locate(idx, prev, off);
+    return *static_cast<chunk*>(c)->at(off);
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+bool unrolled_list<T, ChunkSize, Alloc>::add_at_tail(T val) {
+    chunk *c;
+    if ( tail != &head && tail->count < ChunkSize ) {
+        c = static_cast<chunk*>(tail);
+    } else {
+        c = insert_chunk_after(tail);
+        if ( !c ) return false;
+    }
+    new (c->at(c->count)) T(std::move(val));
+    c->count += 1;
+    _size += 1;
+    return true;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+bool unrolled_list<T, ChunkSize, Alloc>::add_at_index(int idx, T val) {
+    if ( idx > _size || _size == 0 )
+        return add_at_tail(std::move(val));
+    if ( idx <= 0 )
+        idx = 1;
+
+    chunk_base *prev;
+    int off;
+    chunk *c = static_cast<chunk*>(locate(idx, prev, off));
+
+    if ( c->count == ChunkSize ) {
+        // 满块对半分裂，后一半搬到新块
+        chunk *n = insert_chunk_after(c);
+        if ( !n ) return false;
+        int mid = ChunkSize / 2;
+        for ( int i = mid; i < ChunkSize; ++i ) {
+            new (n->at(i - mid)) T(std::move(*c->at(i)));
+            c->at(i)->~T();
+        }
+        n->count = ChunkSize - mid;
+        c->count = mid;
+        if ( off > mid ) {
+            c = n;
+            off -= mid;
+        }
+    }
+
+    // 块内后移腾出位置
+    if ( off == c->count ) {
+        new (c->at(off)) T(std::move(val));
+    } else {
+        new (c->at(c->count)) T(std::move(*c->at(c->count - 1)));
+        std::move_backward(c->at(off), c->at(c->count - 1), c->at(c->count));
+        *c->at(off) = std::move(val);
+    }
+    c->count += 1;
+    _size += 1;
+    return true;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+bool unrolled_list<T, ChunkSize, Alloc>::delete_at_index(int idx) {
+    if ( idx < 1 || idx > _size )
+        return false;
+
+    chunk_base *prev;
+    int off;
+    chunk *c = static_cast<chunk*>(locate(idx, prev, off));
+
+    std::move(c->at(off + 1), c->at(c->count), c->at(off));
+    c->at(c->count - 1)->~T();
+    c->count -= 1;
+    _size -= 1;
+
+    if ( c->count == 0 ) {
+        unlink_next(prev);
+        return true;
+    }
+
+    // 与后继块合并，保持块的平均填充率
+    chunk *n = static_cast<chunk*>(c->next);
+    if ( n && c->count + n->count <= ChunkSize ) {
+        for ( int i = 0; i < n->count; ++i )
+            new (c->at(c->count + i)) T(std::move(*n->at(i)));
+        c->count += n->count;
+        unlink_next(c);
+    }
+    return true;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+void unrolled_list<T, ChunkSize, Alloc>::print_all_elements() const {
+    std::cout << "here are elements at list: " << std::endl;
+    for ( const_iterator it = begin(); it != end(); ++it ) {
+        std::cout << *it << ", " ;
+    }
+    std::cout << std::endl;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+void unrolled_list<T, ChunkSize, Alloc>::clear() {
+    while ( head.next )
+        unlink_next(&head);
+    _size = 0;
+}
+
+template <class T, int ChunkSize, template <class> class Alloc>
+unrolled_list<T, ChunkSize, Alloc>::~unrolled_list() {
+    // 整块释放的分配器 + 平凡析构的元素：内存随分配器回收，不必逐个遍历
+    if ( Alloc<chunk>::bulk_release && std::is_trivially_destructible<T>::value ) return;
+    clear();
+}
+
+#endif // UNROLLED_LIST_H
@@ -0,0 +1,110 @@
+#ifndef CAPTURE_H
+#define CAPTURE_H
+
+#include <stdint.h>
+#include <string.h>
+
+// ==================== 流量捕获文件格式 ====================
+//
+// 文件头（16字节）：
+//   magic "RCAP" | version u16 | reserved u16 | start_us u64
+//
+// 之后是连续的记录，每条 = 21字节记录头 + len字节负载：
+//   ts_us u64 | conn_id u64 | type u8 | len u32 | payload...
+//
+// - 所有整数为小端序
+// - start_us 为创建文件时的 CLOCK_REALTIME 微秒（墙上时间），只作记录
+// - ts_us 为 CLOCK_MONOTONIC 微秒，不受系统时间调整影响，prefork 模式下多个worker进程写同一个文件时仍可比较；
+//   跨重启追加到同一个文件时不可比较
+// - 同一连接的记录按发生顺序出现在文件中（由同一个线程写入），回放按文件顺序执行，不按时间戳排序
+// - conn_id 高32位为进程pid，低32位为进程内递增序号，全局唯一
+// - 每条记录通过一次 O_APPEND write 写入（按批），多进程写入不会交错
+
+#define CAPTURE_MAGIC        "RCAP"
+#define CAPTURE_VERSION      1
+#define CAPTURE_FILE_HEADER  16
+#define CAPTURE_REC_HEADER   21
+
+// 记录类型
+#define CAPTURE_OPEN   1    // 新连接
+#define CAPTURE_DATA   2    // 收到的数据（负载为原始字节）
+#define CAPTURE_CLOSE  3    // 连接关闭
+
+typedef struct capture_record {
+    uint64_t ts_us;
+    uint64_t conn_id;
+    uint8_t  type;
+    uint32_t len;
+    const unsigned char* payload;   // 解码时指向文件缓冲区内部
+} capture_record_t;
+
+static inline void capture_put_u16(unsigned char* p, uint16_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+static inline void capture_put_u32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(v >> (8 * i));
+    }
+}
+
+static inline void capture_put_u64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)(v >> (8 * i));
+    }
+}
+
+static inline uint32_t capture_get_u32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline uint64_t capture_get_u64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline void capture_encode_file_header(unsigned char* buf, uint64_t start_us) {
+    memcpy(buf, CAPTURE_MAGIC, 4);
+    capture_put_u16(buf + 4, CAPTURE_VERSION);
+    capture_put_u16(buf + 6, 0);
+    capture_put_u64(buf + 8, start_us);
+}
+
+static inline void capture_encode_record_header(unsigned char* buf, uint64_t ts_us,
+                                                uint64_t conn_id, uint8_t type,
+                                                uint32_t len) {
+    capture_put_u64(buf, ts_us);
+    capture_put_u64(buf + 8, conn_id);
+    buf[16] = type;
+    capture_put_u32(buf + 17, len);
+}
+
+// 从buf[*off]解码一条记录，数据不完整或格式错误返回-1
+static inline int capture_decode_record(const unsigned char* buf, size_t size,
+                                        size_t* off, capture_record_t* rec) {
+    if (size - *off < CAPTURE_REC_HEADER) {
+        return -1;
+    }
+    const unsigned char* p = buf + *off;
+    rec->ts_us = capture_get_u64(p);
+    rec->conn_id = capture_get_u64(p + 8);
+    rec->type = p[16];
+    rec->len = capture_get_u32(p + 17);
+    if (rec->type < CAPTURE_OPEN || rec->type > CAPTURE_CLOSE ||
+        size - *off - CAPTURE_REC_HEADER < rec->len) {
+        return -1;
+    }
+    rec->payload = p + CAPTURE_REC_HEADER;
+    *off += CAPTURE_REC_HEADER + rec->len;
+    return 0;
+}
+
+#endif // CAPTURE_H
@@ -0,0 +1,381 @@
+// 基于 reactor.c 的 TCP 转发代理（splice 零拷贝）
+//
+// 每个客户端连接对应一个到上游服务的非阻塞连接，两个方向各有一根管道：
+//
+//   client --splice--> pipe c2u --splice--> upstream
+//   client <--splice-- pipe u2c <--splice-- upstream
+//
+// 数据始终留在内核中（socket缓冲区 -> 管道页 -> socket缓冲区），
+// 不像 echo_handler 那样经过 read/write 拷贝到用户态。
+//
+// 背压：某个方向的管道积压（目的端不可写）时，暂停读取该方向的源端，
+// 等目的端可写并把管道清空后再恢复读取。
+//
+// 挂断：不带 EPOLLERR 的 EPOLLHUP 表示对端已关闭，但它的socket接收缓冲区里可能还有数据，
+// 管道里也可能还有积压（背压暂停读取时收到的挂断不带 EPOLLIN）。此时按"读完再EOF"处理：
+// 继续 splice 直到读到 0，再 shutdown(SHUT_WR) 另一端。只有 EPOLLERR 或两个方向都结束时才关闭连接。
+//
+// 编译：gcc -o proxy proxy.c -lpthread
+// 运行：./proxy [listen_port] [upstream_ip] [upstream_port]
+
+#define _GNU_SOURCE
+#define REACTOR_NO_MAIN
+#include "reactor.c"
+
+#define PROXY_PORT           8082
+#define PROXY_UPSTREAM_HOST  "127.0.0.1"
+#define PROXY_UPSTREAM_PORT  PORT
+
+// 单次splice搬运的最大字节数（管道默认容量64KB）
+#define PROXY_SPLICE_CHUNK   65536
+
+typedef struct proxy_conn proxy_conn_t;
+
+// 一个socket端点（客户端侧或上游侧）
+typedef struct proxy_side {
+    proxy_conn_t* conn;
+    int fd;
+    int events;              // 当前在epoll中关注的事件
+    int hup;                 // 已收到EPOLLHUP，剩余数据由另一端的写回调驱动读取
+} proxy_side_t;
+
+// 一个方向的转发通道：src -> pipe -> dst
+typedef struct proxy_flow {
+    proxy_side_t* src;
+    proxy_side_t* dst;
+    int pipe_fds[2];         // [0]读端 [1]写端
+    size_t pending;          // 管道中尚未写往dst的字节数
+    int pipe_full;           // 管道已满，暂停读取src
+    int src_eof;             // src已读到EOF
+    int done;                // EOF已转发给dst（shutdown写端）
+} proxy_flow_t;
+
+struct proxy_conn {
+    reactor_t* reactor;
+    int connected;           // 上游连接已建立
+    proxy_side_t client;
+    proxy_side_t upstream;
+    proxy_flow_t c2u;        // 客户端 -> 上游
+    proxy_flow_t u2c;        // 上游 -> 客户端
+};
+
+static struct sockaddr_in proxy_upstream_addr;
+
+// ==================== 连接管理 ====================
+
+static void proxy_close(proxy_conn_t* conn) {
+    printf("Proxy connection closed (client fd=%d, upstream fd=%d)\n",
+           conn->client.fd, conn->upstream.fd);
+
+    // 注销后处理器会延迟到本轮事件处理完再释放，同一批中的其他事件会被跳过
+    reactor_unregister(conn->reactor, conn->client.fd);
+    reactor_unregister(conn->reactor, conn->upstream.fd);
+    close(conn->client.fd);
+    close(conn->upstream.fd);
+
+    proxy_flow_t* flows[2] = { &conn->c2u, &conn->u2c };
+    for (int i = 0; i < 2; i++) {
+        close(flows[i]->pipe_fds[0]);
+        close(flows[i]->pipe_fds[1]);
+    }
+    free(conn);
+}
+
+// 根据两个方向的状态重新计算某端需要关注的事件
+static void proxy_update_events(proxy_side_t* side) {
+    proxy_conn_t* conn = side->conn;
+    int events = 0;
+
+    if (!conn->connected) {
+        // 连接建立前只关注上游的可写事件（connect完成）
+        events = (side == &conn->upstream) ? EPOLLOUT : 0;
+    } else if (side->hup) {
+        // 挂断后 EPOLLHUP 无法屏蔽，会一直触发；改成 ONESHOT 且不再重新激活，
+        // 剩余数据在另一端可写、管道清空后由 proxy_write_handler 继续读取
+        events = EPOLLONESHOT;
+    } else {
+        proxy_flow_t* out_flow = (side == &conn->client) ? &conn->c2u : &conn->u2c;
+        proxy_flow_t* in_flow = (side == &conn->client) ? &conn->u2c : &conn->c2u;
+
+        // 作为源端：管道没满且未到EOF时才读
+        if (!out_flow->src_eof && !out_flow->pipe_full) {
+            events |= EPOLLIN;
+        }
+        // 作为目的端：管道中有积压时等待可写
+        if (in_flow->pending > 0) {
+            events |= EPOLLOUT;
+        }
+    }
+
+    if (events != side->events) {
+        side->events = events;
+        reactor_modify(conn->reactor, side->fd, events);
+    }
+}
+
+// 把管道中积压的数据写往dst，出错返回-1
+static int proxy_flush(proxy_flow_t* flow) {
+    while (flow->pending > 0) {
+        ssize_t n = splice(flow->pipe_fds[0], NULL, flow->dst->fd, NULL,
+                           flow->pending, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            flow->pending -= n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;  // dst暂时不可写，等待EPOLLOUT
+        } else {
+            return -1;
+        }
+    }
+
+    // 源端已结束且数据全部送出，把EOF传递给目的端
+    if (flow->src_eof && !flow->done) {
+        shutdown(flow->dst->fd, SHUT_WR);
+        flow->done = 1;
+    }
+    return 0;
+}
+
+// 从src读入管道，再尽量写往dst，出错返回-1
+static int proxy_pump(proxy_flow_t* flow) {
+    while (1) {
+        if (proxy_flush(flow) < 0) {
+            return -1;
+        }
+        if (flow->pending > 0) {
+            // dst跟不上，管道里还有积压：暂停读取src，等dst可写（背压）
+            flow->pipe_full = 1;
+            return 0;
+        }
+        flow->pipe_full = 0;
+        if (flow->src_eof) {
+            return 0;
+        }
+
+        ssize_t n = splice(flow->src->fd, NULL, flow->pipe_fds[1], NULL,
+                           PROXY_SPLICE_CHUNK, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+        if (n > 0) {
+            flow->pending += n;
+        } else if (n == 0) {
+            flow->src_eof = 1;  // 下一轮flush完成后把EOF传给dst
+        } else if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            return 0;           // src已读空
+        } else if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+// 两个方向都已结束时关闭连接，返回是否已关闭
+static int proxy_maybe_finish(proxy_conn_t* conn) {
+    if (conn->c2u.done && conn->u2c.done) {
+        proxy_close(conn);
+        return 1;
+    }
+    proxy_update_events(&conn->client);
+    proxy_update_events(&conn->upstream);
+    return 0;
+}
+
+// ==================== Reactor 回调 ====================
+
+void proxy_read_handler(int fd, int events, void* arg) {
+    proxy_side_t* side = (proxy_side_t*)arg;
+    proxy_conn_t* conn = side->conn;
+    (void)fd;
+
+    if (!conn->connected || (events & EPOLLERR)) {
+        // 上游连接失败，或连接出错
+        proxy_close(conn);
+        return;
+    }
+
+    proxy_flow_t* flow = (side == &conn->client) ? &conn->c2u : &conn->u2c;
+    proxy_flow_t* in_flow = (side == &conn->client) ? &conn->u2c : &conn->c2u;
+    if ((events & EPOLLHUP) && !side->hup) {
+        // 对端已关闭：不会再有EPOLLOUT，发往它的积压数据现在写不完就只能放弃
+        side->hup = 1;
+        if (proxy_flush(in_flow) < 0 || in_flow->pending > 0) {
+            proxy_close(conn);
+            return;
+        }
+    }
+
+    // 挂断时也照常读取，直到读到EOF
+    if (proxy_pump(flow) < 0) {
+        proxy_close(conn);
+        return;
+    }
+    proxy_maybe_finish(conn);
+}
+
+void proxy_write_handler(int fd, int events, void* arg) {
+    proxy_side_t* side = (proxy_side_t*)arg;
+    proxy_conn_t* conn = side->conn;
+    (void)events;
+
+    if (!conn->connected) {
+        // 非阻塞connect完成，检查结果
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+            fprintf(stderr, "Connect to upstream failed: %s\n", strerror(err));
+            proxy_close(conn);
+            return;
+        }
+        conn->connected = 1;
+        printf("Upstream connected (client fd=%d, upstream fd=%d)\n",
+               conn->client.fd, conn->upstream.fd);
+        proxy_maybe_finish(conn);
+        return;
+    }
+
+    // 目的端可写：清空积压的管道，清空后直接继续读取源端
+    // （源端已挂断时不再有读事件，只能在这里接着读）
+    proxy_flow_t* flow = (side == &conn->client) ? &conn->u2c : &conn->c2u;
+    if (proxy_pump(flow) < 0) {
+        proxy_close(conn);
+        return;
+    }
+    proxy_maybe_finish(conn);
+}
+
+static int proxy_flow_init(proxy_flow_t* flow, proxy_side_t* src, proxy_side_t* dst) {
+    memset(flow, 0, sizeof(*flow));
+    flow->src = src;
+    flow->dst = dst;
+    if (pipe2(flow->pipe_fds, O_NONBLOCK | O_CLOEXEC) < 0) {
+        perror("pipe2 failed");
+        flow->pipe_fds[0] = flow->pipe_fds[1] = -1;
+        return -1;
+    }
+    return 0;
+}
+
+void proxy_accept_handler(int fd, int events, void* arg) {
+    reactor_t* reactor = (reactor_t*)arg;
+    (void)events;
+
+    int client_fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (client_fd == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            perror("accept failed");
+        }
+        return;
+    }
+
+    int upstream_fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (upstream_fd < 0) {
+        perror("socket failed");
+        close(client_fd);
+        return;
+    }
+    if (connect(upstream_fd, (struct sockaddr*)&proxy_upstream_addr,
+                sizeof(proxy_upstream_addr)) < 0 && errno != EINPROGRESS) {
+        perror("connect to upstream failed");
+        close(upstream_fd);
+        close(client_fd);
+        return;
+    }
+
+    proxy_conn_t* conn = (proxy_conn_t*)calloc(1, sizeof(proxy_conn_t));
+    if (!conn) {
+        perror("malloc proxy connection failed");
+        close(upstream_fd);
+        close(client_fd);
+        return;
+    }
+
+    conn->reactor = reactor;
+    conn->client.conn = conn;
+    conn->client.fd = client_fd;
+    conn->upstream.conn = conn;
+    conn->upstream.fd = upstream_fd;
+
+    if (proxy_flow_init(&conn->c2u, &conn->client, &conn->upstream) < 0 ||
+        proxy_flow_init(&conn->u2c, &conn->upstream, &conn->client) < 0) {
+        close(conn->c2u.pipe_fds[0]);
+        close(conn->c2u.pipe_fds[1]);
+        close(upstream_fd);
+        close(client_fd);
+        free(conn);
+        return;
+    }
+
+    // 上游连接建立前客户端不关注任何事件（数据留在内核缓冲区里）
+    conn->client.events = 0;
+    conn->upstream.events = EPOLLOUT;
+    if (reactor_register_rw(reactor, client_fd, conn->client.events,
+                            proxy_read_handler, proxy_write_handler, &conn->client) < 0 ||
+        reactor_register_rw(reactor, upstream_fd, conn->upstream.events,
+                            proxy_read_handler, proxy_write_handler, &conn->upstream) < 0) {
+        proxy_close(conn);
+        return;
+    }
+
+    printf("Proxying client fd=%d via upstream fd=%d\n", client_fd, upstream_fd);
+}
+
+// ==================== 主函数 ====================
+
+#ifndef PROXY_NO_MAIN
+int main(int argc, char* argv[]) {
+    int port = argc > 1 ? atoi(argv[1]) : PROXY_PORT;
+    const char* upstream_host = argc > 2 ? argv[2] : PROXY_UPSTREAM_HOST;
+    int upstream_port = argc > 3 ? atoi(argv[3]) : PROXY_UPSTREAM_PORT;
+
+    printf("=== Reactor Splice Proxy ===\n");
+
+    memset(&proxy_upstream_addr, 0, sizeof(proxy_upstream_addr));
+    proxy_upstream_addr.sin_family = AF_INET;
+    proxy_upstream_addr.sin_port = htons(upstream_port);
+    if (inet_pton(AF_INET, upstream_host, &proxy_upstream_addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid upstream address: %s\n", upstream_host);
+        return 1;
+    }
+
+    // 对端重置后继续splice写会触发SIGPIPE，改为返回EPIPE
+    signal(SIGPIPE, SIG_IGN);
+
+    reactor_t* reactor = reactor_create();
+    if (!reactor) {
+        return 1;
+    }
+
+    int server_fd = create_server_socket(port);
+    if (server_fd < 0 || set_nonblocking(server_fd) < 0 ||
+        reactor_register(reactor, server_fd, EPOLLIN, proxy_accept_handler, reactor) < 0 ||
+        reactor_start(reactor) < 0) {
+        fprintf(stderr, "Failed to start proxy\n");
+        if (server_fd >= 0) {
+            close(server_fd);
+        }
+        reactor_destroy(reactor);
+        return 1;
+    }
+
+    printf("\nProxy %d -> %s:%d is running. Press 'q' + Enter to quit.\n",
+           port, upstream_host, upstream_port);
+
+    int cmd;
+    while ((cmd = getchar()) != EOF) {
+        if (cmd == 'q' || cmd == 'Q') {
+            break;
+        }
+    }
+
+    printf("\nShutting down proxy...\n");
+    reactor_unregister(reactor, server_fd);
+    close(server_fd);
+    reactor_stop(reactor);
+
+    // 关闭剩余的代理连接（每个连接占用两个处理器）
+    while (reactor->handlers) {
+        proxy_close(((proxy_side_t*)reactor->handlers->arg)->conn);
+    }
+    reactor_destroy(reactor);
+    printf("Proxy shutdown complete.\n");
+    return 0;
+}
+#endif // PROXY_NO_MAIN
@@ -0,0 +1,160 @@
+// proxy.c 的大流量转发测试
+//
+// 在同一个进程里启动：
+// - 上游回显服务（阻塞socket，读到EOF后写完剩余数据就关闭连接）
+// - proxy.c 的 reactor 代理
+// - 客户端：一个线程发送 20MB 数据后 shutdown(SHUT_WR)，主线程小块慢速读取
+//
+// 客户端读得慢时，上游方向的管道长期积压（pipe_full），上游在此期间发完数据并关闭，
+// 代理收到的是不带 EPOLLIN 的 EPOLLHUP。代理必须把管道和上游socket中剩余的数据
+// 全部转发完再关闭，客户端收到的字节数和内容都要与发送的一致。
+//
+// 编译：gcc -O2 -o proxy_test proxy_test.c -lpthread
+// 运行：./proxy_test [MB数]      默认 20，成功返回 0
+
+#define PROXY_NO_MAIN
+#include "proxy.c"
+
+#define TEST_CHUNK       16384
+#define TEST_READ_DELAY  200      // 慢速读取：每次读取后休眠的微秒数
+
+static size_t test_total;
+
+static unsigned char test_byte(size_t i) {
+    return (unsigned char)(i * 131 + (i >> 16));
+}
+
+static int test_listen_any(int* port) {
+    int fd = create_server_socket(0);
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    if (fd < 0 || getsockname(fd, (struct sockaddr*)&addr, &len) < 0) {
+        return -1;
+    }
+    *port = ntohs(addr.sin_port);
+    return fd;
+}
+
+static int test_write_all(int fd, const unsigned char* buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += n;
+        len -= n;
+    }
+    return 0;
+}
+
+// 上游回显服务：只服务一个连接
+static void* test_echo_thread(void* arg) {
+    int listen_fd = *(int*)arg;
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+        perror("echo accept failed");
+        return NULL;
+    }
+    unsigned char buf[TEST_CHUNK];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        if (test_write_all(fd, buf, n) < 0) {
+            break;
+        }
+    }
+    close(fd);
+    return NULL;
+}
+
+static void* test_sender_thread(void* arg) {
+    int fd = *(int*)arg;
+    unsigned char buf[TEST_CHUNK];
+    for (size_t sent = 0; sent < test_total; ) {
+        size_t len = test_total - sent < sizeof(buf) ? test_total - sent : sizeof(buf);
+        for (size_t i = 0; i < len; i++) {
+            buf[i] = test_byte(sent + i);
+        }
+        if (test_write_all(fd, buf, len) < 0) {
+            perror("send failed");
+            break;
+        }
+        sent += len;
+    }
+    shutdown(fd, SHUT_WR);
+    return NULL;
+}
+
+int main(int argc, char* argv[]) {
+    test_total = (size_t)(argc > 1 ? atoi(argv[1]) : 20) << 20;
+    signal(SIGPIPE, SIG_IGN);
+
+    int echo_port, proxy_port;
+    int echo_fd = test_listen_any(&echo_port);
+    int server_fd = test_listen_any(&proxy_port);
+    if (echo_fd < 0 || server_fd < 0 || set_nonblocking(server_fd) < 0) {
+        fprintf(stderr, "Failed to create listening sockets\n");
+        return 1;
+    }
+
+    memset(&proxy_upstream_addr, 0, sizeof(proxy_upstream_addr));
+    proxy_upstream_addr.sin_family = AF_INET;
+    proxy_upstream_addr.sin_port = htons(echo_port);
+    proxy_upstream_addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    reactor_t* reactor = reactor_create();
+    if (!reactor ||
+        reactor_register(reactor, server_fd, EPOLLIN, proxy_accept_handler, reactor) < 0 ||
+        reactor_start(reactor) < 0) {
+        fprintf(stderr, "Failed to start proxy\n");
+        return 1;
+    }
+
+    pthread_t echo_tid, sender_tid;
+    pthread_create(&echo_tid, NULL, test_echo_thread, &echo_fd);
+
+    int client_fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(proxy_port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (connect(client_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect to proxy failed");
+        return 1;
+    }
+    pthread_create(&sender_tid, NULL, test_sender_thread, &client_fd);
+
+    // 慢速读取并逐字节校验
+    unsigned char buf[TEST_CHUNK];
+    size_t received = 0;
+    int corrupt = 0;
+    ssize_t n;
+    while ((n = read(client_fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n && !corrupt; i++) {
+            if (buf[i] != test_byte(received + i)) {
+                fprintf(stderr, "Data mismatch at byte %zu\n", received + i);
+                corrupt = 1;
+            }
+        }
+        received += n;
+        usleep(TEST_READ_DELAY);
+    }
+
+    pthread_join(sender_tid, NULL);
+    pthread_join(echo_tid, NULL);
+    close(client_fd);
+    close(echo_fd);
+
+    reactor_unregister(reactor, server_fd);
+    close(server_fd);
+    reactor_stop(reactor);
+    while (reactor->handlers) {
+        proxy_close(((proxy_side_t*)reactor->handlers->arg)->conn);
+    }
+    reactor_destroy(reactor);
+
+    int ok = !corrupt && received == test_total;
+    printf("\nSent %zu bytes, received %zu bytes: %s\n", test_total, received, ok ? "OK" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,581 @@
+// 基于 reactor.c 的发布/订阅（pub/sub）服务器
+//
+// 文本协议（每条命令一行，可以直接用 nc 测试）：
+//   SUB <topic>             订阅主题
+//   UNSUB <topic>           取消订阅
+//   PUB <topic> <message>   发布消息
+//   STATS                   查看服务器统计
+// 订阅者收到：MSG <topic> <message>
+//
+// 扇出设计：
+// - 每条发布的消息只格式化、存储一次（引用计数的 pubsub_msg_t）
+// - 投递给订阅者时只把指针放进各自的输出队列并增加引用计数，不做逐个拷贝
+// - 输出队列有界，慢订阅者队列满时按策略丢弃最旧的消息（drop）或断开（disconnect）
+// - 所有状态只在Reactor线程中访问，因此引用计数不需要原子操作
+//
+// 编译：gcc -O2 -o pubsub pubsub.c -lpthread
+// 运行：./pubsub [port] [drop|disconnect] [queue_limit]
+
+#define _GNU_SOURCE
+#define REACTOR_NO_MAIN
+#include "reactor.c"
+
+#define PUBSUB_PORT          8083
+#define PUBSUB_QUEUE_LIMIT   1024        // 每个订阅者最多排队的消息数
+#define PUBSUB_MAX_LINE      65536       // 单条命令最大长度
+#define PUBSUB_TOPIC_BUCKETS 4096
+#define PUBSUB_WRITEV_BATCH  64          // 一次writev最多合并的消息数
+
+// 慢订阅者策略
+enum {
+    POLICY_DROP_OLDEST,
+    POLICY_DISCONNECT
+};
+
+// ==================== 共享消息 ====================
+
+// 一条已格式化的消息，被所有订阅者的输出队列共享
+typedef struct pubsub_msg {
+    int refcnt;
+    size_t len;
+    char data[];         // "MSG <topic> <message>\n"
+} pubsub_msg_t;
+
+static pubsub_msg_t* msg_create(const char* topic, size_t topic_len,
+                                const char* payload, size_t payload_len) {
+    size_t len = 4 + topic_len + 1 + payload_len + 1;
+    pubsub_msg_t* msg = (pubsub_msg_t*)malloc(sizeof(pubsub_msg_t) + len);
+    if (!msg) {
+        return NULL;
+    }
+    msg->refcnt = 1;  // 发布者持有的引用，扇出完成后释放
+    msg->len = len;
+
+    char* p = msg->data;
+    memcpy(p, "MSG ", 4);
+    p += 4;
+    memcpy(p, topic, topic_len);
+    p += topic_len;
+    *p++ = ' ';
+    memcpy(p, payload, payload_len);
+    p += payload_len;
+    *p = '\n';
+    return msg;
+}
+
+static void msg_release(pubsub_msg_t* msg) {
+    if (--msg->refcnt == 0) {
+        free(msg);
+    }
+}
+
+// ==================== 连接与主题 ====================
+
+typedef struct pubsub_topic pubsub_topic_t;
+
+typedef struct pubsub_conn {
+    reactor_t* reactor;
+    int fd;
+    int want_write;                  // 是否已关注EPOLLOUT
+
+    // 输入缓冲区（按行拆分命令）
+    char in[PUBSUB_MAX_LINE];
+    size_t in_len;
+
+    // 输出队列：环形数组，存放共享消息指针
+    pubsub_msg_t** queue;
+    size_t queue_head;
+    size_t queue_len;
+    size_t head_sent;                // 队首消息已发送的字节数
+
+    // 已订阅的主题
+    pubsub_topic_t** topics;
+    size_t ntopics;
+    size_t topics_cap;
+
+    uint64_t dropped;                // 因队列满丢弃的消息数
+} pubsub_conn_t;
+
+struct pubsub_topic {
+    char* name;
+    size_t name_len;
+    pubsub_conn_t** subs;
+    size_t nsubs;
+    size_t subs_cap;
+    struct pubsub_topic* next;       // 哈希桶链表
+};
+
+static struct {
+    pubsub_topic_t* buckets[PUBSUB_TOPIC_BUCKETS];
+    int policy;
+    size_t queue_limit;
+    uint64_t connections;
+    uint64_t topics;
+    uint64_t published;
+    uint64_t delivered;
+    uint64_t dropped;
+    uint64_t slow_disconnects;
+} broker;
+
+static size_t topic_hash(const char* name, size_t len) {
+    size_t h = 14695981039346656037ULL;  // FNV-1a
+    for (size_t i = 0; i < len; i++) {
+        h = (h ^ (unsigned char)name[i]) * 1099511628211ULL;
+    }
+    return h % PUBSUB_TOPIC_BUCKETS;
+}
+
+static pubsub_topic_t* topic_find(const char* name, size_t len) {
+    pubsub_topic_t* t = broker.buckets[topic_hash(name, len)];
+    while (t && !(t->name_len == len && memcmp(t->name, name, len) == 0)) {
+        t = t->next;
+    }
+    return t;
+}
+
+static pubsub_topic_t* topic_get_or_create(const char* name, size_t len) {
+    pubsub_topic_t* t = topic_find(name, len);
+    if (t) {
+        return t;
+    }
+
+    t = (pubsub_topic_t*)calloc(1, sizeof(pubsub_topic_t));
+    if (!t || !(t->name = (char*)malloc(len))) {
+        free(t);
+        return NULL;
+    }
+    memcpy(t->name, name, len);
+    t->name_len = len;
+
+    size_t b = topic_hash(name, len);
+    t->next = broker.buckets[b];
+    broker.buckets[b] = t;
+    broker.topics++;
+    return t;
+}
+
+// 没有订阅者的主题直接删除
+static void topic_release_if_empty(pubsub_topic_t* t) {
+    if (t->nsubs > 0) {
+        return;
+    }
+    pubsub_topic_t** pp = &broker.buckets[topic_hash(t->name, t->name_len)];
+    while (*pp != t) {
+        pp = &(*pp)->next;
+    }
+    *pp = t->next;
+    broker.topics--;
+    free(t->subs);
+    free(t->name);
+    free(t);
+}
+
+static int grow_array(void** arr, size_t* cap, size_t elem) {
+    size_t new_cap = *cap ? *cap * 2 : 4;
+    void* p = realloc(*arr, new_cap * elem);
+    if (!p) {
+        return -1;
+    }
+    *arr = p;
+    *cap = new_cap;
+    return 0;
+}
+
+static int conn_is_subscribed(pubsub_conn_t* conn, pubsub_topic_t* t) {
+    for (size_t i = 0; i < conn->ntopics; i++) {
+        if (conn->topics[i] == t) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int subscribe(pubsub_conn_t* conn, const char* name, size_t len) {
+    pubsub_topic_t* t = topic_get_or_create(name, len);
+    if (!t) {
+        return -1;
+    }
+    if (conn_is_subscribed(conn, t)) {
+        return 0;
+    }
+    if ((t->nsubs == t->subs_cap &&
+         grow_array((void**)&t->subs, &t->subs_cap, sizeof(pubsub_conn_t*)) < 0) ||
+        (conn->ntopics == conn->topics_cap &&
+         grow_array((void**)&conn->topics, &conn->topics_cap, sizeof(pubsub_topic_t*)) < 0)) {
+        topic_release_if_empty(t);
+        return -1;
+    }
+    t->subs[t->nsubs++] = conn;
+    conn->topics[conn->ntopics++] = t;
+    return 0;
+}
+
+static void unsubscribe_topic(pubsub_conn_t* conn, pubsub_topic_t* t) {
+    for (size_t i = 0; i < t->nsubs; i++) {
+        if (t->subs[i] == conn) {
+            t->subs[i] = t->subs[--t->nsubs];  // 交换删除，订阅者顺序无关紧要
+            break;
+        }
+    }
+    for (size_t i = 0; i < conn->ntopics; i++) {
+        if (conn->topics[i] == t) {
+            conn->topics[i] = conn->topics[--conn->ntopics];
+            break;
+        }
+    }
+    topic_release_if_empty(t);
+}
+
+static void conn_close(pubsub_conn_t* conn) {
+    broker.connections--;
+    printf("Pubsub client fd=%d disconnected (dropped %llu messages)\n",
+           conn->fd, (unsigned long long)conn->dropped);
+
+    while (conn->ntopics > 0) {
+        unsubscribe_topic(conn, conn->topics[conn->ntopics - 1]);
+    }
+    for (size_t i = 0; i < conn->queue_len; i++) {
+        msg_release(conn->queue[(conn->queue_head + i) % broker.queue_limit]);
+    }
+
+    reactor_unregister(conn->reactor, conn->fd);
+    close(conn->fd);
+    free(conn->topics);
+    free(conn->queue);
+    free(conn);
+}
+
+// ==================== 输出队列 ====================
+
+static void conn_set_want_write(pubsub_conn_t* conn, int want) {
+    if (conn->want_write != want) {
+        conn->want_write = want;
+        reactor_modify(conn->reactor, conn->fd, want ? (EPOLLIN | EPOLLOUT) : EPOLLIN);
+    }
+}
+
+// 尽量把输出队列写进socket，连接出错返回-1
+static int conn_flush(pubsub_conn_t* conn) {
+    while (conn->queue_len > 0) {
+        struct iovec iov[PUBSUB_WRITEV_BATCH];
+        int n_iov = 0;
+        for (size_t i = 0; i < conn->queue_len && n_iov < PUBSUB_WRITEV_BATCH; i++) {
+            pubsub_msg_t* msg = conn->queue[(conn->queue_head + i) % broker.queue_limit];
+            size_t skip = (i == 0) ? conn->head_sent : 0;
+            iov[n_iov].iov_base = msg->data + skip;
+            iov[n_iov].iov_len = msg->len - skip;
+            n_iov++;
+        }
+
+        ssize_t n = writev(conn->fd, iov, n_iov);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                conn_set_want_write(conn, 1);
+                return 0;
+            }
+            return -1;
+        }
+
+        // 出队已完整写出的消息
+        size_t written = (size_t)n;
+        while (written > 0) {
+            pubsub_msg_t* msg = conn->queue[conn->queue_head];
+            size_t remain = msg->len - conn->head_sent;
+            if (written < remain) {
+                conn->head_sent += written;
+                break;
+            }
+            written -= remain;
+            conn->head_sent = 0;
+            conn->queue_head = (conn->queue_head + 1) % broker.queue_limit;
+            conn->queue_len--;
+            msg_release(msg);
+        }
+    }
+
+    conn_set_want_write(conn, 0);
+    return 0;
+}
+
+// 把消息放入订阅者的输出队列，按policy应断开该订阅者时返回-1
+static int conn_enqueue(pubsub_conn_t* conn, pubsub_msg_t* msg, int policy) {
+    if (conn->queue_len == broker.queue_limit) {
+        if (policy == POLICY_DISCONNECT) {
+            broker.slow_disconnects++;
+            return -1;
+        }
+
+        // 丢弃最旧的一条；队首若已发出一部分则保留它，丢弃下一条，保证消息完整
+        size_t victim = conn->head_sent > 0 ? 1 : 0;
+        size_t idx = (conn->queue_head + victim) % broker.queue_limit;
+        msg_release(conn->queue[idx]);
+        if (victim == 1) {
+            conn->queue[idx] = conn->queue[conn->queue_head];
+            conn->queue[conn->queue_head] = NULL;
+        }
+        conn->queue_head = (conn->queue_head + 1) % broker.queue_limit;
+        conn->queue_len--;
+        conn->dropped++;
+        broker.dropped++;
+    }
+
+    msg->refcnt++;
+    conn->queue[(conn->queue_head + conn->queue_len) % broker.queue_limit] = msg;
+    conn->queue_len++;
+    broker.delivered++;
+    return 0;
+}
+
+// ==================== 命令处理 ====================
+
+static void conn_reply(pubsub_conn_t* conn, const char* text) {
+    pubsub_msg_t* msg = (pubsub_msg_t*)malloc(sizeof(pubsub_msg_t) + strlen(text));
+    if (!msg) {
+        return;
+    }
+    msg->refcnt = 1;
+    msg->len = strlen(text);
+    memcpy(msg->data, text, msg->len);
+    conn_enqueue(conn, msg, POLICY_DROP_OLDEST);
+    broker.delivered--;  // 控制回复不计入投递统计
+    msg_release(msg);
+}
+
+// publisher正在处理命令，不能在这里被关闭：它同时订阅该主题时只按丢弃策略处理
+static void publish(pubsub_conn_t* publisher, const char* topic, size_t topic_len, const char* payload, size_t payload_len) {
+    broker.published++;
+
+    pubsub_topic_t* t = topic_find(topic, topic_len);
+    if (!t || t->nsubs == 0) {
+        return;
+    }
+
+    pubsub_msg_t* msg = msg_create(topic, topic_len, payload, payload_len);
+    if (!msg) {
+        perror("malloc message failed");
+        return;
+    }
+
+    // 先全部入队，再逐个尝试写出；入队阶段可能因策略断开订阅者（会修改t->subs）
+    for (size_t i = 0; i < t->nsubs; ) {
+        pubsub_conn_t* sub = t->subs[i];
+        int policy = (sub == publisher) ? POLICY_DROP_OLDEST : broker.policy;
+        if (conn_enqueue(sub, msg, policy) < 0) {
+            printf("Slow subscriber fd=%d exceeded queue limit, disconnecting\n", sub->fd);
+            int last = (t->nsubs == 1);
+            conn_close(sub);  // 交换删除会把最后一个订阅者移到位置i
+            if (last) {
+                break;        // 主题已随最后一个订阅者被删除
+            }
+            continue;
+        }
+        i++;
+    }
+
+    t = topic_find(topic, topic_len);
+    for (size_t i = 0; t && i < t->nsubs; ) {
+        pubsub_conn_t* sub = t->subs[i];
+        // 队列之前为空的订阅者直接写；已有积压的等EPOLLOUT统一写；
+        // 发布者自己在读回调结束时写出
+        if (sub != publisher && !sub->want_write && conn_flush(sub) < 0) {
+            int last = (t->nsubs == 1);
+            conn_close(sub);
+            if (last) {
+                break;
+            }
+            continue;
+        }
+        i++;
+    }
+
+    msg_release(msg);
+}
+
+// 处理一行命令
+static void handle_command(pubsub_conn_t* conn, char* line, size_t len) {
+    if (len > 0 && line[len - 1] == '\r') {
+        len--;
+    }
+
+    if (len > 4 && memcmp(line, "SUB ", 4) == 0) {
+        if (subscribe(conn, line + 4, len - 4) < 0) {
+            conn_reply(conn, "ERR subscribe failed\n");
+        } else {
+            conn_reply(conn, "OK\n");
+        }
+    } else if (len > 6 && memcmp(line, "UNSUB ", 6) == 0) {
+        pubsub_topic_t* t = topic_find(line + 6, len - 6);
+        if (t && conn_is_subscribed(conn, t)) {
+            unsubscribe_topic(conn, t);
+        }
+        conn_reply(conn, "OK\n");
+    } else if (len > 4 && memcmp(line, "PUB ", 4) == 0) {
+        char* topic = line + 4;
+        char* space = (char*)memchr(topic, ' ', len - 4);
+        if (!space) {
+            conn_reply(conn, "ERR usage: PUB <topic> <message>\n");
+        } else {
+            size_t topic_len = space - topic;
+            publish(conn, topic, topic_len, space + 1, len - 4 - topic_len - 1);
+        }
+    } else if (len == 5 && memcmp(line, "STATS", 5) == 0) {
+        char text[256];
+        snprintf(text, sizeof(text),
+                 "STATS connections=%llu topics=%llu published=%llu delivered=%llu "
+                 "dropped=%llu slow_disconnects=%llu\n",
+                 (unsigned long long)broker.connections, (unsigned long long)broker.topics,
+                 (unsigned long long)broker.published, (unsigned long long)broker.delivered,
+                 (unsigned long long)broker.dropped, (unsigned long long)broker.slow_disconnects);
+        conn_reply(conn, text);
+    } else if (len > 0) {
+        conn_reply(conn, "ERR unknown command\n");
+    }
+}
+
+// ==================== Reactor 回调 ====================
+
+void pubsub_read_handler(int fd, int events, void* arg) {
+    pubsub_conn_t* conn = (pubsub_conn_t*)arg;
+    (void)events;
+
+    ssize_t n = read(fd, conn->in + conn->in_len, sizeof(conn->in) - conn->in_len);
+    if (n <= 0) {
+        if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+            return;
+        }
+        conn_close(conn);
+        return;
+    }
+    conn->in_len += n;
+
+    // 逐行处理
+    size_t start = 0;
+    while (1) {
+        char* nl = (char*)memchr(conn->in + start, '\n', conn->in_len - start);
+        if (!nl) {
+            break;
+        }
+        size_t len = nl - (conn->in + start);
+        handle_command(conn, conn->in + start, len);
+        start += len + 1;
+    }
+
+    if (start > 0) {
+        memmove(conn->in, conn->in + start, conn->in_len - start);
+        conn->in_len -= start;
+    }
+    if (conn->in_len == sizeof(conn->in)) {
+        fprintf(stderr, "Command too long on fd=%d, disconnecting\n", fd);
+        conn_close(conn);
+        return;
+    }
+
+    // 命令的回复已入队，尝试写出
+    if (!conn->want_write && conn_flush(conn) < 0) {
+        conn_close(conn);
+    }
+}
+
+void pubsub_write_handler(int fd, int events, void* arg) {
+    pubsub_conn_t* conn = (pubsub_conn_t*)arg;
+    (void)fd;
+    (void)events;
+
+    if (conn_flush(conn) < 0) {
+        conn_close(conn);
+    }
+}
+
+void pubsub_accept_handler(int fd, int events, void* arg) {
+    reactor_t* reactor = (reactor_t*)arg;
+    (void)events;
+
+    int client_fd = accept4(fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (client_fd == -1) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            perror("accept failed");
+        }
+        return;
+    }
+
+    pubsub_conn_t* conn = (pubsub_conn_t*)calloc(1, sizeof(pubsub_conn_t));
+    if (conn) {
+        conn->queue = (pubsub_msg_t**)calloc(broker.queue_limit, sizeof(pubsub_msg_t*));
+    }
+    if (!conn || !conn->queue) {
+        perror("malloc pubsub connection failed");
+        free(conn);
+        close(client_fd);
+        return;
+    }
+    conn->reactor = reactor;
+    conn->fd = client_fd;
+
+    if (reactor_register_rw(reactor, client_fd, EPOLLIN,
+                            pubsub_read_handler, pubsub_write_handler, conn) < 0) {
+        close(client_fd);
+        free(conn->queue);
+        free(conn);
+        return;
+    }
+    broker.connections++;
+}
+
+// ==================== 主函数 ====================
+
+int main(int argc, char* argv[]) {
+    int port = argc > 1 ? atoi(argv[1]) : PUBSUB_PORT;
+    broker.policy = (argc > 2 && strcmp(argv[2], "disconnect") == 0)
+                        ? POLICY_DISCONNECT : POLICY_DROP_OLDEST;
+    broker.queue_limit = argc > 3 ? (size_t)atol(argv[3]) : PUBSUB_QUEUE_LIMIT;
+    if (broker.queue_limit < 2) {
+        broker.queue_limit = 2;
+    }
+
+    printf("=== Reactor Pub/Sub Broker ===\n");
+    signal(SIGPIPE, SIG_IGN);
+
+    reactor_t* reactor = reactor_create();
+    if (!reactor) {
+        return 1;
+    }
+
+    int server_fd = create_server_socket(port);
+    if (server_fd < 0 || set_nonblocking(server_fd) < 0 ||
+        reactor_register(reactor, server_fd, EPOLLIN, pubsub_accept_handler, reactor) < 0 ||
+        reactor_start(reactor) < 0) {
+        fprintf(stderr, "Failed to start broker\n");
+        if (server_fd >= 0) {
+            close(server_fd);
+        }
+        reactor_destroy(reactor);
+        return 1;
+    }
+
+    printf("\nBroker is running on port %d (slow subscriber policy: %s, queue limit: %zu).\n",
+           port, broker.policy == POLICY_DISCONNECT ? "disconnect" : "drop oldest",
+           broker.queue_limit);
+    printf("Press 'q' + Enter to quit.\n");
+
+    int cmd;
+    while ((cmd = getchar()) != EOF) {
+        if (cmd == 'q' || cmd == 'Q') {
+            break;
+        }
+    }
+
+    printf("\nShutting down broker...\n");
+    reactor_unregister(reactor, server_fd);
+    close(server_fd);
+    reactor_stop(reactor);
+
+    while (reactor->handlers) {
+        conn_close((pubsub_conn_t*)reactor->handlers->arg);
+    }
+    reactor_destroy(reactor);
+    printf("Broker shutdown complete.\n");
+    return 0;
+}
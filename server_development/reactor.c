@@ -9,11 +9,28 @@
 #include <sys/epoll.h>
 #include <fcntl.h>
 #include <pthread.h>
+#include <signal.h>
+#include <poll.h>
+#include <time.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/signalfd.h>
+#include <sys/prctl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+
+#include "capture.h"
 
 #define MAX_EVENTS 64
 #define BUFFER_SIZE 1024
 #define PORT 8080
 
+#define MAX_WORKERS 64                              // prefork模式最大工作进程数
+#define MAX_LISTEN_FDS 8                            // 热升级时最多传递的监听fd数
+#define UPGRADE_SOCK_PATH "/tmp/reactor_server.sock" // 热升级使用的Unix socket
+#define DRAIN_TIMEOUT_MS 30000                      // 工作进程退出前等待连接结束的最长时间
+#define CAPTURE_BUFFER_SIZE (64 * 1024)             // 捕获记录的写缓冲区大小
+
 // ==================== 数据结构定义 ====================
 
 // 事件处理器类型定义
@@ -25,6 +42,7 @@ typedef struct event_handler {
     event_callback_t read_cb;    // 读事件回调
     event_callback_t write_cb;   // 写事件回调
     void* arg;                   // 回调函数参数
+    int removed;                 // 已注销标志（延迟释放，避免回调中释放后再访问）
     struct event_handler* next;  // 用于连接多个处理器（可选）
 } event_handler_t;
 
@@ -34,6 +52,7 @@ typedef struct reactor {
     int running;                   // 运行标志
     pthread_t thread_id;           // Reactor线程ID
     event_handler_t* handlers;     // 事件处理器链表（可选）
+    event_handler_t* garbage;      // 已注销、待本轮事件处理完后释放的处理器
     pthread_mutex_t lock;          // 线程安全锁
 } reactor_t;
 
@@ -58,6 +77,7 @@ reactor_t* reactor_create() {
     // 初始化其他字段
     reactor->running = 0;
     reactor->handlers = NULL;
+    reactor->garbage = NULL;
     reactor->thread_id = 0;
     
     // 初始化互斥锁
@@ -72,9 +92,10 @@ reactor_t* reactor_create() {
     return reactor;
 }
 
-// 注册事件处理器到Reactor
-int reactor_register(reactor_t* reactor, int fd, int events, 
-                    event_callback_t callback, void* arg) {
+// 注册事件处理器到Reactor（分别指定读/写回调）
+int reactor_register_rw(reactor_t* reactor, int fd, int events,
+                        event_callback_t read_cb, event_callback_t write_cb,
+                        void* arg) {
     if (!reactor || fd < 0) {
         return -1;
     }
@@ -88,9 +109,10 @@ int reactor_register(reactor_t* reactor, int fd, int events,
     
     // 初始化处理器
     handler->fd = fd;
-    handler->read_cb = callback;  // 简化：一个回调处理所有事件
-    handler->write_cb = NULL;     // 如果需要可以扩展
+    handler->read_cb = read_cb;
+    handler->write_cb = write_cb;
     handler->arg = arg;
+    handler->removed = 0;
     handler->next = NULL;
     
     // 创建epoll事件
@@ -115,6 +137,40 @@ int reactor_register(reactor_t* reactor, int fd, int events,
     return 0;
 }
 
+// 注册事件处理器到Reactor（一个回调处理所有事件）
+int reactor_register(reactor_t* reactor, int fd, int events, 
+                    event_callback_t callback, void* arg) {
+    return reactor_register_rw(reactor, fd, events, callback, NULL, arg);
+}
+
+// 修改已注册fd关注的事件（例如有数据待发送时加上EPOLLOUT）
+// epoll_ctl本身是线程安全的，可以在工作线程中调用
+int reactor_modify(reactor_t* reactor, int fd, int events) {
+    if (!reactor || fd < 0) {
+        return -1;
+    }
+    
+    pthread_mutex_lock(&reactor->lock);
+    event_handler_t* handler = reactor->handlers;
+    while (handler && handler->fd != fd) {
+        handler = handler->next;
+    }
+    
+    int ret = -1;
+    if (handler) {
+        struct epoll_event ev;
+        ev.events = events;
+        ev.data.ptr = handler;
+        ret = epoll_ctl(reactor->epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+        if (ret == -1) {
+            perror("epoll_ctl MOD failed");
+        }
+    }
+    pthread_mutex_unlock(&reactor->lock);
+    
+    return ret;
+}
+
 // 注销事件处理器
 int reactor_unregister(reactor_t* reactor, int fd) {
     if (!reactor) {
@@ -139,7 +195,11 @@ int reactor_unregister(reactor_t* reactor, int fd) {
             } else {
                 reactor->handlers = curr->next;
             }
-            free(curr);
+            // 同一批就绪事件中可能还有指向该处理器的事件，
+            // 因此不能立即free，先挂到garbage链表，本轮处理完后统一释放
+            curr->removed = 1;
+            curr->next = reactor->garbage;
+            reactor->garbage = curr;
             break;
         }
         prev = curr;
@@ -151,6 +211,20 @@ int reactor_unregister(reactor_t* reactor, int fd) {
     return 0;
 }
 
+// 释放已注销的处理器
+static void reactor_free_garbage(reactor_t* reactor) {
+    pthread_mutex_lock(&reactor->lock);
+    event_handler_t* handler = reactor->garbage;
+    reactor->garbage = NULL;
+    pthread_mutex_unlock(&reactor->lock);
+    
+    while (handler) {
+        event_handler_t* next = handler->next;
+        free(handler);
+        handler = next;
+    }
+}
+
 // Reactor事件循环（线程函数）
 void* reactor_event_loop(void* arg) {
     reactor_t* reactor = (reactor_t*)arg;
@@ -173,30 +247,44 @@ void* reactor_event_loop(void* arg) {
         // 处理就绪事件
         for (int i = 0; i < nfds; i++) {
             event_handler_t* handler = (event_handler_t*)events[i].data.ptr;
-            if (!handler) {
+            if (!handler || handler->removed) {
                 continue;
             }
             
             // 检查事件类型并调用相应的回调
-            if (events[i].events & EPOLLIN) {
+            // 错误和挂断事件也交给读回调：此时read()返回0或-1，由回调负责清理连接
+            if (events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
                 if (handler->read_cb) {
                     handler->read_cb(handler->fd, events[i].events, handler->arg);
                 }
             }
             
+            // 读回调可能已经关闭并注销了该连接
+            if (handler->removed) {
+                continue;
+            }
+            
             if (events[i].events & EPOLLOUT) {
                 if (handler->write_cb) {
                     handler->write_cb(handler->fd, events[i].events, handler->arg);
                 }
             }
             
-            // 处理错误和挂断事件
-            if (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP)) {
-                printf("Error or hangup on fd=%d, closing\n", handler->fd);
-                reactor_unregister(reactor, handler->fd);
-                close(handler->fd);
+            if (handler->removed) {
+                continue;
+            }
+            
+            // 没有读回调的处理器，由Reactor直接关闭
+            if (!handler->read_cb &&
+                (events[i].events & (EPOLLERR | EPOLLHUP | EPOLLRDHUP))) {
+                int fd = handler->fd;
+                printf("Error or hangup on fd=%d, closing\n", fd);
+                reactor_unregister(reactor, fd);
+                close(fd);
             }
         }
+        
+        reactor_free_garbage(reactor);
     }
     
     printf("Reactor event loop stopped\n");
@@ -258,6 +346,7 @@ void reactor_destroy(reactor_t* reactor) {
     }
     reactor->handlers = NULL;
     pthread_mutex_unlock(&reactor->lock);
+    reactor_free_garbage(reactor);
     
     // 关闭epoll
     if (reactor->epoll_fd >= 0) {
@@ -273,6 +362,151 @@ void reactor_destroy(reactor_t* reactor) {
     printf("Reactor destroyed\n");
 }
 
+// ==================== 通用工具函数 ====================
+
+// 设置文件描述符为非阻塞模式
+int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL, 0);
+    if (flags == -1) {
+        perror("fcntl F_GETFL");
+        return -1;
+    }
+    if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) == -1) {
+        perror("fcntl F_SETFL");
+        return -1;
+    }
+    return 0;
+}
+
+// ==================== 流量捕获 ====================
+
+/*
+ * 设置环境变量 REACTOR_CAPTURE=<文件> 后，服务器把每个连接收到的字节流
+ * 连同时间戳写入捕获文件（格式见 capture.h），用 replay.c 按原节奏或加速回放。
+ * 记录先攒在进程内缓冲区，满了、超过1秒或退出时以一次 O_APPEND write 写出。
+ */
+
+static struct {
+    int fd;                                  // -1 表示未开启捕获
+    uint32_t next_seq;                       // 进程内连接序号
+    size_t len;                              // 缓冲区中待写出的字节数
+    uint64_t last_flush_us;                  // 上次写出的时间
+    unsigned char buf[CAPTURE_BUFFER_SIZE];
+    pthread_mutex_t lock;
+} capture = { -1, 0, 0, 0, {0}, PTHREAD_MUTEX_INITIALIZER };
+
+// 记录时间戳用 CLOCK_MONOTONIC：不受系统时间调整影响，同一次开机内各进程之间可比较
+static uint64_t capture_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void capture_write_all(const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len > 0) {
+        ssize_t n = write(capture.fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("write capture file failed");
+            return;
+        }
+        p += n;
+        len -= n;
+    }
+}
+
+// 把缓冲区写入文件（调用方持有capture.lock）
+static void capture_flush_locked(void) {
+    if (capture.len > 0) {
+        capture_write_all(capture.buf, capture.len);
+        capture.len = 0;
+    }
+}
+
+void capture_flush(void) {
+    if (capture.fd < 0) {
+        return;
+    }
+    pthread_mutex_lock(&capture.lock);
+    capture_flush_locked();
+    pthread_mutex_unlock(&capture.lock);
+}
+
+// 开启捕获，文件不存在时创建并写入文件头，已存在则追加
+int capture_open(const char* path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) {
+        perror("open capture file failed");
+        return -1;
+    }
+
+    capture.fd = fd;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size == 0) {
+        unsigned char header[CAPTURE_FILE_HEADER];
+        struct timespec wall;
+        clock_gettime(CLOCK_REALTIME, &wall);
+        capture_encode_file_header(header, (uint64_t)wall.tv_sec * 1000000 + wall.tv_nsec / 1000);
+        capture_write_all(header, sizeof(header));
+    }
+
+    // 进程退出（包括prefork的worker调用exit）时写出剩余记录
+    atexit(capture_flush);
+    printf("Capturing inbound traffic to %s\n", path);
+    return 0;
+}
+
+// 记录一条事件；未开启捕获时直接返回
+void capture_record(uint64_t conn_id, uint8_t type, const void* data, uint32_t len) {
+    if (capture.fd < 0) {
+        return;
+    }
+
+    uint64_t now = capture_now_us();
+    unsigned char header[CAPTURE_REC_HEADER];
+    capture_encode_record_header(header, now, conn_id, type, len);
+
+    pthread_mutex_lock(&capture.lock);
+    if (capture.len + sizeof(header) + len > sizeof(capture.buf)) {
+        capture_flush_locked();
+    }
+
+    if (sizeof(header) + len > sizeof(capture.buf)) {
+        // 超大记录直接写出，保证一条记录只用一次write
+        struct iovec iov[2] = {
+            { header, sizeof(header) },
+            { (void*)data, len },
+        };
+        if (writev(capture.fd, iov, 2) < 0) {
+            perror("writev capture file failed");
+        }
+    } else {
+        memcpy(capture.buf + capture.len, header, sizeof(header));
+        memcpy(capture.buf + capture.len + sizeof(header), data, len);
+        capture.len += sizeof(header) + len;
+    }
+    
+    if (now - capture.last_flush_us > 1000000) {
+        capture_flush_locked();
+        capture.last_flush_us = now;
+    }
+    pthread_mutex_unlock(&capture.lock);
+}
+
+// 为新连接分配全局唯一ID并记录OPEN事件；未开启捕获时返回0
+uint64_t capture_conn_open(void) {
+    if (capture.fd < 0) {
+        return 0;
+    }
+    uint32_t seq = __atomic_add_fetch(&capture.next_seq, 1, __ATOMIC_RELAXED);
+    uint64_t conn_id = ((uint64_t)getpid() << 32) | seq;
+    capture_record(conn_id, CAPTURE_OPEN, NULL, 0);
+    return conn_id;
+}
+
 // ==================== 事件处理器回调函数 ====================
 
 // 连接上下文结构
@@ -281,8 +515,11 @@ typedef struct {
     int fd;
     char buffer[BUFFER_SIZE];
     int buffer_len;
+    uint64_t capture_id;         // 流量捕获使用的连接ID
 } connection_ctx_t;
 
+void echo_handler(int fd, int events, void* arg);
+
 // Accept处理器：处理新连接
 void accept_handler(int fd, int events, void* arg) {
     reactor_t* reactor = (reactor_t*)arg;
@@ -293,7 +530,10 @@ void accept_handler(int fd, int events, void* arg) {
     // 接受新连接
     int client_fd = accept(fd, (struct sockaddr*)&client_addr, &addr_len);
     if (client_fd == -1) {
-        perror("accept failed");
+        // prefork模式下多个工作进程共享非阻塞监听socket，连接可能已被其他进程取走
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            perror("accept failed");
+        }
         return;
     }
     
@@ -313,6 +553,7 @@ void accept_handler(int fd, int events, void* arg) {
     ctx->reactor = reactor;
     ctx->fd = client_fd;
     ctx->buffer_len = 0;
+    ctx->capture_id = capture_conn_open();
     
     // 注册客户端socket到Reactor
     // 注意：这里使用EPOLLIN | EPOLLET，需要非阻塞socket
@@ -331,6 +572,7 @@ void echo_handler(int fd, int events, void* arg) {
         ssize_t n = read(fd, buffer, sizeof(buffer));
         if (n > 0) {
             printf("Received %ld bytes from fd=%d\n", n, fd);
+            capture_record(ctx->capture_id, CAPTURE_DATA, buffer, n);
             
             // 回显数据
             write(fd, buffer, n);
@@ -338,12 +580,14 @@ void echo_handler(int fd, int events, void* arg) {
         } else if (n == 0) {
             // 客户端关闭连接
             printf("Client fd=%d disconnected\n", fd);
+            capture_record(ctx->capture_id, CAPTURE_CLOSE, NULL, 0);
             reactor_unregister(ctx->reactor, fd);
             close(fd);
             free(ctx);
             
         } else {
             perror("read failed");
+            capture_record(ctx->capture_id, CAPTURE_CLOSE, NULL, 0);
             reactor_unregister(ctx->reactor, fd);
             close(fd);
             free(ctx);
@@ -395,9 +639,405 @@ int create_server_socket(int port) {
     return server_fd;
 }
 
+// ==================== 多进程（prefork）模式 ====================
+
+/*
+ * master/worker 进程模型：
+ * - master 创建（或从旧进程接收）监听socket，fork出N个worker
+ * - 每个 worker 运行自己的 Reactor，在共享的监听socket上accept
+ * - worker 异常退出时 master 自动重新拉起
+ *
+ * 零停机热升级：
+ *   旧master在 UPGRADE_SOCK_PATH 上监听。新程序以 upgrade 模式启动后连接该路径，
+ *   通过 SCM_RIGHTS 接收仍在监听的fd，拉起自己的worker后回复 READY；
+ *   旧master收到后让旧worker停止accept并处理完已有连接再退出。
+ *   监听socket始终处于打开状态，升级期间不会拒绝任何连接。
+ */
+
+// worker 初始化回调：把监听fd注册到worker自己的Reactor上
+typedef int (*worker_init_t)(reactor_t* reactor, int listen_fd);
+
+#define UPGRADE_READY 'R'
+
+// 通过Unix socket发送一组fd
+static int send_fds(int sock, const int* fds, int nfds) {
+    char cmsg_buf[CMSG_SPACE(sizeof(int) * MAX_LISTEN_FDS)];
+    unsigned char count = (unsigned char)nfds;
+    struct iovec iov = { &count, 1 };
+    struct msghdr msg;
+    
+    memset(&msg, 0, sizeof(msg));
+    memset(cmsg_buf, 0, sizeof(cmsg_buf));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsg_buf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * nfds);
+    
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int) * nfds);
+    memcpy(CMSG_DATA(cmsg), fds, sizeof(int) * nfds);
+    
+    if (sendmsg(sock, &msg, 0) != 1) {
+        perror("sendmsg SCM_RIGHTS failed");
+        return -1;
+    }
+    return 0;
+}
+
+// 从Unix socket接收一组fd，返回收到的个数
+static int recv_fds(int sock, int* fds, int max_fds) {
+    char cmsg_buf[CMSG_SPACE(sizeof(int) * MAX_LISTEN_FDS)];
+    unsigned char count = 0;
+    struct iovec iov = { &count, 1 };
+    struct msghdr msg;
+    
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = cmsg_buf;
+    msg.msg_controllen = sizeof(cmsg_buf);
+    
+    if (recvmsg(sock, &msg, 0) != 1) {
+        perror("recvmsg SCM_RIGHTS failed");
+        return -1;
+    }
+    
+    struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+        fprintf(stderr, "No fds received from old master\n");
+        return -1;
+    }
+    
+    int n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    if (n > max_fds || n != count) {
+        fprintf(stderr, "Unexpected fd count %d from old master\n", n);
+        return -1;
+    }
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(int) * n);
+    return n;
+}
+
+// worker进程主体：运行Reactor直到收到SIGTERM/SIGINT，然后停止accept并等待连接结束
+static void worker_run(int index, const int* listen_fds, int nfds, worker_init_t init) {
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    
+    // master退出时worker随之退出
+    prctl(PR_SET_PDEATHSIG, SIGTERM);
+    
+    reactor_t* reactor = reactor_create();
+    if (!reactor) {
+        exit(1);
+    }
+    
+    for (int i = 0; i < nfds; i++) {
+        if (init(reactor, listen_fds[i]) < 0) {
+            reactor_destroy(reactor);
+            exit(1);
+        }
+    }
+    
+    if (reactor_start(reactor) < 0) {
+        reactor_destroy(reactor);
+        exit(1);
+    }
+    printf("Worker %d (pid=%d) started\n", index, getpid());
+    
+    // 信号在master中已被阻塞并被继承，这里同步等待
+    int sig;
+    sigwait(&mask, &sig);
+    printf("Worker %d (pid=%d) got signal %d, draining connections\n", index, getpid(), sig);
+    
+    // 1. 停止accept（监听socket本身仍由master/新进程持有，不会关闭端口）
+    for (int i = 0; i < nfds; i++) {
+        reactor_unregister(reactor, listen_fds[i]);
+        close(listen_fds[i]);
+    }
+    
+    // 2. 等待已有连接结束或超时
+    for (int waited = 0; waited < DRAIN_TIMEOUT_MS; waited += 100) {
+        pthread_mutex_lock(&reactor->lock);
+        int idle = (reactor->handlers == NULL);
+        pthread_mutex_unlock(&reactor->lock);
+        if (idle) {
+            break;
+        }
+        usleep(100 * 1000);
+    }
+    
+    reactor_stop(reactor);
+    reactor_destroy(reactor);
+    printf("Worker %d (pid=%d) exited\n", index, getpid());
+    exit(0);
+}
+
+static pid_t spawn_worker(int index, const int* listen_fds, int nfds,
+                          worker_init_t init, const int* close_fds, int nclose) {
+    fflush(stdout);  // 避免缓冲区中的输出被子进程重复打印
+    pid_t pid = fork();
+    if (pid < 0) {
+        perror("fork failed");
+        return -1;
+    }
+    if (pid == 0) {
+        // 子进程不需要master的signalfd和升级socket
+        for (int i = 0; i < nclose; i++) {
+            if (close_fds[i] >= 0) {
+                close(close_fds[i]);
+            }
+        }
+        worker_run(index, listen_fds, nfds, init);
+    }
+    return pid;
+}
+
+// 创建热升级使用的Unix监听socket
+static int create_upgrade_socket(const char* path) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        perror("socket AF_UNIX failed");
+        return -1;
+    }
+    
+    unlink(path);
+    if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 1) < 0) {
+        perror("bind/listen upgrade socket failed");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// 连接旧master并接收监听fd，成功返回与旧master的连接
+static int upgrade_receive_fds(const char* path, int* fds, int* nfds) {
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+    
+    int sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0) {
+        perror("socket AF_UNIX failed");
+        return -1;
+    }
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect to old master failed");
+        close(sock);
+        return -1;
+    }
+    
+    *nfds = recv_fds(sock, fds, MAX_LISTEN_FDS);
+    if (*nfds <= 0) {
+        close(sock);
+        return -1;
+    }
+    printf("Received %d listening fd(s) from old master\n", *nfds);
+    return sock;
+}
+
+// 把监听fd交给新master；新master就绪后返回0，否则返回-1（继续由本进程服务）
+static int upgrade_handoff(int conn, const int* listen_fds, int nfds) {
+    if (send_fds(conn, listen_fds, nfds) < 0) {
+        return -1;
+    }
+    
+    // 等待新master的worker全部启动
+    struct pollfd pfd = { conn, POLLIN, 0 };
+    char ready = 0;
+    if (poll(&pfd, 1, 10000) != 1 || read(conn, &ready, 1) != 1 || ready != UPGRADE_READY) {
+        fprintf(stderr, "New master did not become ready, keep serving\n");
+        return -1;
+    }
+    return 0;
+}
+
+static void wait_workers(pid_t* workers, int nworkers) {
+    for (int i = 0; i < nworkers; i++) {
+        if (workers[i] > 0) {
+            waitpid(workers[i], NULL, 0);
+            workers[i] = 0;
+        }
+    }
+}
+
+// prefork master：拉起worker、回收/重启worker、处理热升级
+// upgrade 为真时从 UPGRADE_SOCK_PATH 上运行的旧master接管监听fd
+int prefork_main(int nworkers, int port, int upgrade, worker_init_t init) {
+    int listen_fds[MAX_LISTEN_FDS];
+    int nfds = 0;
+    int old_master = -1;
+    pid_t workers[MAX_WORKERS] = {0};
+    
+    if (nworkers <= 0 || nworkers > MAX_WORKERS) {
+        fprintf(stderr, "Worker count must be in [1, %d]\n", MAX_WORKERS);
+        return 1;
+    }
+    
+    if (upgrade) {
+        old_master = upgrade_receive_fds(UPGRADE_SOCK_PATH, listen_fds, &nfds);
+        if (old_master < 0) {
+            return 1;
+        }
+    } else {
+        listen_fds[0] = create_server_socket(port);
+        if (listen_fds[0] < 0) {
+            return 1;
+        }
+        nfds = 1;
+    }
+    
+    // 多个worker共享监听socket，必须非阻塞，避免惊群后阻塞在accept上
+    for (int i = 0; i < nfds; i++) {
+        set_nonblocking(listen_fds[i]);
+    }
+    
+    // master通过signalfd同步处理信号；worker继承阻塞的信号掩码后用sigwait等待
+    sigset_t mask;
+    sigemptyset(&mask);
+    sigaddset(&mask, SIGCHLD);
+    sigaddset(&mask, SIGTERM);
+    sigaddset(&mask, SIGINT);
+    sigprocmask(SIG_BLOCK, &mask, NULL);
+    
+    int sig_fd = signalfd(-1, &mask, SFD_CLOEXEC);
+    if (sig_fd < 0) {
+        perror("signalfd failed");
+        return 1;
+    }
+    
+    int close_in_child[3] = { sig_fd, old_master, -1 };
+    for (int i = 0; i < nworkers; i++) {
+        workers[i] = spawn_worker(i, listen_fds, nfds, init, close_in_child, 3);
+    }
+    printf("Master (pid=%d) started %d workers\n", getpid(), nworkers);
+    
+    if (old_master >= 0) {
+        // 通知旧master可以退出，等它释放升级socket路径后再接管
+        char ready = UPGRADE_READY;
+        char eof;
+        if (write(old_master, &ready, 1) != 1) {
+            perror("notify old master failed");
+        }
+        while (read(old_master, &eof, 1) > 0) {
+        }
+        close(old_master);
+        printf("Old master released, upgrade complete\n");
+    }
+    
+    int upgrade_fd = create_upgrade_socket(UPGRADE_SOCK_PATH);
+    close_in_child[2] = upgrade_fd;
+    printf("Master accepting upgrades on %s\n", UPGRADE_SOCK_PATH);
+    
+    int stopping = 0;
+    while (!stopping) {
+        struct pollfd pfds[2] = {
+            { sig_fd, POLLIN, 0 },
+            { upgrade_fd, POLLIN, 0 },
+        };
+        if (poll(pfds, upgrade_fd >= 0 ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("poll failed");
+            break;
+        }
+        
+        if (pfds[0].revents & POLLIN) {
+            struct signalfd_siginfo info;
+            if (read(sig_fd, &info, sizeof(info)) != sizeof(info)) {
+                continue;
+            }
+            
+            if (info.ssi_signo == SIGCHLD) {
+                // 回收退出的worker并重新拉起
+                pid_t pid;
+                int status;
+                while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+                    for (int i = 0; i < nworkers; i++) {
+                        if (workers[i] == pid) {
+                            fprintf(stderr, "Worker %d (pid=%d) died, respawning\n", i, pid);
+                            workers[i] = spawn_worker(i, listen_fds, nfds, init,
+                                                      close_in_child, 3);
+                        }
+                    }
+                }
+            } else {
+                printf("Master got signal %d, shutting down\n", info.ssi_signo);
+                stopping = 1;
+            }
+        }
+        
+        if (!stopping && upgrade_fd >= 0 && (pfds[1].revents & POLLIN)) {
+            int conn = accept(upgrade_fd, NULL, NULL);
+            if (conn < 0) {
+                continue;
+            }
+            printf("Upgrade requested, handing over listening fds\n");
+            if (upgrade_handoff(conn, listen_fds, nfds) == 0) {
+                // 释放升级socket路径并断开，新master随后接管该路径
+                close(upgrade_fd);
+                unlink(UPGRADE_SOCK_PATH);
+                upgrade_fd = -1;
+                stopping = 1;
+            }
+            close(conn);
+        }
+    }
+    
+    // 通知所有worker优雅退出：停止accept，处理完已有连接
+    for (int i = 0; i < nworkers; i++) {
+        if (workers[i] > 0) {
+            kill(workers[i], SIGTERM);
+        }
+    }
+    wait_workers(workers, nworkers);
+    
+    if (upgrade_fd >= 0) {
+        close(upgrade_fd);
+        unlink(UPGRADE_SOCK_PATH);
+    }
+    for (int i = 0; i < nfds; i++) {
+        close(listen_fds[i]);
+    }
+    close(sig_fd);
+    printf("Master (pid=%d) exited\n", getpid());
+    return 0;
+}
+
 // ==================== 主函数 ====================
 
+// 其他服务器（rpc_server.c等）通过 #define REACTOR_NO_MAIN 后
+// #include "reactor.c" 复用上面的Reactor核心
+#ifndef REACTOR_NO_MAIN
+// echo服务器的worker初始化：在监听fd上注册accept处理器
+static int echo_worker_init(reactor_t* reactor, int listen_fd) {
+    return reactor_register(reactor, listen_fd, EPOLLIN, accept_handler, reactor);
+}
+
 int main(int argc, char* argv[]) {
+    // REACTOR_CAPTURE=<文件> 开启流量捕获
+    const char* capture_path = getenv("REACTOR_CAPTURE");
+    if (capture_path && capture_open(capture_path) < 0) {
+        return 1;
+    }
+    
+    // 多进程模式：./reactor_server prefork [N] / ./reactor_server upgrade [N]
+    if (argc > 1 && (strcmp(argv[1], "prefork") == 0 || strcmp(argv[1], "upgrade") == 0)) {
+        int nworkers = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+        printf("=== Reactor Pattern Server (prefork) ===\n");
+        return prefork_main(nworkers, PORT, strcmp(argv[1], "upgrade") == 0,
+                            echo_worker_init);
+    }
+    
     printf("=== Reactor Pattern Server ===\n");
     
     // 1. 创建Reactor
@@ -434,9 +1074,8 @@ int main(int argc, char* argv[]) {
     // 5. 主线程等待用户输入退出
     printf("\nServer is running. Press 'q' + Enter to quit.\n");
     
-    char cmd;
-    while (1) {
-        cmd = getchar();
+    int cmd;
+    while ((cmd = getchar()) != EOF) {
         if (cmd == 'q' || cmd == 'Q') {
             break;
         }
@@ -455,4 +1094,5 @@ int main(int argc, char* argv[]) {
     
     printf("Server shutdown complete.\n");
     return 0;
-}
\ No newline at end of file
+}
+#endif // REACTOR_NO_MAIN
@@ -0,0 +1,627 @@
+// 流量回放工具：把 REACTOR_CAPTURE 捕获的连接字节流重新打到任意服务器上
+//
+// - 每个被捕获的连接按原始时间线回放：何时建连、何时发送多少字节、何时关闭
+// - -s 控制速度：1 为原速，N 为 N 倍速，0 为不等待的最大速度
+// - -c 把每个捕获连接复制 N 份并行回放，-t 用多个线程（各自一个epoll）分摊连接
+// - 服务器的响应只读取并计数，不做校验
+//
+// 编译：gcc -O2 -o replay replay.c -lpthread
+// 运行：./replay -f capture.bin [-h 127.0.0.1] [-p 8080] [-s 1] [-c 1] [-t 1]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+
+#include "capture.h"
+
+#define MAX_EVENTS        256
+#define RECV_BUFFER_SIZE  65536
+#define DRAIN_TIMEOUT_US  2000000    // 发送完毕后等待服务器关闭连接的最长时间
+
+// ==================== 回放脚本 ====================
+
+// 一个捕获事件，at_us 为相对回放开始的计划时间（已按速度缩放）
+typedef struct replay_event {
+    uint64_t at_us;
+    uint8_t type;
+    uint32_t len;
+    const unsigned char* data;
+} replay_event_t;
+
+// 一个被捕获连接的全部事件
+typedef struct replay_script {
+    uint64_t conn_id;
+    replay_event_t* events;
+    size_t count;
+    size_t cap;
+} replay_script_t;
+
+typedef struct replay_scripts {
+    unsigned char* file;         // 整个捕获文件，事件负载直接指向其中
+    replay_script_t* scripts;
+    size_t count;
+    size_t cap;
+    size_t* index;               // conn_id -> 脚本下标+1 的开放寻址表
+    size_t index_cap;
+} replay_scripts_t;
+
+static replay_script_t* scripts_lookup(replay_scripts_t* all, uint64_t conn_id) {
+    size_t mask = all->index_cap - 1;
+    size_t slot = (size_t)(conn_id * 0x9E3779B97F4A7C15ULL) & mask;
+
+    while (all->index[slot]) {
+        replay_script_t* script = &all->scripts[all->index[slot] - 1];
+        if (script->conn_id == conn_id) {
+            return script;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    // 新连接：保持装载率不超过1/2，超过时重建索引
+    if ((all->count + 1) * 2 > all->index_cap) {
+        size_t new_cap = all->index_cap * 2;
+        size_t* index = (size_t*)calloc(new_cap, sizeof(size_t));
+        if (!index) {
+            return NULL;
+        }
+        for (size_t i = 0; i < all->count; i++) {
+            size_t s = (size_t)(all->scripts[i].conn_id * 0x9E3779B97F4A7C15ULL) & (new_cap - 1);
+            while (index[s]) {
+                s = (s + 1) & (new_cap - 1);
+            }
+            index[s] = i + 1;
+        }
+        free(all->index);
+        all->index = index;
+        all->index_cap = new_cap;
+        return scripts_lookup(all, conn_id);
+    }
+
+    if (all->count == all->cap) {
+        size_t new_cap = all->cap ? all->cap * 2 : 64;
+        replay_script_t* scripts = (replay_script_t*)realloc(all->scripts,
+                                                             new_cap * sizeof(replay_script_t));
+        if (!scripts) {
+            return NULL;
+        }
+        all->scripts = scripts;
+        all->cap = new_cap;
+    }
+
+    replay_script_t* script = &all->scripts[all->count++];
+    memset(script, 0, sizeof(*script));
+    script->conn_id = conn_id;
+    all->index[slot] = all->count;
+    return script;
+}
+
+static int script_append(replay_script_t* script, const capture_record_t* rec) {
+    if (script->count == script->cap) {
+        size_t new_cap = script->cap ? script->cap * 2 : 16;
+        replay_event_t* events = (replay_event_t*)realloc(script->events,
+                                                          new_cap * sizeof(replay_event_t));
+        if (!events) {
+            return -1;
+        }
+        script->events = events;
+        script->cap = new_cap;
+    }
+
+    // 同一连接的记录由同一个线程按发生顺序写入，文件顺序就是事件顺序，不再排序；
+    // 时间戳比前一个事件还早（时钟回拨）时按前一个事件的时间算，保持顺序不变
+    uint64_t at_us = rec->ts_us;
+    if (script->count > 0 && at_us < script->events[script->count - 1].at_us) {
+        at_us = script->events[script->count - 1].at_us;
+    }
+
+    replay_event_t* ev = &script->events[script->count++];
+    ev->at_us = at_us;        // 先存绝对时间，加载完后再换算
+    ev->type = rec->type;
+    ev->len = rec->len;
+    ev->data = rec->payload;
+    return 0;
+}
+
+// 读取捕获文件并按连接分组；speed<=0 表示所有事件立即执行
+static int load_capture(const char* path, double speed, replay_scripts_t* all) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) {
+        perror("open capture file failed");
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    memset(all, 0, sizeof(*all));
+    all->file = (unsigned char*)malloc(size > 0 ? size : 1);
+    all->index_cap = 1024;
+    all->index = (size_t*)calloc(all->index_cap, sizeof(size_t));
+    if (!all->file || !all->index || fread(all->file, 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "read capture file failed\n");
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    if (size < CAPTURE_FILE_HEADER || memcmp(all->file, CAPTURE_MAGIC, 4) != 0) {
+        fprintf(stderr, "%s is not a capture file\n", path);
+        return -1;
+    }
+
+    size_t off = CAPTURE_FILE_HEADER;
+    uint64_t first_ts = UINT64_MAX;
+    size_t records = 0;
+    capture_record_t rec;
+    while (off < (size_t)size) {
+        if (capture_decode_record(all->file, size, &off, &rec) < 0) {
+            fprintf(stderr, "Truncated or corrupt record at offset %zu, stop loading\n", off);
+            break;
+        }
+        replay_script_t* script = scripts_lookup(all, rec.conn_id);
+        if (!script || script_append(script, &rec) < 0) {
+            fprintf(stderr, "Out of memory while loading capture\n");
+            return -1;
+        }
+        if (rec.ts_us < first_ts) {
+            first_ts = rec.ts_us;
+        }
+        records++;
+    }
+
+    // 换算为相对回放开始的计划时间
+    for (size_t i = 0; i < all->count; i++) {
+        replay_script_t* script = &all->scripts[i];
+        for (size_t j = 0; j < script->count; j++) {
+            uint64_t rel = script->events[j].at_us - first_ts;
+            script->events[j].at_us = speed > 0 ? (uint64_t)(rel / speed) : 0;
+        }
+    }
+
+    printf("Loaded %zu records of %zu connections from %s\n", records, all->count, path);
+    return 0;
+}
+
+// ==================== 回放连接 ====================
+
+enum {
+    CONN_PENDING,      // 等待下一个事件的计划时间
+    CONN_CONNECTING,   // 非阻塞connect进行中
+    CONN_SENDING,      // 发送被EAGAIN阻塞，等待可写
+    CONN_DRAINING,     // 已发完并shutdown写端，等待服务器关闭
+    CONN_DONE
+};
+
+typedef struct replay_conn {
+    const replay_script_t* script;
+    int fd;
+    int state;
+    int events;          // 当前epoll关注的事件
+    size_t next;         // 下一个要执行的事件
+    uint32_t sent;       // 当前DATA事件已发送的字节数
+    uint64_t due_us;     // 在定时堆中等待的时间点
+} replay_conn_t;
+
+// 定时堆条目（惰性删除：弹出时due与连接当前状态不符则丢弃）
+typedef struct timer_entry {
+    uint64_t due_us;
+    replay_conn_t* conn;
+} timer_entry_t;
+
+typedef struct replay_worker {
+    int id;
+    int epoll_fd;
+    replay_conn_t* conns;
+    size_t nconns;
+    size_t finished;
+    timer_entry_t* heap;
+    size_t heap_len;
+    size_t heap_cap;
+    pthread_t thread;
+
+    // 统计
+    uint64_t bytes_sent;
+    uint64_t bytes_recv;
+    uint64_t conns_ok;
+    uint64_t conns_failed;
+    uint64_t max_lag_us;  // 事件实际执行时间比计划晚的最大值
+} replay_worker_t;
+
+static struct sockaddr_in target_addr;
+static struct timespec replay_start;
+
+static uint64_t elapsed_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)(now.tv_sec - replay_start.tv_sec) * 1000000 +
+           (now.tv_nsec - replay_start.tv_nsec) / 1000;
+}
+
+static void heap_push(replay_worker_t* w, replay_conn_t* conn, uint64_t due_us) {
+    if (w->heap_len == w->heap_cap) {
+        w->heap_cap = w->heap_cap ? w->heap_cap * 2 : 256;
+        w->heap = (timer_entry_t*)realloc(w->heap, w->heap_cap * sizeof(timer_entry_t));
+        if (!w->heap) {
+            perror("realloc timer heap failed");
+            exit(1);
+        }
+    }
+    conn->due_us = due_us;
+
+    size_t i = w->heap_len++;
+    while (i > 0 && w->heap[(i - 1) / 2].due_us > due_us) {
+        w->heap[i] = w->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    w->heap[i].due_us = due_us;
+    w->heap[i].conn = conn;
+}
+
+static timer_entry_t heap_pop(replay_worker_t* w) {
+    timer_entry_t top = w->heap[0];
+    timer_entry_t last = w->heap[--w->heap_len];
+
+    size_t i = 0;
+    while (1) {
+        size_t child = 2 * i + 1;
+        if (child >= w->heap_len) {
+            break;
+        }
+        if (child + 1 < w->heap_len && w->heap[child + 1].due_us < w->heap[child].due_us) {
+            child++;
+        }
+        if (last.due_us <= w->heap[child].due_us) {
+            break;
+        }
+        w->heap[i] = w->heap[child];
+        i = child;
+    }
+    if (w->heap_len > 0) {
+        w->heap[i] = last;
+    }
+    return top;
+}
+
+static void conn_set_events(replay_worker_t* w, replay_conn_t* conn, int events) {
+    if (conn->fd < 0 || conn->events == events) {
+        return;
+    }
+    struct epoll_event ev;
+    ev.events = events;
+    ev.data.ptr = conn;
+    epoll_ctl(w->epoll_fd, EPOLL_CTL_MOD, conn->fd, &ev);
+    conn->events = events;
+}
+
+static void conn_finish(replay_worker_t* w, replay_conn_t* conn, int ok) {
+    if (conn->state == CONN_DONE) {
+        return;
+    }
+    if (conn->fd >= 0) {
+        close(conn->fd);  // close会自动从epoll中移除
+        conn->fd = -1;
+    }
+    conn->state = CONN_DONE;
+    w->finished++;
+    if (ok) {
+        w->conns_ok++;
+    } else {
+        w->conns_failed++;
+    }
+}
+
+static void conn_start_drain(replay_worker_t* w, replay_conn_t* conn, uint64_t now) {
+    shutdown(conn->fd, SHUT_WR);
+    conn->state = CONN_DRAINING;
+    conn_set_events(w, conn, EPOLLIN);
+    heap_push(w, conn, now + DRAIN_TIMEOUT_US);
+}
+
+static int conn_open(replay_worker_t* w, replay_conn_t* conn) {
+    conn->fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (conn->fd < 0) {
+        perror("socket failed");
+        return -1;
+    }
+    int opt = 1;
+    setsockopt(conn->fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+    if (connect(conn->fd, (struct sockaddr*)&target_addr, sizeof(target_addr)) < 0 &&
+        errno != EINPROGRESS) {
+        perror("connect failed");
+        return -1;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.ptr = conn;
+    if (epoll_ctl(w->epoll_fd, EPOLL_CTL_ADD, conn->fd, &ev) < 0) {
+        perror("epoll_ctl ADD failed");
+        return -1;
+    }
+    conn->events = ev.events;
+    conn->state = CONN_CONNECTING;
+    return 0;
+}
+
+// 执行所有已到期的事件，直到遇到未来的事件或I/O阻塞
+static void conn_advance(replay_worker_t* w, replay_conn_t* conn, uint64_t now) {
+    const replay_script_t* script = conn->script;
+
+    while (conn->next < script->count) {
+        const replay_event_t* ev = &script->events[conn->next];
+        if (ev->at_us > now) {
+            conn->state = CONN_PENDING;
+            conn_set_events(w, conn, EPOLLIN);
+            heap_push(w, conn, ev->at_us);
+            return;
+        }
+        if (now - ev->at_us > w->max_lag_us && conn->sent == 0) {
+            w->max_lag_us = now - ev->at_us;
+        }
+
+        if (conn->fd < 0) {
+            // 第一个事件（通常是OPEN）时建立连接
+            if (conn_open(w, conn) < 0) {
+                conn_finish(w, conn, 0);
+                return;
+            }
+            if (ev->type == CAPTURE_OPEN) {
+                conn->next++;
+            }
+            return;  // 等待connect完成
+        }
+
+        if (ev->type == CAPTURE_DATA) {
+            while (conn->sent < ev->len) {
+                ssize_t n = send(conn->fd, ev->data + conn->sent, ev->len - conn->sent,
+                                 MSG_NOSIGNAL);
+                if (n > 0) {
+                    conn->sent += n;
+                    w->bytes_sent += n;
+                } else if (n < 0 && errno == EINTR) {
+                    continue;
+                } else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                    conn->state = CONN_SENDING;
+                    conn_set_events(w, conn, EPOLLIN | EPOLLOUT);
+                    return;
+                } else {
+                    conn_finish(w, conn, 0);
+                    return;
+                }
+            }
+            conn->sent = 0;
+        } else if (ev->type == CAPTURE_CLOSE) {
+            conn->next++;
+            conn_start_drain(w, conn, now);
+            return;
+        }
+        conn->next++;
+    }
+
+    // 捕获中没有CLOSE记录（例如捕获时服务器先退出了）
+    conn_start_drain(w, conn, now);
+}
+
+static void conn_on_event(replay_worker_t* w, replay_conn_t* conn, uint32_t events) {
+    uint64_t now = elapsed_us();
+
+    if (conn->state == CONN_CONNECTING) {
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0 || err != 0) {
+            conn_finish(w, conn, 0);
+            return;
+        }
+        if (!(events & EPOLLOUT)) {
+            return;
+        }
+        conn->state = CONN_PENDING;
+        conn_advance(w, conn, now);
+        return;
+    }
+
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        char buf[RECV_BUFFER_SIZE];
+        while (1) {
+            ssize_t n = recv(conn->fd, buf, sizeof(buf), 0);
+            if (n > 0) {
+                w->bytes_recv += n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            // 服务器关闭：回放已发完则正常结束，否则算作失败
+            conn_finish(w, conn, conn->state == CONN_DRAINING);
+            return;
+        }
+    }
+
+    if (conn->state == CONN_SENDING && (events & EPOLLOUT)) {
+        conn_advance(w, conn, now);
+    }
+}
+
+static void* worker_main(void* arg) {
+    replay_worker_t* w = (replay_worker_t*)arg;
+    struct epoll_event events[MAX_EVENTS];
+
+    for (size_t i = 0; i < w->nconns; i++) {
+        replay_conn_t* conn = &w->conns[i];
+        heap_push(w, conn, conn->script->count ? conn->script->events[0].at_us : 0);
+    }
+
+    while (w->finished < w->nconns) {
+        uint64_t now = elapsed_us();
+
+        // 执行到期的定时器
+        while (w->heap_len > 0 && w->heap[0].due_us <= now) {
+            timer_entry_t t = heap_pop(w);
+            replay_conn_t* conn = t.conn;
+            if (conn->due_us != t.due_us) {
+                continue;  // 过期的堆条目
+            }
+            if (conn->state == CONN_PENDING) {
+                conn_advance(w, conn, now);
+            } else if (conn->state == CONN_DRAINING) {
+                conn_finish(w, conn, 1);  // 服务器没有主动关闭，超时后由我们关闭
+            }
+        }
+
+        int timeout_ms = 100;
+        if (w->heap_len > 0) {
+            uint64_t wait_us = w->heap[0].due_us > now ? w->heap[0].due_us - now : 0;
+            if (wait_us / 1000 < (uint64_t)timeout_ms) {
+                timeout_ms = (int)((wait_us + 999) / 1000);
+            }
+        }
+
+        int nfds = epoll_wait(w->epoll_fd, events, MAX_EVENTS, timeout_ms);
+        if (nfds < 0 && errno != EINTR) {
+            perror("epoll_wait failed");
+            break;
+        }
+        for (int i = 0; i < nfds; i++) {
+            replay_conn_t* conn = (replay_conn_t*)events[i].data.ptr;
+            if (conn->state != CONN_DONE) {
+                conn_on_event(w, conn, events[i].events);
+            }
+        }
+    }
+    return NULL;
+}
+
+// ==================== 主函数 ====================
+
+static void usage(const char* prog) {
+    printf("Usage: %s -f capture.bin [-h host] [-p port] [-s speed] [-c copies] [-t threads]\n", prog);
+    printf("  -s speed   1 = original pace, N = N times faster, 0 = as fast as possible\n");
+    printf("  -c copies  replay every captured connection N times in parallel\n");
+    printf("  -t threads number of replay threads (one epoll loop each)\n");
+}
+
+int main(int argc, char* argv[]) {
+    const char* path = NULL;
+    const char* host = "127.0.0.1";
+    int port = 8080;
+    double speed = 1.0;
+    int copies = 1;
+    int nthreads = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "f:h:p:s:c:t:")) != -1) {
+        switch (opt) {
+        case 'f': path = optarg; break;
+        case 'h': host = optarg; break;
+        case 'p': port = atoi(optarg); break;
+        case 's': speed = atof(optarg); break;
+        case 'c': copies = atoi(optarg); break;
+        case 't': nthreads = atoi(optarg); break;
+        default: usage(argv[0]); return 1;
+        }
+    }
+    if (!path || copies <= 0 || nthreads <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    memset(&target_addr, 0, sizeof(target_addr));
+    target_addr.sin_family = AF_INET;
+    target_addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &target_addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid address: %s\n", host);
+        return 1;
+    }
+
+    replay_scripts_t all;
+    if (load_capture(path, speed, &all) < 0) {
+        return 1;
+    }
+
+    // 大量并行连接需要足够的fd
+    struct rlimit rl;
+    if (getrlimit(RLIMIT_NOFILE, &rl) == 0 && rl.rlim_cur < rl.rlim_max) {
+        rl.rlim_cur = rl.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &rl);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    // 连接按轮询方式分配给各线程
+    size_t total = all.count * (size_t)copies;
+    replay_worker_t* workers = (replay_worker_t*)calloc(nthreads, sizeof(replay_worker_t));
+    for (int t = 0; t < nthreads; t++) {
+        workers[t].id = t;
+        workers[t].epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        workers[t].conns = (replay_conn_t*)calloc(total / nthreads + 1, sizeof(replay_conn_t));
+    }
+    for (size_t k = 0; k < total; k++) {
+        replay_worker_t* w = &workers[k % nthreads];
+        replay_conn_t* conn = &w->conns[w->nconns++];
+        conn->script = &all.scripts[k % all.count];
+        conn->fd = -1;
+        conn->state = CONN_PENDING;
+    }
+
+    if (speed > 0) {
+        printf("Replaying %zu connections (%d copies) to %s:%d at %.2fx speed with %d thread(s)\n",
+               total, copies, host, port, speed, nthreads);
+    } else {
+        printf("Replaying %zu connections (%d copies) to %s:%d at max speed with %d thread(s)\n",
+               total, copies, host, port, nthreads);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &replay_start);
+    for (int t = 0; t < nthreads; t++) {
+        pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]);
+    }
+
+    uint64_t sent = 0, recv = 0, ok = 0, failed = 0, max_lag = 0;
+    for (int t = 0; t < nthreads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        sent += workers[t].bytes_sent;
+        recv += workers[t].bytes_recv;
+        ok += workers[t].conns_ok;
+        failed += workers[t].conns_failed;
+        if (workers[t].max_lag_us > max_lag) {
+            max_lag = workers[t].max_lag_us;
+        }
+        close(workers[t].epoll_fd);
+        free(workers[t].conns);
+        free(workers[t].heap);
+    }
+    double secs = elapsed_us() / 1e6;
+
+    printf("\n=== Replay Result ===\n");
+    printf("Elapsed:      %.3f s\n", secs);
+    printf("Connections:  %llu ok, %llu failed\n",
+           (unsigned long long)ok, (unsigned long long)failed);
+    printf("Sent:         %llu bytes (%.2f MB/s)\n",
+           (unsigned long long)sent, sent / secs / 1e6);
+    printf("Received:     %llu bytes (%.2f MB/s)\n",
+           (unsigned long long)recv, recv / secs / 1e6);
+    printf("Max lag:      %.3f ms behind schedule\n", max_lag / 1000.0);
+
+    for (size_t i = 0; i < all.count; i++) {
+        free(all.scripts[i].events);
+    }
+    free(all.scripts);
+    free(all.index);
+    free(all.file);
+    free(workers);
+    return failed ? 2 : 0;
+}
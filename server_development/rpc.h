@@ -0,0 +1,82 @@
+#ifndef RPC_H
+#define RPC_H
+
+#include <stdint.h>
+#include <string.h>
+#include <arpa/inet.h>
+
+// ==================== RPC 二进制协议 ====================
+//
+// 每个帧 = 16字节定长头部 + length字节负载，所有整数均为网络字节序
+//
+//  0       2       4   5   6       8               12              16
+//  +-------+-------+---+---+-------+---------------+---------------+
+//  | magic | method|flg|sts|  rsv  |  request_id   |    length     |
+//  +-------+-------+---+---+-------+---------------+---------------+
+//
+// 请求和响应使用相同头部：响应带 RPC_FLAG_RESPONSE，request_id 原样带回，
+// 客户端据此把乱序到达的响应匹配回对应的调用。
+
+#define RPC_MAGIC        0x5250        // "RP"
+#define RPC_HEADER_SIZE  16
+#define RPC_MAX_PAYLOAD  (1 << 20)     // 单帧负载上限 1MB
+#define RPC_MAX_METHODS  256
+
+#define RPC_FLAG_RESPONSE 0x01
+
+// 响应状态码
+#define RPC_OK               0
+#define RPC_ERR_NO_METHOD    1    // 方法未注册
+#define RPC_ERR_BAD_REQUEST  2    // 请求负载格式错误
+#define RPC_ERR_INTERNAL     3    // 处理函数内部错误
+#define RPC_ERR_DISCONNECTED 4    // 连接断开（仅客户端本地使用）
+
+typedef struct rpc_header {
+    uint16_t magic;
+    uint16_t method_id;
+    uint8_t  flags;
+    uint8_t  status;
+    uint16_t reserved;
+    uint32_t request_id;
+    uint32_t length;
+} rpc_header_t;
+
+// 头部编码到网络字节序缓冲区（buf至少RPC_HEADER_SIZE字节）
+static inline void rpc_header_encode(const rpc_header_t* h, unsigned char* buf) {
+    uint16_t v16;
+    uint32_t v32;
+
+    v16 = htons(h->magic);      memcpy(buf + 0, &v16, 2);
+    v16 = htons(h->method_id);  memcpy(buf + 2, &v16, 2);
+    buf[4] = h->flags;
+    buf[5] = h->status;
+    v16 = htons(h->reserved);   memcpy(buf + 6, &v16, 2);
+    v32 = htonl(h->request_id); memcpy(buf + 8, &v32, 4);
+    v32 = htonl(h->length);     memcpy(buf + 12, &v32, 4);
+}
+
+// 从缓冲区解码头部，magic或长度非法时返回-1
+static inline int rpc_header_decode(const unsigned char* buf, rpc_header_t* h) {
+    uint16_t v16;
+    uint32_t v32;
+
+    memcpy(&v16, buf + 0, 2);  h->magic = ntohs(v16);
+    memcpy(&v16, buf + 2, 2);  h->method_id = ntohs(v16);
+    h->flags = buf[4];
+    h->status = buf[5];
+    memcpy(&v16, buf + 6, 2);  h->reserved = ntohs(v16);
+    memcpy(&v32, buf + 8, 4);  h->request_id = ntohl(v32);
+    memcpy(&v32, buf + 12, 4); h->length = ntohl(v32);
+
+    if (h->magic != RPC_MAGIC || h->length > RPC_MAX_PAYLOAD) {
+        return -1;
+    }
+    return 0;
+}
+
+// 示例服务使用的方法ID（rpc_server.c 与 rpc_client.c 共用）
+#define RPC_METHOD_ECHO   1    // 原样返回负载
+#define RPC_METHOD_ADD    2    // 负载为两个网络序uint32，返回和
+#define RPC_METHOD_SLEEP  3    // 负载为网络序uint32毫秒数，睡眠后返回
+
+#endif // RPC_H
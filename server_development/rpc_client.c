@@ -0,0 +1,460 @@
+// rpc_server.c 对应的客户端库
+//
+// 一个连接上可以同时有任意多个未完成的调用：
+// - 发送方在 send_lock 保护下整帧写出，每个调用分配唯一 request_id
+// - 独立的接收线程读取响应，按 request_id 找到对应的调用并唤醒/回调，
+//   因此响应可以乱序到达
+//
+// 编译：gcc -o rpc_client rpc_client.c -lpthread
+// 其他程序复用客户端库时 #define RPC_CLIENT_NO_MAIN 后 #include "rpc_client.c"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+
+#include "rpc.h"
+
+#define RPC_PENDING_BUCKETS 256
+
+// 异步调用完成回调（在接收线程中执行，不要在其中阻塞）
+typedef void (*rpc_callback_t)(int status, const unsigned char* resp,
+                               uint32_t resp_len, void* arg);
+
+// 一个未完成的调用
+typedef struct rpc_call {
+    uint32_t request_id;
+    int done;
+    int status;
+    unsigned char* resp;
+    uint32_t resp_len;
+    rpc_callback_t callback;     // 异步调用使用；同步调用为NULL
+    void* arg;
+    pthread_cond_t cond;         // 同步调用在此等待
+    struct rpc_call* next;
+} rpc_call_t;
+
+typedef struct rpc_client {
+    int fd;
+    uint32_t next_id;
+    int closed;
+    pthread_t reader;
+    pthread_mutex_t send_lock;   // 保证帧整体写出，不与其他线程交错
+    pthread_mutex_t lock;        // 保护 pending 表和 closed
+    rpc_call_t* pending[RPC_PENDING_BUCKETS];
+} rpc_client_t;
+
+// ==================== 内部工具函数 ====================
+
+static int rpc_read_full(int fd, void* buf, size_t len) {
+    size_t done = 0;
+    while (done < len) {
+        ssize_t n = read(fd, (char*)buf + done, len - done);
+        if (n > 0) {
+            done += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int rpc_writev_full(int fd, struct iovec* iov, int iovcnt) {
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, iov, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        while (iovcnt > 0 && (size_t)n >= iov->iov_len) {
+            n -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char*)iov->iov_base + n;
+            iov->iov_len -= n;
+        }
+    }
+    return 0;
+}
+
+// 从pending表中取出指定的调用（调用方持有client->lock）
+static rpc_call_t* rpc_pending_take(rpc_client_t* client, uint32_t request_id) {
+    rpc_call_t** pp = &client->pending[request_id % RPC_PENDING_BUCKETS];
+    while (*pp) {
+        if ((*pp)->request_id == request_id) {
+            rpc_call_t* call = *pp;
+            *pp = call->next;
+            return call;
+        }
+        pp = &(*pp)->next;
+    }
+    return NULL;
+}
+
+// 完成一个调用：异步调用执行回调并释放，同步调用唤醒等待者
+// 调用方持有client->lock，异步回调在锁外执行
+static void rpc_call_complete(rpc_client_t* client, rpc_call_t* call, int status,
+                              unsigned char* resp, uint32_t resp_len) {
+    call->status = status;
+    call->resp = resp;
+    call->resp_len = resp_len;
+    call->done = 1;
+
+    if (call->callback) {
+        pthread_mutex_unlock(&client->lock);
+        call->callback(status, resp, resp_len, call->arg);
+        pthread_mutex_lock(&client->lock);
+        free(resp);
+        pthread_cond_destroy(&call->cond);
+        free(call);
+    } else {
+        pthread_cond_signal(&call->cond);
+    }
+}
+
+// 接收线程：读取响应帧并分发给对应的调用
+static void* rpc_reader(void* arg) {
+    rpc_client_t* client = (rpc_client_t*)arg;
+    unsigned char head[RPC_HEADER_SIZE];
+
+    while (rpc_read_full(client->fd, head, sizeof(head)) == 0) {
+        rpc_header_t hdr;
+        if (rpc_header_decode(head, &hdr) < 0 || !(hdr.flags & RPC_FLAG_RESPONSE)) {
+            fprintf(stderr, "RPC client: protocol error\n");
+            break;
+        }
+
+        unsigned char* resp = (unsigned char*)malloc(hdr.length ? hdr.length : 1);
+        if (!resp || rpc_read_full(client->fd, resp, hdr.length) < 0) {
+            free(resp);
+            break;
+        }
+
+        pthread_mutex_lock(&client->lock);
+        rpc_call_t* call = rpc_pending_take(client, hdr.request_id);
+        if (call) {
+            rpc_call_complete(client, call, hdr.status, resp, hdr.length);
+        } else {
+            free(resp);  // 已超时放弃的调用
+        }
+        pthread_mutex_unlock(&client->lock);
+    }
+
+    // 连接断开：所有未完成的调用以 RPC_ERR_DISCONNECTED 结束
+    pthread_mutex_lock(&client->lock);
+    client->closed = 1;
+    for (int i = 0; i < RPC_PENDING_BUCKETS; i++) {
+        while (client->pending[i]) {
+            rpc_call_t* call = client->pending[i];
+            client->pending[i] = call->next;
+            rpc_call_complete(client, call, RPC_ERR_DISCONNECTED, NULL, 0);
+        }
+    }
+    pthread_mutex_unlock(&client->lock);
+    return NULL;
+}
+
+// 注册调用并发送请求帧，失败返回NULL
+// 注意：异步调用可能在本函数返回前就已完成并被释放，返回值只能用于判断成功与否
+static rpc_call_t* rpc_call_start(rpc_client_t* client, uint16_t method_id,
+                                  const void* req, uint32_t req_len,
+                                  rpc_callback_t callback, void* arg) {
+    if (req_len > RPC_MAX_PAYLOAD) {
+        return NULL;
+    }
+
+    rpc_call_t* call = (rpc_call_t*)calloc(1, sizeof(rpc_call_t));
+    if (!call) {
+        return NULL;
+    }
+    call->callback = callback;
+    call->arg = arg;
+    pthread_cond_init(&call->cond, NULL);
+
+    pthread_mutex_lock(&client->lock);
+    if (client->closed) {
+        pthread_mutex_unlock(&client->lock);
+        pthread_cond_destroy(&call->cond);
+        free(call);
+        return NULL;
+    }
+    call->request_id = client->next_id++;
+    rpc_call_t** bucket = &client->pending[call->request_id % RPC_PENDING_BUCKETS];
+    call->next = *bucket;
+    *bucket = call;
+    uint32_t request_id = call->request_id;
+    pthread_mutex_unlock(&client->lock);
+
+    rpc_header_t hdr = {0};
+    hdr.magic = RPC_MAGIC;
+    hdr.method_id = method_id;
+    hdr.request_id = request_id;
+    hdr.length = req_len;
+
+    unsigned char head[RPC_HEADER_SIZE];
+    rpc_header_encode(&hdr, head);
+
+    struct iovec iov[2];
+    iov[0].iov_base = head;
+    iov[0].iov_len = sizeof(head);
+    iov[1].iov_base = (void*)req;
+    iov[1].iov_len = req_len;
+
+    pthread_mutex_lock(&client->send_lock);
+    int ret = rpc_writev_full(client->fd, iov, req_len ? 2 : 1);
+    pthread_mutex_unlock(&client->send_lock);
+
+    if (ret < 0) {
+        // 发送失败：连接已坏，关闭读端让接收线程结束所有调用（包括本调用）
+        perror("RPC client send failed");
+        shutdown(client->fd, SHUT_RDWR);
+    }
+    return call;
+}
+
+// ==================== 客户端API ====================
+
+// 连接到RPC服务器并启动接收线程
+rpc_client_t* rpc_client_connect(const char* host, int port) {
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Invalid address: %s\n", host);
+        return NULL;
+    }
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("socket failed");
+        return NULL;
+    }
+    if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect failed");
+        close(fd);
+        return NULL;
+    }
+
+    // 小请求较多，关闭Nagle算法降低延迟
+    int opt = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &opt, sizeof(opt));
+
+    rpc_client_t* client = (rpc_client_t*)calloc(1, sizeof(rpc_client_t));
+    if (!client) {
+        close(fd);
+        return NULL;
+    }
+    client->fd = fd;
+    client->next_id = 1;
+    pthread_mutex_init(&client->send_lock, NULL);
+    pthread_mutex_init(&client->lock, NULL);
+
+    if (pthread_create(&client->reader, NULL, rpc_reader, client) != 0) {
+        perror("pthread_create rpc reader failed");
+        close(fd);
+        pthread_mutex_destroy(&client->send_lock);
+        pthread_mutex_destroy(&client->lock);
+        free(client);
+        return NULL;
+    }
+    return client;
+}
+
+// 同步调用：阻塞直到响应到达、连接断开或超时（timeout_ms<=0表示不超时）
+// 成功时 *resp 由调用方 free()；返回值为响应状态码，超时返回-1
+int rpc_call(rpc_client_t* client, uint16_t method_id,
+             const void* req, uint32_t req_len,
+             unsigned char** resp, uint32_t* resp_len, int timeout_ms) {
+    rpc_call_t* call = rpc_call_start(client, method_id, req, req_len, NULL, NULL);
+    if (!call) {
+        return RPC_ERR_DISCONNECTED;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&client->lock);
+    while (!call->done) {
+        if (timeout_ms <= 0) {
+            pthread_cond_wait(&call->cond, &client->lock);
+        } else if (pthread_cond_timedwait(&call->cond, &client->lock, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+
+    int status;
+    if (call->done) {
+        status = call->status;
+        if (resp) {
+            *resp = call->resp;
+        } else {
+            free(call->resp);
+        }
+        if (resp_len) {
+            *resp_len = call->resp_len;
+        }
+    } else {
+        // 超时：从pending表撤销，迟到的响应会被接收线程丢弃
+        rpc_pending_take(client, call->request_id);
+        status = -1;
+    }
+    pthread_mutex_unlock(&client->lock);
+
+    pthread_cond_destroy(&call->cond);
+    free(call);
+    return status;
+}
+
+// 异步调用：立即返回，响应到达时在接收线程中执行callback
+// 返回0表示请求已发出，-1表示连接已关闭
+int rpc_call_async(rpc_client_t* client, uint16_t method_id,
+                   const void* req, uint32_t req_len,
+                   rpc_callback_t callback, void* arg) {
+    if (!callback) {
+        return -1;
+    }
+    return rpc_call_start(client, method_id, req, req_len, callback, arg) ? 0 : -1;
+}
+
+// 连接是否已断开（closed由接收线程在lock下写入，这里同样在锁内读取）
+int rpc_client_closed(rpc_client_t* client) {
+    pthread_mutex_lock(&client->lock);
+    int closed = client->closed;
+    pthread_mutex_unlock(&client->lock);
+    return closed;
+}
+
+// 关闭连接，等待接收线程结束（未完成的调用以 RPC_ERR_DISCONNECTED 结束）
+void rpc_client_close(rpc_client_t* client) {
+    if (!client) {
+        return;
+    }
+    shutdown(client->fd, SHUT_RDWR);
+    pthread_join(client->reader, NULL);
+    close(client->fd);
+    pthread_mutex_destroy(&client->send_lock);
+    pthread_mutex_destroy(&client->lock);
+    free(client);
+}
+
+// ==================== 示例 ====================
+
+#ifndef RPC_CLIENT_NO_MAIN
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+}
+
+static double demo_start;
+
+static void on_sleep_done(int status, const unsigned char* resp,
+                          uint32_t resp_len, void* arg) {
+    (void)resp;
+    (void)resp_len;
+    printf("  [%7.1fms] async sleep(%lu) finished, status=%d\n",
+           now_ms() - demo_start, (unsigned long)(uintptr_t)arg, status);
+}
+
+static int pings_done = 0;
+
+static void on_ping_done(int status, const unsigned char* resp,
+                         uint32_t resp_len, void* arg) {
+    (void)status;
+    (void)resp;
+    (void)resp_len;
+    (void)arg;
+    __atomic_add_fetch(&pings_done, 1, __ATOMIC_RELEASE);
+}
+
+int main(int argc, char* argv[]) {
+    const char* host = argc > 1 ? argv[1] : "127.0.0.1";
+    int port = argc > 2 ? atoi(argv[2]) : 8081;
+
+    printf("=== Reactor RPC Client ===\n");
+
+    rpc_client_t* client = rpc_client_connect(host, port);
+    if (!client) {
+        return 1;
+    }
+
+    // 1. 同步调用
+    const char* msg = "hello rpc";
+    unsigned char* resp = NULL;
+    uint32_t resp_len = 0;
+    int status = rpc_call(client, RPC_METHOD_ECHO, msg, strlen(msg), &resp, &resp_len, 1000);
+    printf("echo: status=%d, resp=%.*s\n", status, (int)resp_len, resp ? (char*)resp : "");
+    free(resp);
+
+    uint32_t args[2] = { htonl(40), htonl(2) };
+    status = rpc_call(client, RPC_METHOD_ADD, args, sizeof(args), &resp, &resp_len, 1000);
+    if (status == RPC_OK && resp_len == 4) {
+        uint32_t sum;
+        memcpy(&sum, resp, 4);
+        printf("add(40, 2) = %u\n", ntohl(sum));
+    }
+    free(resp);
+
+    status = rpc_call(client, 99, NULL, 0, NULL, NULL, 1000);
+    printf("unknown method: status=%d (expect %d)\n", status, RPC_ERR_NO_METHOD);
+
+    // 2. 乱序完成：先发一个慢调用，再发快调用，快调用先返回
+    printf("\nPipelining on one connection:\n");
+    demo_start = now_ms();
+    uint32_t delays[] = { 500, 300, 100 };
+    for (size_t i = 0; i < sizeof(delays) / sizeof(delays[0]); i++) {
+        uint32_t ms = htonl(delays[i]);
+        rpc_call_async(client, RPC_METHOD_SLEEP, &ms, sizeof(ms),
+                       on_sleep_done, (void*)(uintptr_t)delays[i]);
+    }
+    for (int i = 0; i < 5; i++) {
+        status = rpc_call(client, RPC_METHOD_ECHO, "x", 1, NULL, NULL, 1000);
+        printf("  [%7.1fms] sync echo #%d finished, status=%d\n",
+               now_ms() - demo_start, i, status);
+    }
+
+    // 3. 吞吐：大量在途请求复用同一个socket
+    // 用单独的起点计时：demo_start 仍可能被尚未完成的慢调用回调读取
+    sleep(1);
+    const int total = 100000;
+    double ping_start = now_ms();
+    int sent = 0;
+    while (sent < total &&
+           rpc_call_async(client, RPC_METHOD_ECHO, "ping", 4, on_ping_done, NULL) == 0) {
+        sent++;
+    }
+    while (__atomic_load_n(&pings_done, __ATOMIC_ACQUIRE) < sent && !rpc_client_closed(client)) {
+        usleep(1000);
+    }
+    double elapsed = now_ms() - ping_start;
+    int done = __atomic_load_n(&pings_done, __ATOMIC_ACQUIRE);
+    printf("\n%d pipelined echo calls in %.1fms (%.0f calls/s)\n",
+           done, elapsed, done * 1000.0 / elapsed);
+
+    rpc_client_close(client);
+    return 0;
+}
+
+#endif // RPC_CLIENT_NO_MAIN
@@ -0,0 +1,566 @@
+// 基于 reactor.c 的多路复用二进制 RPC 服务器
+//
+// - 协议头部见 rpc.h：method_id + request_id + length
+// - 方法通过 rpc_register_method() 注册到方法表
+// - Reactor线程只负责收包/拆帧/发包，请求交给工作线程池执行，
+//   哪个请求先完成就先回包，慢调用不会阻塞同一连接上后续的调用
+// - 背压：连接的写缓冲区积压超过 RPC_MAX_OUTPUT，或未完成的请求数达到 RPC_MAX_INFLIGHT 时，
+//   暂停读取该连接（去掉EPOLLIN），响应发出 / 请求完成后再恢复；
+//   线程池的任务队列最多 RPC_MAX_QUEUED 个任务，队列满时Reactor线程等待工作线程腾出位置
+//
+// 编译：gcc -o rpc_server rpc_server.c -lpthread
+
+#define REACTOR_NO_MAIN
+#include "reactor.c"
+#include "rpc.h"
+
+#define RPC_PORT        8081
+#define RPC_WORKERS     4
+#define RPC_READ_CHUNK  4096
+
+#define RPC_MAX_OUTPUT    (4 << 20)  // 单连接写缓冲区积压上限，超过后暂停读取
+#define RPC_MAX_INFLIGHT  256        // 单连接未完成请求数上限，达到后暂停读取
+#define RPC_MAX_QUEUED    4096       // 线程池任务队列长度上限
+
+// ==================== 动态缓冲区 ====================
+
+typedef struct rpc_buf {
+    unsigned char* data;
+    size_t len;     // 已写入的字节数
+    size_t off;     // 已消费的字节数（读缓冲区拆帧 / 写缓冲区已发送）
+    size_t cap;
+} rpc_buf_t;
+
+static int rpc_buf_reserve(rpc_buf_t* buf, size_t extra) {
+    if (buf->len + extra <= buf->cap) {
+        return 0;
+    }
+
+    // 先把已消费的部分挪走，空间仍不够再扩容
+    if (buf->off > 0) {
+        memmove(buf->data, buf->data + buf->off, buf->len - buf->off);
+        buf->len -= buf->off;
+        buf->off = 0;
+        if (buf->len + extra <= buf->cap) {
+            return 0;
+        }
+    }
+
+    size_t new_cap = buf->cap ? buf->cap : RPC_READ_CHUNK;
+    while (new_cap < buf->len + extra) {
+        new_cap *= 2;
+    }
+
+    unsigned char* data = (unsigned char*)realloc(buf->data, new_cap);
+    if (!data) {
+        perror("realloc rpc buffer failed");
+        return -1;
+    }
+    buf->data = data;
+    buf->cap = new_cap;
+    return 0;
+}
+
+int rpc_buf_append(rpc_buf_t* buf, const void* data, size_t len) {
+    if (rpc_buf_reserve(buf, len) < 0) {
+        return -1;
+    }
+    memcpy(buf->data + buf->len, data, len);
+    buf->len += len;
+    return 0;
+}
+
+static void rpc_buf_free(rpc_buf_t* buf) {
+    free(buf->data);
+    buf->data = NULL;
+    buf->len = buf->off = buf->cap = 0;
+}
+
+// ==================== 方法注册表 ====================
+
+// 处理函数：读取请求负载，把响应负载追加到resp，返回状态码（RPC_OK等）
+// 在工作线程中执行，可以阻塞
+typedef int (*rpc_handler_t)(const unsigned char* req, uint32_t req_len, rpc_buf_t* resp);
+
+typedef struct rpc_method {
+    const char* name;
+    rpc_handler_t handler;
+} rpc_method_t;
+
+static rpc_method_t rpc_methods[RPC_MAX_METHODS];
+
+// 注册方法（应在服务器启动前完成，运行期间方法表只读）
+int rpc_register_method(uint16_t method_id, const char* name, rpc_handler_t handler) {
+    if (method_id >= RPC_MAX_METHODS || !handler) {
+        return -1;
+    }
+    if (rpc_methods[method_id].handler) {
+        fprintf(stderr, "RPC method %u already registered as %s\n",
+                method_id, rpc_methods[method_id].name);
+        return -1;
+    }
+
+    rpc_methods[method_id].name = name;
+    rpc_methods[method_id].handler = handler;
+    printf("Registered RPC method %u (%s)\n", method_id, name);
+    return 0;
+}
+
+// ==================== 连接上下文 ====================
+
+// 连接被Reactor线程和工作线程共享，用引用计数管理生命周期：
+// Reactor持有一个引用，每个未完成的请求各持有一个引用
+typedef struct rpc_conn {
+    reactor_t* reactor;
+    int fd;
+    rpc_buf_t in;            // 读缓冲区（仅Reactor线程访问）
+    rpc_buf_t out;           // 写缓冲区（受lock保护）
+    int closed;              // 连接已关闭（受lock保护）
+    int inflight;            // 已提交、尚未回包的请求数（受lock保护）
+    int events;              // 当前在epoll中关注的事件（受lock保护）
+    int refcnt;              // 引用计数（原子操作）
+    uint64_t capture_id;     // 流量捕获使用的连接ID
+    pthread_mutex_t lock;
+} rpc_conn_t;
+
+static void rpc_conn_get(rpc_conn_t* conn) {
+    __atomic_add_fetch(&conn->refcnt, 1, __ATOMIC_RELAXED);
+}
+
+static void rpc_conn_put(rpc_conn_t* conn) {
+    if (__atomic_sub_fetch(&conn->refcnt, 1, __ATOMIC_ACQ_REL) == 0) {
+        rpc_buf_free(&conn->in);
+        rpc_buf_free(&conn->out);
+        pthread_mutex_destroy(&conn->lock);
+        free(conn);
+    }
+}
+
+// 关闭连接（仅在Reactor线程调用）
+static void rpc_conn_close(rpc_conn_t* conn) {
+    pthread_mutex_lock(&conn->lock);
+    if (conn->closed) {
+        pthread_mutex_unlock(&conn->lock);
+        return;
+    }
+    // 在锁内关闭fd，保证工作线程不会对一个已被复用的fd调用reactor_modify
+    conn->closed = 1;
+    capture_record(conn->capture_id, CAPTURE_CLOSE, NULL, 0);
+    reactor_unregister(conn->reactor, conn->fd);
+    close(conn->fd);
+    pthread_mutex_unlock(&conn->lock);
+
+    printf("RPC client fd=%d disconnected\n", conn->fd);
+    rpc_conn_put(conn);
+}
+
+// 根据写缓冲区积压和未完成请求数重新计算关注的事件（调用者持有conn->lock）
+// 有待发送的数据就关注EPOLLOUT；积压或在途请求超过上限时去掉EPOLLIN，暂停读取
+static void rpc_conn_update_events(rpc_conn_t* conn) {
+    if (conn->closed) {
+        return;
+    }
+    size_t pending = conn->out.len - conn->out.off;
+    int events = 0;
+    if (pending <= RPC_MAX_OUTPUT && conn->inflight < RPC_MAX_INFLIGHT) {
+        events |= EPOLLIN;
+    }
+    if (pending > 0) {
+        events |= EPOLLOUT;
+    }
+    if (events != conn->events) {
+        conn->events = events;
+        reactor_modify(conn->reactor, conn->fd, events);
+    }
+}
+
+// 连接是否允许继续读取（Reactor线程调用）
+static int rpc_conn_readable(rpc_conn_t* conn) {
+    pthread_mutex_lock(&conn->lock);
+    int readable = !conn->closed && (conn->events & EPOLLIN);
+    pthread_mutex_unlock(&conn->lock);
+    return readable;
+}
+
+// 把一帧响应放入写缓冲区，并结束一个在途请求（工作线程调用）
+static void rpc_conn_send(rpc_conn_t* conn, const rpc_header_t* hdr,
+                          const unsigned char* payload) {
+    unsigned char head[RPC_HEADER_SIZE];
+    rpc_header_encode(hdr, head);
+
+    pthread_mutex_lock(&conn->lock);
+    conn->inflight--;
+    if (!conn->closed) {
+        // 一次预留整帧的空间，不会只写入头部
+        if (rpc_buf_reserve(&conn->out, sizeof(head) + hdr->length) == 0) {
+            rpc_buf_append(&conn->out, head, sizeof(head));
+            rpc_buf_append(&conn->out, payload, hdr->length);
+        }
+        rpc_conn_update_events(conn);
+    }
+    pthread_mutex_unlock(&conn->lock);
+}
+
+// ==================== 工作线程池 ====================
+
+typedef struct rpc_job {
+    rpc_conn_t* conn;
+    rpc_header_t hdr;
+    unsigned char* payload;
+    struct rpc_job* next;
+} rpc_job_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    rpc_job_t* head;
+    rpc_job_t* tail;
+    int queued;                  // 队列中的任务数
+    pthread_cond_t not_full;     // 队列满时Reactor线程在此等待
+    int stopping;
+    pthread_t threads[RPC_WORKERS];
+} rpc_pool = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, NULL, NULL,
+               0, PTHREAD_COND_INITIALIZER, 0, {0} };
+
+// 队列满时阻塞等待：各连接的在途上限已经限制了单个客户端，这里兜住连接数很多的情况
+static void rpc_pool_submit(rpc_job_t* job) {
+    pthread_mutex_lock(&rpc_pool.lock);
+    while (rpc_pool.queued >= RPC_MAX_QUEUED && !rpc_pool.stopping) {
+        pthread_cond_wait(&rpc_pool.not_full, &rpc_pool.lock);
+    }
+    rpc_pool.queued++;
+    job->next = NULL;
+    if (rpc_pool.tail) {
+        rpc_pool.tail->next = job;
+    } else {
+        rpc_pool.head = job;
+    }
+    rpc_pool.tail = job;
+    pthread_cond_signal(&rpc_pool.cond);
+    pthread_mutex_unlock(&rpc_pool.lock);
+}
+
+static void rpc_execute(rpc_job_t* job) {
+    rpc_buf_t resp = {0};
+    rpc_header_t hdr = job->hdr;
+
+    if (hdr.method_id >= RPC_MAX_METHODS || !rpc_methods[hdr.method_id].handler) {
+        hdr.status = RPC_ERR_NO_METHOD;
+    } else {
+        rpc_handler_t handler = rpc_methods[hdr.method_id].handler;
+        hdr.status = (uint8_t)handler(job->payload, hdr.length, &resp);
+    }
+
+    hdr.flags |= RPC_FLAG_RESPONSE;
+    hdr.length = (uint32_t)(resp.len - resp.off);
+    rpc_conn_send(job->conn, &hdr, resp.data + resp.off);
+    rpc_buf_free(&resp);
+}
+
+static void* rpc_worker(void* arg) {
+    (void)arg;
+
+    while (1) {
+        pthread_mutex_lock(&rpc_pool.lock);
+        while (!rpc_pool.head && !rpc_pool.stopping) {
+            pthread_cond_wait(&rpc_pool.cond, &rpc_pool.lock);
+        }
+        if (!rpc_pool.head) {
+            pthread_mutex_unlock(&rpc_pool.lock);
+            break;
+        }
+        rpc_job_t* job = rpc_pool.head;
+        rpc_pool.head = job->next;
+        if (!rpc_pool.head) {
+            rpc_pool.tail = NULL;
+        }
+        rpc_pool.queued--;
+        pthread_cond_signal(&rpc_pool.not_full);
+        pthread_mutex_unlock(&rpc_pool.lock);
+
+        rpc_execute(job);
+        rpc_conn_put(job->conn);
+        free(job->payload);
+        free(job);
+    }
+    return NULL;
+}
+
+static int rpc_pool_start(void) {
+    for (int i = 0; i < RPC_WORKERS; i++) {
+        if (pthread_create(&rpc_pool.threads[i], NULL, rpc_worker, NULL) != 0) {
+            perror("pthread_create rpc worker failed");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void rpc_pool_stop(void) {
+    pthread_mutex_lock(&rpc_pool.lock);
+    rpc_pool.stopping = 1;
+    pthread_cond_broadcast(&rpc_pool.cond);
+    pthread_cond_broadcast(&rpc_pool.not_full);
+    pthread_mutex_unlock(&rpc_pool.lock);
+
+    for (int i = 0; i < RPC_WORKERS; i++) {
+        pthread_join(rpc_pool.threads[i], NULL);
+    }
+}
+
+// ==================== Reactor 回调 ====================
+
+// 从读缓冲区中拆出所有完整的帧并提交给线程池，协议错误返回-1
+// 已读入的完整帧总是全部提交（在途请求数可能略超上限），之后由rpc_conn_update_events决定是否暂停读取
+static int rpc_dispatch_frames(rpc_conn_t* conn) {
+    rpc_buf_t* in = &conn->in;
+
+    while (in->len - in->off >= RPC_HEADER_SIZE) {
+        rpc_header_t hdr;
+        if (rpc_header_decode(in->data + in->off, &hdr) < 0 ||
+            (hdr.flags & RPC_FLAG_RESPONSE)) {
+            fprintf(stderr, "RPC protocol error on fd=%d\n", conn->fd);
+            return -1;
+        }
+        if (in->len - in->off < RPC_HEADER_SIZE + hdr.length) {
+            break;  // 负载还没收全
+        }
+
+        rpc_job_t* job = (rpc_job_t*)malloc(sizeof(rpc_job_t));
+        unsigned char* payload = (unsigned char*)malloc(hdr.length ? hdr.length : 1);
+        if (!job || !payload) {
+            perror("malloc rpc job failed");
+            free(job);
+            free(payload);
+            return -1;
+        }
+        memcpy(payload, in->data + in->off + RPC_HEADER_SIZE, hdr.length);
+        in->off += RPC_HEADER_SIZE + hdr.length;
+
+        job->hdr = hdr;
+        job->payload = payload;
+        job->conn = conn;
+        rpc_conn_get(conn);
+        pthread_mutex_lock(&conn->lock);
+        conn->inflight++;
+        pthread_mutex_unlock(&conn->lock);
+        rpc_pool_submit(job);
+    }
+
+    if (in->off == in->len) {
+        in->off = in->len = 0;
+    }
+
+    pthread_mutex_lock(&conn->lock);
+    rpc_conn_update_events(conn);
+    pthread_mutex_unlock(&conn->lock);
+    return 0;
+}
+
+void rpc_read_handler(int fd, int events, void* arg) {
+    rpc_conn_t* conn = (rpc_conn_t*)arg;
+
+    // EPOLLERR / EPOLLHUP 无法屏蔽，暂停读取期间也会到达：连接已不可用，直接关闭
+    if (events & (EPOLLERR | EPOLLHUP)) {
+        rpc_conn_close(conn);
+        return;
+    }
+
+    // 非阻塞socket，读到EAGAIN或被背压暂停为止
+    while (rpc_conn_readable(conn)) {
+        if (rpc_buf_reserve(&conn->in, RPC_READ_CHUNK) < 0) {
+            rpc_conn_close(conn);
+            return;
+        }
+
+        ssize_t n = read(fd, conn->in.data + conn->in.len, conn->in.cap - conn->in.len);
+        if (n > 0) {
+            capture_record(conn->capture_id, CAPTURE_DATA, conn->in.data + conn->in.len, n);
+            conn->in.len += n;
+            if (rpc_dispatch_frames(conn) < 0) {
+                rpc_conn_close(conn);
+                return;
+            }
+        } else if (n == 0) {
+            rpc_conn_close(conn);
+            return;
+        } else {
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                return;
+            }
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("rpc read failed");
+            rpc_conn_close(conn);
+            return;
+        }
+    }
+}
+
+void rpc_write_handler(int fd, int events, void* arg) {
+    rpc_conn_t* conn = (rpc_conn_t*)arg;
+    int failed = 0;
+    (void)events;
+
+    pthread_mutex_lock(&conn->lock);
+    rpc_buf_t* out = &conn->out;
+    while (out->off < out->len) {
+        ssize_t n = write(fd, out->data + out->off, out->len - out->off);
+        if (n > 0) {
+            out->off += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else {
+            if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("rpc write failed");
+                failed = 1;
+            }
+            break;
+        }
+    }
+
+    if (!failed) {
+        // 全部发完就不再关注可写事件，积压降到上限以下就恢复读取
+        // （与rpc_conn_send在同一把锁下，不会丢失唤醒）
+        if (out->off == out->len) {
+            out->off = out->len = 0;
+        }
+        rpc_conn_update_events(conn);
+    }
+    pthread_mutex_unlock(&conn->lock);
+
+    if (failed) {
+        rpc_conn_close(conn);
+    }
+}
+
+void rpc_accept_handler(int fd, int events, void* arg) {
+    reactor_t* reactor = (reactor_t*)arg;
+    (void)events;
+
+    struct sockaddr_in client_addr;
+    socklen_t addr_len = sizeof(client_addr);
+
+    int client_fd = accept(fd, (struct sockaddr*)&client_addr, &addr_len);
+    if (client_fd == -1) {
+        perror("accept failed");
+        return;
+    }
+
+    printf("New RPC connection from %s:%d (fd=%d)\n",
+           inet_ntoa(client_addr.sin_addr),
+           ntohs(client_addr.sin_port),
+           client_fd);
+
+    rpc_conn_t* conn = (rpc_conn_t*)calloc(1, sizeof(rpc_conn_t));
+    if (!conn || set_nonblocking(client_fd) < 0) {
+        perror("create rpc connection failed");
+        free(conn);
+        close(client_fd);
+        return;
+    }
+
+    conn->reactor = reactor;
+    conn->fd = client_fd;
+    conn->refcnt = 1;  // Reactor持有的引用
+    conn->events = EPOLLIN;
+    conn->capture_id = capture_conn_open();
+    pthread_mutex_init(&conn->lock, NULL);
+
+    if (reactor_register_rw(reactor, client_fd, EPOLLIN,
+                            rpc_read_handler, rpc_write_handler, conn) < 0) {
+        close(client_fd);
+        rpc_conn_put(conn);
+    }
+}
+
+// ==================== 示例方法 ====================
+
+static int rpc_echo(const unsigned char* req, uint32_t req_len, rpc_buf_t* resp) {
+    return rpc_buf_append(resp, req, req_len) == 0 ? RPC_OK : RPC_ERR_INTERNAL;
+}
+
+static int rpc_add(const unsigned char* req, uint32_t req_len, rpc_buf_t* resp) {
+    uint32_t a, b, sum;
+    if (req_len != 8) {
+        return RPC_ERR_BAD_REQUEST;
+    }
+    memcpy(&a, req, 4);
+    memcpy(&b, req + 4, 4);
+    sum = htonl(ntohl(a) + ntohl(b));
+    return rpc_buf_append(resp, &sum, 4) == 0 ? RPC_OK : RPC_ERR_INTERNAL;
+}
+
+static int rpc_sleep(const unsigned char* req, uint32_t req_len, rpc_buf_t* resp) {
+    uint32_t ms;
+    if (req_len != 4) {
+        return RPC_ERR_BAD_REQUEST;
+    }
+    memcpy(&ms, req, 4);
+    ms = ntohl(ms);
+    usleep(ms * 1000);
+    return rpc_buf_append(resp, req, req_len) == 0 ? RPC_OK : RPC_ERR_INTERNAL;
+}
+
+// ==================== 主函数 ====================
+
+int main(int argc, char* argv[]) {
+    int port = argc > 1 ? atoi(argv[1]) : RPC_PORT;
+
+    printf("=== Reactor RPC Server ===\n");
+
+    const char* capture_path = getenv("REACTOR_CAPTURE");
+    if (capture_path && capture_open(capture_path) < 0) {
+        return 1;
+    }
+
+    rpc_register_method(RPC_METHOD_ECHO, "echo", rpc_echo);
+    rpc_register_method(RPC_METHOD_ADD, "add", rpc_add);
+    rpc_register_method(RPC_METHOD_SLEEP, "sleep", rpc_sleep);
+
+    reactor_t* reactor = reactor_create();
+    if (!reactor) {
+        fprintf(stderr, "Failed to create reactor\n");
+        return 1;
+    }
+
+    int server_fd = create_server_socket(port);
+    if (server_fd < 0) {
+        reactor_destroy(reactor);
+        return 1;
+    }
+
+    if (rpc_pool_start() < 0 ||
+        reactor_register(reactor, server_fd, EPOLLIN, rpc_accept_handler, reactor) < 0 ||
+        reactor_start(reactor) < 0) {
+        fprintf(stderr, "Failed to start RPC server\n");
+        close(server_fd);
+        reactor_destroy(reactor);
+        return 1;
+    }
+
+    printf("\nRPC server is running on port %d. Press 'q' + Enter to quit.\n", port);
+
+    int cmd;
+    while ((cmd = getchar()) != EOF) {
+        if (cmd == 'q' || cmd == 'Q') {
+            break;
+        }
+    }
+
+    printf("\nShutting down RPC server...\n");
+    reactor_unregister(reactor, server_fd);
+    close(server_fd);
+    reactor_stop(reactor);
+    rpc_pool_stop();
+
+    // 线程池已停止，剩余连接只由Reactor持有（rpc_conn_close会把处理器移出链表）
+    while (reactor->handlers) {
+        rpc_conn_close((rpc_conn_t*)reactor->handlers->arg);
+    }
+
+    reactor_destroy(reactor);
+    printf("RPC server shutdown complete.\n");
+    return 0;
+}